@@ -0,0 +1,32 @@
+#!/bin/bash
+# Measures how long the compiler spends evaluating the compile time parsers of the given test files.
+# Most of the compile time of this library goes into constant expression evaluation, so this is the number
+# to look at when changing cvector, rep or anything else used inside of static_asserts.
+#
+# Usage: benchmarks/compile_time.sh [file...]
+# Defaults to the test files with the largest number of compile time parse results. Needs GCC (-ftime-report).
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+CXX=${CXX:-g++}
+RUNS=${RUNS:-3}
+FILES=("$@")
+if [ ${#FILES[@]} -eq 0 ]; then
+  FILES=(test/parsers/rep_test.cpp test/funcsig_parser/function_signature_test.cpp)
+fi
+
+for file in "${FILES[@]}"; do
+  best=""
+  for ((run = 0; run < RUNS; ++run)); do
+    # -ftime-report line format: " constant expression evaluation :   0.19 ( 10%)   0.01 (  2%)   0.21 (  9%)    29M (  8%)"
+    result=$("$CXX" -std=c++20 -fsyntax-only -ftime-report -Isrc -Itest/parsers \
+               -isystem vendor/googletest/gtest/googletest/include "$file" 2>&1 >/dev/null \
+             | awk -F'[:(]' '/constant expression evaluation/ { split($5, mem, " "); print $2+0, mem[2] }')
+    if [ -z "$best" ] || awk -v a="${result%% *}" -v b="${best%% *}" 'BEGIN { exit !(a < b) }'; then
+      best=$result
+    fi
+  done
+  printf "%-60s %6ss %6s\n" "$file" ${best}
+done
@@ -0,0 +1,60 @@
+// Runtime throughput of the funcsig grammar, its indexed variant and a simple number list, see throughput.sh
+#include "funcsig_parser/function_signature.h"
+#include "funcsig_parser/indexed.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/match.h"
+#include "parsers/phrase.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace ctpc;
+using namespace ctpc::funcsig_parser;
+
+namespace {
+
+constexpr size_t NUM_RUNS = 40;
+
+// Returns the best throughput in MB/s over NUM_RUNS runs. The fastest run is the one with the least noise.
+template<class Parser>
+double measure(const Parser& parser, const std::string& input, size_t* checksum) {
+    double best_seconds = 1e9;
+    for (size_t run = 0; run < NUM_RUNS; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto parsed = parser(Input{input});
+        // Keeps the compiler from dropping the parser
+        *checksum += parsed.is_success() ? parsed.next().input.size() + 1 : 0;
+        best_seconds = std::min(best_seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return input.size() / best_seconds / 1e6;
+}
+
+}
+
+int main() {
+    std::string signatures;
+    for (size_t i = 0; i < 100000; ++i) {
+        signatures += "void   some_function" + std::to_string(i) + " ( first_arg : Int ,  b : String, c: Double )\n";
+    }
+    signatures += "Int last()";
+
+    std::string numbers;
+    for (size_t i = 0; i < 1000000; ++i) {
+        numbers += std::to_string(i * 7919) + ",";
+    }
+    numbers += "0";
+
+    size_t checksum = 0;
+    const double parse = measure(phrase(function_signatures()), signatures, &checksum);
+    const double match_only = measure(phrase(match(function_signatures())), signatures, &checksum);
+    // Includes building the index
+    const double indexed = measure([] (Input input) {
+        const structural_index index = signature_structural_index(input);
+        return phrase(indexed_function_signatures(index))(input);
+    }, signatures, &checksum);
+    const double ints = measure(phrase(repsep(runtime_optimization, integer(), elem(','))), numbers, &checksum);
+    std::printf("funcsig parse %6.0f MB/s   funcsig match %6.0f MB/s   funcsig indexed %6.0f MB/s   integers %6.0f MB/s\n", parse, match_only, indexed, ints);
+    return checksum == 0;
+}
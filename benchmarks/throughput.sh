@@ -0,0 +1,48 @@
+#!/bin/bash
+# Measures the runtime throughput of benchmarks/throughput.cpp built with different compiler flags.
+# The variants run interleaved and each reports its median over all rounds, which keeps the comparison
+# fair on machines with a fluctuating load.
+#
+# Usage: benchmarks/throughput.sh [name=flags...]
+# Defaults to comparing the assertion levels, see src/parsers/utils/assert.h.
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+CXX=${CXX:-g++}
+ROUNDS=${ROUNDS:-5}
+CXXFLAGS=${CXXFLAGS:--O2}
+VARIANTS=("$@")
+if [ ${#VARIANTS[@]} -eq 0 ]; then
+  VARIANTS=(
+    "paranoid=-DCTPC_ASSERT_LEVEL=CTPC_ASSERT_LEVEL_PARANOID"
+    "debug=-DCTPC_ASSERT_LEVEL=CTPC_ASSERT_LEVEL_DEBUG"
+    "off=-DCTPC_ASSERT_LEVEL=CTPC_ASSERT_LEVEL_OFF"
+    "off,no-exceptions=-DCTPC_ASSERT_LEVEL=CTPC_ASSERT_LEVEL_OFF -fno-exceptions"
+  )
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+for ((i = 0; i < ${#VARIANTS[@]}; ++i)); do
+  # shellcheck disable=SC2086
+  "$CXX" -std=c++20 $CXXFLAGS ${VARIANTS[i]#*=} -Isrc benchmarks/throughput.cpp -o "$BUILD_DIR/$i"
+  printf "%-24s %8s bytes\n" "${VARIANTS[i]%%=*}" "$(stat -c %s "$BUILD_DIR/$i")"
+done
+
+for ((round = 0; round < ROUNDS; ++round)); do
+  for ((i = 0; i < ${#VARIANTS[@]}; ++i)); do
+    "$BUILD_DIR/$i" >> "$BUILD_DIR/$i.txt"
+  done
+done
+
+# Output line format: "funcsig parse    190 MB/s   funcsig match    260 MB/s   funcsig indexed    180 MB/s   integers    420 MB/s"
+for ((i = 0; i < ${#VARIANTS[@]}; ++i)); do
+  printf "%-24s" "${VARIANTS[i]%%=*}"
+  for column in 3 7 11 14; do
+    printf " %6s" "$(awk -v c=$column '{print $c}' "$BUILD_DIR/$i.txt" | sort -n | awk '{v[NR] = $1} END {print v[int((NR + 1) / 2)]}')"
+  done
+  printf "  MB/s (funcsig parse, funcsig match, funcsig indexed, integers)\n"
+done
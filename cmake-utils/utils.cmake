@@ -11,6 +11,16 @@ function(target_activate_cpp17 TARGET)
     set_property(TARGET ${TARGET} PROPERTY CXX_STANDARD_REQUIRED ON)
 endfunction(target_activate_cpp17)
 
+###################################################
+#  Activate C++20
+#
+#  Uses: target_activate_cpp20(buildtarget)
+###################################################
+function(target_activate_cpp20 TARGET)
+    set_property(TARGET ${TARGET} PROPERTY CXX_STANDARD 20)
+    set_property(TARGET ${TARGET} PROPERTY CXX_STANDARD_REQUIRED ON)
+endfunction(target_activate_cpp20)
+
 # Find clang-tidy executable (for use in target_enable_style_warnings)
 if (USE_CLANG_TIDY)
     find_program(
@@ -2,43 +2,155 @@
 
 #include "funcsig_parser/parameter.h"
 #include "parsers/rep.h"
+#include "parsers/exact_size.h"
+#include <span>
 
 namespace ctpc {
 namespace funcsig_parser {
 
 #define MAX_PARAMETERS 64
+#define INLINE_PARAMETERS 4
+
+// Runs the parser and skips the whitespaces around it. The result is returned as parsed, see keep_left().
+template<class Parser>
+constexpr auto trimmed(Parser&& parser) {
+    return keep_right(whitespaces(), keep_left(std::forward<Parser>(parser), whitespaces()));
+}
 
 constexpr auto parameter_list(_compiletime_optimization optimization) {
-    return repsep<MAX_PARAMETERS>(optimization, parameter(), seq(whitespaces(), elem(','), whitespaces()));
+    return repsep<MAX_PARAMETERS>(optimization, parameter(), ignore(seq(whitespaces(), elem(','), whitespaces())));
 }
 
 constexpr auto parameter_list(_runtime_optimization optimization) {
-    return repsep(optimization, parameter(), seq(whitespaces(), elem(','), whitespaces()));
+    return repsep(optimization, parameter(), ignore(seq(whitespaces(), elem(','), whitespaces())));
+}
+
+constexpr auto parameter_list(_hybrid_optimization optimization) {
+    return repsep<INLINE_PARAMETERS>(optimization, parameter(), ignore(seq(whitespaces(), elem(','), whitespaces())));
 }
 
 template<class Optimization>
 struct FunctionSignature final {
-    static_assert(std::is_same_v<_compiletime_optimization, Optimization> || std::is_same_v<_runtime_optimization, Optimization>);
+    static_assert(std::is_same_v<_compiletime_optimization, Optimization> || std::is_same_v<_runtime_optimization, Optimization> || std::is_same_v<_hybrid_optimization, Optimization>);
     using ParameterContainer = std::conditional_t<
         std::is_same_v<_compiletime_optimization, Optimization>,
         cvector<Parameter, MAX_PARAMETERS>,
-        std::vector<Parameter>>;
+        std::conditional_t<
+            std::is_same_v<_hybrid_optimization, Optimization>,
+            small_vector<Parameter, INLINE_PARAMETERS>,
+            std::vector<Parameter>>>;
 
     std::string_view return_type;
     std::string_view name;
     ParameterContainer parameters;
 };
 
+/**
+ * Result type of parse_exact_size() for function signatures, see exact_size_traits<FunctionSignature<...>> below.
+ * Stores exactly NUM_PARAMETERS parameters, without any capacity limit or unused capacity.
+ */
+template<size_t NUM_PARAMETERS>
+struct ExactSizeFunctionSignature final {
+    std::string_view return_type;
+    std::string_view name;
+    std::array<Parameter, NUM_PARAMETERS> parameters;
+};
+
 template<class Optimization>
 constexpr auto function_signature(Optimization optimization) {
-    return map(
-        seq(identifier(), whitespaces(), identifier(), whitespaces(), elem('('), whitespaces(), parameter_list(optimization), whitespaces(), elem(')')),
-        [] (auto&& parsed) {
-            return FunctionSignature<Optimization>{std::get<0>(parsed), std::get<2>(parsed), std::get<6>(parsed)};
-        }
+    return construct<FunctionSignature<Optimization>>(
+        identifier(), ignore(whitespaces()), identifier(), ignore(whitespaces()), ignore(elem('(')), ignore(whitespaces()), parameter_list(optimization), ignore(whitespaces()), ignore(elem(')'))
     );
 }
 
+/**
+ * List of function signatures, one per line.
+ * Use this with parse_exact_size() or materialize() to get a FunctionSignatureTable.
+ */
+constexpr auto function_signatures() {
+    return repsep(runtime_optimization, function_signature(runtime_optimization), ignore(seq(whitespaces(), elem('\n'), whitespaces())));
+}
+
+struct FlatFunctionSignature final {
+    std::string_view return_type;
+    std::string_view name;
+    // Range of the parameters in FunctionSignatureTable::parameters
+    size_t parameters_begin;
+    size_t num_parameters;
+};
+
+struct FunctionSignatureTableShape final {
+    size_t num_signatures;
+    size_t num_parameters;
+};
+
+/**
+ * Flattened, read-only table of function signatures.
+ * The parameters of all signatures are stored together in one array and each signature refers to its range in there,
+ * so the whole table is just two exact-size arrays.
+ */
+template<FunctionSignatureTableShape SHAPE>
+struct FunctionSignatureTable final {
+    std::array<FlatFunctionSignature, SHAPE.num_signatures> signatures;
+    std::array<Parameter, SHAPE.num_parameters> parameters;
+
+    constexpr std::span<const Parameter> parameters_of(const FlatFunctionSignature& signature) const {
+        return std::span<const Parameter>(parameters).subspan(signature.parameters_begin, signature.num_parameters);
+    }
+
+    // Returns nullptr if there is no function with this name
+    constexpr const FlatFunctionSignature* find(std::string_view name) const {
+        for (const FlatFunctionSignature& signature : signatures) {
+            if (signature.name == name) {
+                return &signature;
+            }
+        }
+        return nullptr;
+    }
+};
 
 }
 }
+
+namespace ctpc {
+
+template<class Optimization>
+struct exact_size_traits<funcsig_parser::FunctionSignature<Optimization>> final {
+    using ParameterTraits = exact_size_traits<typename funcsig_parser::FunctionSignature<Optimization>::ParameterContainer>;
+
+    static constexpr size_t shape(const funcsig_parser::FunctionSignature<Optimization>& value) {
+        return ParameterTraits::shape(value.parameters);
+    }
+
+    template<size_t NUM_PARAMETERS>
+    static constexpr funcsig_parser::ExactSizeFunctionSignature<NUM_PARAMETERS> convert(funcsig_parser::FunctionSignature<Optimization>&& value) {
+        return {value.return_type, value.name, ParameterTraits::template convert<NUM_PARAMETERS>(std::move(value.parameters))};
+    }
+};
+
+template<class Optimization>
+struct exact_size_traits<std::vector<funcsig_parser::FunctionSignature<Optimization>>> final {
+    static constexpr funcsig_parser::FunctionSignatureTableShape shape(const std::vector<funcsig_parser::FunctionSignature<Optimization>>& value) {
+        funcsig_parser::FunctionSignatureTableShape result{value.size(), 0};
+        for (const auto& signature : value) {
+            result.num_parameters += signature.parameters.size();
+        }
+        return result;
+    }
+
+    template<funcsig_parser::FunctionSignatureTableShape SHAPE>
+    static constexpr funcsig_parser::FunctionSignatureTable<SHAPE> convert(std::vector<funcsig_parser::FunctionSignature<Optimization>>&& value) {
+        funcsig_parser::FunctionSignatureTable<SHAPE> result{};
+        size_t num_parameters = 0;
+        for (size_t i = 0; i < value.size(); ++i) {
+            result.signatures[i] = {value[i].return_type, value[i].name, num_parameters, value[i].parameters.size()};
+            for (const funcsig_parser::Parameter& parameter : value[i].parameters) {
+                result.parameters[num_parameters++] = parameter;
+            }
+        }
+        ASSERT(num_parameters == SHAPE.num_parameters);
+        return result;
+    }
+};
+
+}
@@ -1,34 +1,28 @@
 #pragma once
 
-#include "parsers/rep.h"
-#include "parsers/alternative.h"
-#include "parsers/alpha.h"
-#include "parsers/seq.h"
-#include "parsers/match.h"
+#include "parsers/parse_result.h"
+#include "parsers/utils/kernels.h"
 
 namespace ctpc {
 namespace funcsig_parser {
 
-namespace detail {
-template<class Parser>
-constexpr auto rep_count(Parser &&parser) {
-    return rep(
-        std::forward<Parser>(parser),
-        []() -> int64_t { return 0; },
-        [](int64_t *counter, const auto & /*result*/) {
-            ++*counter;
-        }
-    );
-}
-}
-
+template<class InputT = Input>
 constexpr auto identifier() {
-    return match(
-        seq(
-            alternative(alpha(), elem('_')),
-            detail::rep_count(alternative(alphanumeric(), elem('_')))
-        )
-    );
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<std::string_view, InputT> {
+        constexpr auto first_char = kernels::make_char_class(kernels::char_range{'a', 'z'}, kernels::char_range{'A', 'Z'}, kernels::char_range{'_', '_'});
+        constexpr auto other_chars = kernels::make_char_class(kernels::char_range{'a', 'z'}, kernels::char_range{'A', 'Z'}, kernels::char_range{'0', '9'}, kernels::char_range{'_', '_'});
+        if (input.reaches_partial_end(0)) {
+            return ParseResult<std::string_view, InputT>::need_more(input);
+        }
+        if (input.input.size() == 0 || !first_char.contains(input.input[0])) {
+            return ParseResult<std::string_view, InputT>::failure(input);
+        }
+        const size_t length = 1 + kernels::scan_while_class(input.input.substr(1), other_chars, input.padding);
+        if (input.reaches_partial_end(length)) {
+            return ParseResult<std::string_view, InputT>::need_more(input.advance(length));
+        }
+        return ParseResult<std::string_view, InputT>::success(input.advance(length), input.input.substr(0, length));
+    };
 }
 
 }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "funcsig_parser/function_signature.h"
+#include "parsers/structural_index.h"
+
+namespace ctpc {
+namespace funcsig_parser {
+
+/**
+ * Version of the function signature parser that finds the ends of signatures and parameters with a
+ * structural_index of the input. Build the index with signature_structural_index(), it must index the whole input.
+ * The results are the same as for function_signature() and function_signatures().
+ * The parsers keep a reference to the index, so the index has to outlive them.
+ */
+inline structural_index signature_structural_index(Input input) {
+    return structural_index(input, ",()\n");
+}
+
+constexpr auto indexed_parameter(const structural_index& index) {
+    return delimited(index, ",)", trimmed(parameter()));
+}
+
+constexpr auto indexed_parameter(const structural_index&& index) = delete;
+
+constexpr auto indexed_parameter_list(const structural_index& index, _compiletime_optimization optimization) {
+    return repsep<MAX_PARAMETERS>(optimization, indexed_parameter(index), elem(','));
+}
+
+constexpr auto indexed_parameter_list(const structural_index& index, _runtime_optimization optimization) {
+    return repsep(optimization, indexed_parameter(index), elem(','));
+}
+
+constexpr auto indexed_parameter_list(const structural_index& index, _hybrid_optimization optimization) {
+    return repsep<INLINE_PARAMETERS>(optimization, indexed_parameter(index), elem(','));
+}
+
+template<class Optimization>
+constexpr auto indexed_parameter_list(const structural_index&& index, Optimization optimization) = delete;
+
+template<class Optimization>
+constexpr auto indexed_function_signature(const structural_index& index, Optimization optimization) {
+    return construct<FunctionSignature<Optimization>>(
+        identifier(), ignore(whitespaces()), identifier(), ignore(whitespaces()), ignore(elem('(')), indexed_parameter_list(index, optimization), ignore(whitespaces()), ignore(elem(')'))
+    );
+}
+
+template<class Optimization>
+constexpr auto indexed_function_signature(const structural_index&& index, Optimization optimization) = delete;
+
+// The signature parser finds the end of its line by itself, delimiting the lines with the index too would only add lookups
+constexpr auto indexed_function_signatures(const structural_index& index) {
+    return repsep(runtime_optimization, indexed_function_signature(index, runtime_optimization), ignore(seq(whitespaces(), elem('\n'), whitespaces())));
+}
+
+constexpr auto indexed_function_signatures(const structural_index&& index) = delete;
+
+}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "funcsig_parser/function_signature.h"
+#include "parsers/balanced.h"
+#include "parsers/lazy.h"
+
+namespace ctpc {
+namespace funcsig_parser {
+
+/**
+ * Version of the function signature parser that only parses the return type and name right away. The parameter list
+ * is only checked for balanced parentheses, and parsed into a container the first time it is accessed.
+ * Use this if most signatures are discarded by name.
+ */
+template<class Optimization>
+constexpr auto lazy_parameter_list(Optimization optimization) {
+    return lazy(skip_balanced('(', ')'), trimmed(parameter_list(optimization)));
+}
+
+template<class Optimization>
+struct LazyFunctionSignature final {
+    std::string_view return_type;
+    std::string_view name;
+    parser_result_t<decltype(lazy_parameter_list(Optimization{}))> parameters;
+};
+
+template<class Optimization>
+constexpr auto lazy_function_signature(Optimization optimization) {
+    return construct<LazyFunctionSignature<Optimization>>(
+        identifier(), ignore(whitespaces()), identifier(), ignore(whitespaces()), lazy_parameter_list(optimization)
+    );
+}
+
+constexpr auto lazy_function_signatures() {
+    return repsep(runtime_optimization, lazy_function_signature(runtime_optimization), ignore(seq(whitespaces(), elem('\n'), whitespaces())));
+}
+
+}
+}
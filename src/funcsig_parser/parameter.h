@@ -2,6 +2,8 @@
 
 #include "parsers/map.h"
 #include "parsers/elem.h"
+#include "parsers/seq.h"
+#include "parsers/alpha.h"
 #include "funcsig_parser/identifier.h"
 
 namespace ctpc {
@@ -13,12 +15,7 @@ struct Parameter final {
 };
 
 constexpr auto parameter() {
-    return map(
-        seq(identifier(), whitespaces(), elem(':'), whitespaces(), identifier()),
-        [] (auto&& parsed) {
-            return Parameter{std::get<0>(parsed), std::get<4>(parsed)};
-        }
-    );
+    return construct<Parameter>(identifier(), ignore(whitespaces()), ignore(elem(':')), ignore(whitespaces()), identifier());
 }
 
 }
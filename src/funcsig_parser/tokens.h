@@ -0,0 +1,60 @@
+#pragma once
+
+#include "funcsig_parser/function_signature.h"
+#include "parsers/lexer.h"
+
+namespace ctpc {
+namespace funcsig_parser {
+
+/**
+ * Two-stage version of the function signature parser. signature_lexer() scans identifiers and punctuation exactly
+ * once, and the token grammar below decides on token kinds only. The results are the same as for function_signature()
+ * and function_signatures().
+ */
+enum class TokenKind : uint8_t {IDENTIFIER, COLON, COMMA, LPAREN, RPAREN, NEWLINE};
+
+constexpr auto signature_lexer() {
+    return lexer(whitespaces(),
+        rule(TokenKind::IDENTIFIER, identifier()),
+        rule(TokenKind::COLON, elem(':')),
+        rule(TokenKind::COMMA, elem(',')),
+        rule(TokenKind::LPAREN, elem('(')),
+        rule(TokenKind::RPAREN, elem(')')),
+        rule(TokenKind::NEWLINE, elem('\n'))
+    );
+}
+
+constexpr auto token_parameter() {
+    return construct<Parameter>(token(TokenKind::IDENTIFIER), ignore(token(TokenKind::COLON)), token(TokenKind::IDENTIFIER));
+}
+
+constexpr auto token_parameter_list(_compiletime_optimization optimization) {
+    return repsep<MAX_PARAMETERS>(optimization, token_parameter(), token(TokenKind::COMMA));
+}
+
+constexpr auto token_parameter_list(_runtime_optimization optimization) {
+    return repsep(optimization, token_parameter(), token(TokenKind::COMMA));
+}
+
+constexpr auto token_parameter_list(_hybrid_optimization optimization) {
+    return repsep<INLINE_PARAMETERS>(optimization, token_parameter(), token(TokenKind::COMMA));
+}
+
+template<class Optimization>
+constexpr auto token_function_signature(Optimization optimization) {
+    return construct<FunctionSignature<Optimization>>(
+        token(TokenKind::IDENTIFIER), token(TokenKind::IDENTIFIER), ignore(token(TokenKind::LPAREN)), token_parameter_list(optimization), ignore(token(TokenKind::RPAREN))
+    );
+}
+
+template<class Optimization>
+constexpr auto tokenized_function_signature(Optimization optimization) {
+    return tokenized(signature_lexer(), token_function_signature(optimization));
+}
+
+constexpr auto tokenized_function_signatures() {
+    return tokenized(signature_lexer(), repsep(runtime_optimization, token_function_signature(runtime_optimization), token(TokenKind::NEWLINE)));
+}
+
+}
+}
@@ -4,47 +4,51 @@
 #include "parsers/elem.h"
 #include "parsers/alternative.h"
 #include "parsers/integer.h"
+#include "parsers/utils/kernels.h"
 
 namespace ctpc {
 
+template<class InputT = Input>
 constexpr auto alpha_small() {
-    return elem([] (char v) {
+    return elem<InputT>([] (char v) noexcept {
         return v >= 'a' && v <= 'z';
     });
 }
 
+template<class InputT = Input>
 constexpr auto alpha_large() {
-    return elem([] (char v) {
+    return elem<InputT>([] (char v) noexcept {
         return v >= 'A' && v <= 'Z';
     });
 }
 
+template<class InputT = Input>
 constexpr auto alpha() {
-    return alternative(alpha_small(), alpha_large());
+    return alternative(alpha_small<InputT>(), alpha_large<InputT>());
 }
 
+template<class InputT = Input>
 constexpr auto alphanumeric() {
-    return alternative(alpha_small(), alpha_large(), numeric());
+    return alternative(alpha_small<InputT>(), alpha_large<InputT>(), numeric<InputT>());
 }
 
+template<class InputT = Input>
 constexpr auto whitespace() {
-    return elem(' ');
+    return elem<InputT>(' ');
 }
 
 /**
  * Match zero or more whitespace characters
  */
+template<class InputT = Input>
 constexpr auto whitespaces() {
-    return [] (Input input) {
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<std::string_view, InputT> {
         // find first non-whitespace character
-        auto current = input.input.begin();
-        while(current != input.input.end() && *current == ' ') {
-            ++current;
+        const size_t num_whitespaces = kernels::scan_while_class(input.input, kernels::make_char_class(kernels::char_range{' ', ' '}), input.padding);
+        if (input.reaches_partial_end(num_whitespaces)) {
+            return ParseResult<std::string_view, InputT>::need_more(input.advance(num_whitespaces));
         }
-
-        Input next = Input{std::string_view(current, input.input.end() - current)};
-        std::string_view match(input.input.begin(), current - input.input.begin());
-        return ParseResult<std::string_view>::success(next, match);
+        return ParseResult<std::string_view, InputT>::success(input.advance(num_whitespaces), input.input.substr(0, num_whitespaces));
     };
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <tuple>
 #include "parsers/parse_result.h"
 #include "parsers/basic_parsers.h"
+#include "parsers/recognize.h"
 
 namespace ctpc {
 
@@ -12,7 +14,9 @@ namespace details {
 
     template<class Result, class HeadParser, class... TailParsers>
     struct apply_alternative_parsers<Result, HeadParser, TailParsers...> final {
-        static constexpr ParseResult<Result> call(Input input, ParseResult<Result>&& longest_failure, const HeadParser &headParser, const TailParsers &... tailParsers) {
+        using input_type = parser_input_t<HeadParser>;
+
+        static constexpr ParseResult<Result, input_type> call(input_type input, ParseResult<Result, input_type>&& longest_failure, const HeadParser &headParser, const TailParsers &... tailParsers) {
             static_assert(std::is_convertible_v<parser_result_t<HeadParser>, Result>, "This shouldn't happen because Result is the common_type of all individual parser results");
             static_assert(std::is_same_v<Result, std::decay_t<Result>>);
 
@@ -20,7 +24,7 @@ namespace details {
 
             if (!parsed.is_failure()) {
                 // SUCCESS and ERROR end the chain
-                return ParseResult<Result>::unsafe_convert_from(std::move(parsed));
+                return ParseResult<Result, input_type>::unsafe_convert_from(std::move(parsed));
             }
 
             // The current parser failed. Try the next in the list.
@@ -28,7 +32,7 @@ namespace details {
             if (parsed.next().input.size() < longest_failure.next().input.size()) {
                 // Current failure matched a longer prefix of the input than all previous parsers.
                 // Remember this one as the result in case no parser returns success or error.
-                return apply_alternative_parsers<Result, TailParsers...>::call(input, ParseResult<Result>::unsafe_convert_from(std::move(parsed)), tailParsers...);
+                return apply_alternative_parsers<Result, TailParsers...>::call(input, ParseResult<Result, input_type>::unsafe_convert_from(std::move(parsed)), tailParsers...);
             } else {
                 // A previous parser had a longer match. Keep that.
                 return apply_alternative_parsers<Result, TailParsers...>::call(input, std::move(longest_failure), tailParsers...);
@@ -38,7 +42,8 @@ namespace details {
 
     template<class Result>
     struct apply_alternative_parsers<Result> final {
-        static constexpr ParseResult<Result>&& call(Input /*input*/, ParseResult<Result>&& longest_failure) {
+        template<class InputT>
+        static constexpr ParseResult<Result, InputT>&& call(InputT /*input*/, ParseResult<Result, InputT>&& longest_failure) {
             return std::move(longest_failure);
         }
     };
@@ -47,10 +52,28 @@ namespace details {
 template<class... Parsers>
 constexpr auto alternative(Parsers&&... parsers) {
     using result_type = std::common_type_t<parser_result_t<Parsers>...>;
-    return [parsers = std::make_tuple(std::forward<Parsers>(parsers)...)] (Input input) -> ParseResult<result_type> {
-        return std::apply([input] (const auto&... parsers) {
-            return details::apply_alternative_parsers<result_type, std::decay_t<Parsers>...>::call(input, ParseResult<result_type>::failure(input), parsers...);
-        }, parsers);
+    using input_type = common_parser_input_t<Parsers...>;
+    constexpr bool is_noexcept = (... && std::is_nothrow_constructible_v<result_type, parser_result_t<Parsers>&&>);
+    return details::dual_mode_parser{
+        [parsers = std::make_tuple(std::forward<Parsers>(parsers)...)] (input_type input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), Parsers...> && (decltype(mode)::recognize || is_noexcept)) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            if constexpr (decltype(mode)::recognize) {
+                // Same as below, but the results are all the same type, so no conversions are needed
+                return std::apply([input] (const auto&... parsers) {
+                    auto result = details::recognized<input_type>::failure(input);
+                    (... || [&result] (const details::recognized<input_type>& parsed) {
+                        if (!parsed.is_failure() || parsed.next().input.size() < result.next().input.size()) {
+                            result = parsed;
+                        }
+                        return !parsed.is_failure();
+                    }(details::run_recognizer(parsers, input)));
+                    return result;
+                }, parsers);
+            } else {
+                return std::apply([input] (const auto&... parsers) {
+                    return details::apply_alternative_parsers<result_type, std::decay_t<Parsers>...>::call(input, ParseResult<result_type, input_type>::failure(input), parsers...);
+                }, parsers);
+            }
+        }
     };
 }
 template<>
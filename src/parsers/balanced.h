@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include "parsers/parse_result.h"
+#include "parsers/utils/kernels.h"
+
+namespace ctpc {
+
+namespace details {
+    /**
+     * Finds the closer matching an opener right before the input, i.e. the first position at which the closers
+     * outnumber the openers. Returns std::string_view::npos if the input ends before that.
+     *
+     * This finds the brackets of 64 characters at a time with match_bytes() and only counts them. Only blocks in which
+     * the depth could get back to zero are looked at bracket by bracket. The chunks given to match_bytes() start small,
+     * so short regions stay cheap, and double in size for long regions.
+     */
+    template<class InputT>
+    constexpr size_t find_balanced_end(InputT input, char open, char close, std::optional<char> quote) {
+        constexpr size_t MAX_CHUNK_BLOCKS = 64;
+        std::array<uint64_t, MAX_CHUNK_BLOCKS> opens{};
+        std::array<uint64_t, MAX_CHUNK_BLOCKS> closes{};
+        std::array<uint64_t, MAX_CHUNK_BLOCKS> quotes{};
+        size_t depth = 1;
+        uint64_t quote_carry = 0;
+        size_t chunk_begin = 0;
+        size_t chunk_blocks = 1;
+        while (chunk_begin < input.input.size()) {
+            const std::string_view chunk = input.input.substr(chunk_begin, chunk_blocks * kernels::MATCH_BYTES_BLOCK_SIZE);
+            // Only the last chunk can end with a partial block, and only there, the padding of the input follows
+            const size_t padding = chunk_begin + chunk.size() == input.input.size() ? input.padding : 0;
+            kernels::match_bytes(chunk, std::span<const char>(&open, 1), opens.data(), padding);
+            kernels::match_bytes(chunk, std::span<const char>(&close, 1), closes.data(), padding);
+            if (quote.has_value()) {
+                kernels::match_bytes(chunk, std::span<const char>(&*quote, 1), quotes.data(), padding);
+            }
+            for (size_t block = 0; block < kernels::num_match_bytes_blocks(chunk.size()); ++block) {
+                uint64_t open_mask = opens[block];
+                uint64_t close_mask = closes[block];
+                if (quote.has_value()) {
+                    const uint64_t in_quotes = kernels::prefix_xor(quotes[block]) ^ quote_carry;
+                    open_mask &= ~in_quotes;
+                    close_mask &= ~in_quotes;
+                    quote_carry = (in_quotes >> 63) == 0 ? 0 : ~uint64_t(0);
+                }
+                const size_t num_closes = std::popcount(close_mask);
+                if (num_closes < depth) {
+                    // Not enough closers in this block to get back to depth zero
+                    depth = depth + std::popcount(open_mask) - num_closes;
+                    continue;
+                }
+                for (uint64_t brackets = open_mask | close_mask; brackets != 0; brackets &= brackets - 1) {
+                    const int position = std::countr_zero(brackets);
+                    if ((close_mask >> position & 1) == 0) {
+                        ++depth;
+                    } else if (--depth == 0) {
+                        return chunk_begin + block * kernels::MATCH_BYTES_BLOCK_SIZE + position;
+                    }
+                }
+            }
+            chunk_begin += chunk.size();
+            chunk_blocks = std::min(2 * chunk_blocks, MAX_CHUNK_BLOCKS);
+        }
+        return std::string_view::npos;
+    }
+
+    template<class InputT>
+    constexpr auto skip_balanced(char open, char close, std::optional<char> quote) {
+        ASSERT(open != close && quote != open && quote != close);
+        return [open, close, quote] (InputT input) noexcept(details::nothrow_asserts) CTPC_LEAF_INLINE -> ParseResult<std::string_view, InputT> {
+            if (input.input.empty() || input.input[0] != open) {
+                if (input.reaches_partial_end(0)) {
+                    return ParseResult<std::string_view, InputT>::need_more(input);
+                }
+                return ParseResult<std::string_view, InputT>::failure(input);
+            }
+            const InputT body = input.advance(1);
+            const size_t end = find_balanced_end(body, open, close, quote);
+            if (end == std::string_view::npos) {
+                if (input.reaches_partial_end(input.input.size())) {
+                    return ParseResult<std::string_view, InputT>::need_more(input);
+                }
+                return ParseResult<std::string_view, InputT>::failure(input);
+            }
+            return ParseResult<std::string_view, InputT>::success(body.advance(end + 1), body.input.substr(0, end));
+        };
+    }
+}
+
+/**
+ * Skips a nested region without parsing it, e.g. a function body or a default value expression.
+ * Matches the opener, everything up to the matching closer, and the closer, and returns the text between them.
+ * E.g. skip_balanced('(', ')') on "(a, (b), c) d" returns "a, (b), c" and continues at " d".
+ * Fails if the input doesn't start with the opener or the closers don't balance the openers.
+ * Other kinds of brackets in between are skipped like any other character, they don't have to be balanced.
+ */
+template<class InputT = Input>
+constexpr auto skip_balanced(char open, char close) {
+    return details::skip_balanced<InputT>(open, close, std::nullopt);
+}
+
+/**
+ * Like skip_balanced(open, close), but brackets between quotes don't count, e.g. skip_balanced('{', '}', '"')
+ * skips {"a": "}"}. Like in structural_index, quotes can't be escaped.
+ */
+template<class InputT = Input>
+constexpr auto skip_balanced(char open, char close, char quote) {
+    return details::skip_balanced<InputT>(open, close, quote);
+}
+
+}
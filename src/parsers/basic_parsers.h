@@ -4,21 +4,24 @@
 
 namespace ctpc {
 
+template<class InputT = Input>
 constexpr auto success() {
-    return [] (Input input) -> ParseResult<std::nullptr_t> {
-        return ParseResult<std::nullptr_t>::success(input, nullptr);
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<unit, InputT> {
+        return ParseResult<unit, InputT>::success(input);
     };
 }
 
+template<class InputT = Input>
 constexpr auto failure() {
-    return [] (Input input) -> ParseResult<std::nullptr_t> {
-        return ParseResult<std::nullptr_t>::failure(input);
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<unit, InputT> {
+        return ParseResult<unit, InputT>::failure(input);
     };
 }
 
+template<class InputT = Input>
 constexpr auto error() {
-    return [] (Input input) -> ParseResult<std::nullptr_t> {
-        return ParseResult<std::nullptr_t>::error(input);
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<unit, InputT> {
+        return ParseResult<unit, InputT>::error(input);
     };
 }
 
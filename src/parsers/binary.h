@@ -0,0 +1,314 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "parsers/parse_result.h"
+#include "parsers/recognize.h"
+
+namespace ctpc {
+
+// Input for binary formats. Fields are returned as std::span<const std::byte> views into it, without copying.
+using BinaryInput = SpanInput<std::byte>;
+// Binary input that more input can follow, e.g. le<uint32_t, PartialBinaryInput>()
+using PartialBinaryInput = PartialSpanInput<std::byte>;
+
+namespace details {
+    template<size_t SIZE> struct unsigned_of_size;
+    template<> struct unsigned_of_size<1> final { using type = uint8_t; };
+    template<> struct unsigned_of_size<2> final { using type = uint16_t; };
+    template<> struct unsigned_of_size<4> final { using type = uint32_t; };
+    template<> struct unsigned_of_size<8> final { using type = uint64_t; };
+
+    template<class U>
+    constexpr U byteswap(U value) {
+#if defined(__cpp_lib_byteswap)
+        return std::byteswap(value);
+#else
+        if constexpr (sizeof(U) == 1) {
+            return value;
+        }
+#if defined(__GNUC__)
+        else if constexpr (sizeof(U) == 2) {
+            return __builtin_bswap16(value);
+        } else if constexpr (sizeof(U) == 4) {
+            return __builtin_bswap32(value);
+        } else {
+            return __builtin_bswap64(value);
+        }
+#else
+        // MSVC's _byteswap_*() aren't constexpr. It recognizes this loop as a byteswap.
+        else {
+            U result = 0;
+            for (size_t i = 0; i < sizeof(U); ++i) {
+                result = static_cast<U>(result << 8) | static_cast<U>((value >> (8 * i)) & 0xFF);
+            }
+            return result;
+        }
+#endif
+#endif
+    }
+
+    // Loads a T stored with the given byte order from an arbitrarily aligned address.
+    // At runtime, this is a single unaligned load, plus a byteswap if the byte order isn't the native one.
+    template<class T, std::endian ENDIAN>
+    constexpr T load(const std::byte* data) {
+        using U = typename unsigned_of_size<sizeof(T)>::type;
+        U value = 0;
+        if (std::is_constant_evaluated()) {
+            // memcpy isn't allowed in constant expressions
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                const size_t shift = 8 * (ENDIAN == std::endian::little ? i : sizeof(T) - 1 - i);
+                value |= static_cast<U>(std::to_integer<U>(data[i]) << shift);
+            }
+        } else {
+            std::memcpy(&value, data, sizeof(T));
+            if constexpr (ENDIAN != std::endian::native) {
+                value = byteswap(value);
+            }
+        }
+        return std::bit_cast<T>(value);
+    }
+
+    // Returns the ParseResult for an input that ended before the parser was done
+    template<class T, class InputT>
+    constexpr ParseResult<T, InputT> truncated(InputT input) noexcept(details::nothrow_paranoid_asserts) {
+        if (input.reaches_partial_end(input.input.size())) {
+            return ParseResult<T, InputT>::need_more(input);
+        }
+        return ParseResult<T, InputT>::failure(input);
+    }
+
+    template<class T, std::endian ENDIAN, class InputT>
+    constexpr auto fixed_width() {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "Only integers and floating point numbers have a fixed width encoding");
+        return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<T, InputT> {
+            if (input.input.size() < sizeof(T)) {
+                return truncated<T>(input);
+            }
+            return ParseResult<T, InputT>::success(input.advance(sizeof(T)), load<T, ENDIAN>(input.input.data()));
+        };
+    }
+}
+
+// Parses a little-endian integer or floating point number, e.g. le<uint32_t>()
+template<class T, class InputT = BinaryInput>
+constexpr auto le() {
+    return details::fixed_width<T, std::endian::little, InputT>();
+}
+
+// Parses a big-endian (network byte order) integer or floating point number, e.g. be<uint16_t>()
+template<class T, class InputT = BinaryInput>
+constexpr auto be() {
+    return details::fixed_width<T, std::endian::big, InputT>();
+}
+
+/**
+ * Parses an unsigned LEB128 varint as used by protobuf, DWARF and WebAssembly.
+ * Fails for varints that are longer than 10 bytes or don't fit into 64 bits.
+ */
+template<class InputT = BinaryInput>
+constexpr auto uleb128() {
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<uint64_t, InputT> {
+        constexpr size_t MAX_SIZE = 10;
+        uint64_t value = 0;
+        for (size_t i = 0; i < MAX_SIZE; ++i) {
+            if (i == input.input.size()) {
+                return details::truncated<uint64_t>(input);
+            }
+            const uint8_t byte = std::to_integer<uint8_t>(input.input[i]);
+            if (i == MAX_SIZE - 1 && byte > 1) {
+                // Only the lowest bit of the 10th byte still fits into 64 bits
+                return ParseResult<uint64_t, InputT>::failure(input);
+            }
+            value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) {
+                return ParseResult<uint64_t, InputT>::success(input.advance(i + 1), value);
+            }
+        }
+        return ParseResult<uint64_t, InputT>::failure(input);
+    };
+}
+
+/**
+ * Parses a signed LEB128 varint.
+ * Fails for varints that are longer than 10 bytes or don't fit into 64 bits.
+ */
+template<class InputT = BinaryInput>
+constexpr auto sleb128() {
+    return [] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<int64_t, InputT> {
+        constexpr size_t MAX_SIZE = 10;
+        uint64_t value = 0;
+        for (size_t i = 0; i < MAX_SIZE; ++i) {
+            if (i == input.input.size()) {
+                return details::truncated<int64_t>(input);
+            }
+            const uint8_t byte = std::to_integer<uint8_t>(input.input[i]);
+            if (i == MAX_SIZE - 1 && byte != 0x00 && byte != 0x7F) {
+                // The 10th byte only holds the sign bit, the rest of it has to be its sign extension
+                return ParseResult<int64_t, InputT>::failure(input);
+            }
+            const size_t shift = 7 * i;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                if (shift + 7 < 64 && (byte & 0x40) != 0) {
+                    // Negative number, sign extend it
+                    value |= ~uint64_t(0) << (shift + 7);
+                }
+                return ParseResult<int64_t, InputT>::success(input.advance(i + 1), std::bit_cast<int64_t>(value));
+            }
+        }
+        return ParseResult<int64_t, InputT>::failure(input);
+    };
+}
+
+// Parses the next num_bytes bytes and returns a view of them
+template<class InputT = BinaryInput>
+constexpr auto bytes(size_t num_bytes) {
+    return [num_bytes] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<std::span<const std::byte>, InputT> {
+        if (input.input.size() < num_bytes) {
+            return details::truncated<std::span<const std::byte>>(input);
+        }
+        return ParseResult<std::span<const std::byte>, InputT>::success(input.advance(num_bytes), input.take(num_bytes));
+    };
+}
+
+/**
+ * Matches a fixed byte sequence, e.g. the magic number at the start of a file format.
+ * The magic number can be given as a string literal, e.g. magic("\x7F" "ELF"). Its terminating zero isn't matched.
+ */
+template<class InputT = BinaryInput, size_t SIZE>
+constexpr auto magic(const std::array<std::byte, SIZE>& expected) {
+    return [expected] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<std::span<const std::byte>, InputT> {
+        for (size_t i = 0; i < SIZE; ++i) {
+            if (i == input.input.size()) {
+                return details::truncated<std::span<const std::byte>>(input);
+            }
+            if (input.input[i] != expected[i]) {
+                return ParseResult<std::span<const std::byte>, InputT>::failure(input);
+            }
+        }
+        return ParseResult<std::span<const std::byte>, InputT>::success(input.advance(SIZE), input.take(SIZE));
+    };
+}
+
+template<class InputT = BinaryInput, size_t SIZE>
+constexpr auto magic(const char (&expected)[SIZE]) {
+    static_assert(SIZE >= 1, "Expected a zero terminated string literal");
+    std::array<std::byte, SIZE - 1> expected_bytes{};
+    for (size_t i = 0; i < SIZE - 1; ++i) {
+        expected_bytes[i] = static_cast<std::byte>(expected[i]);
+    }
+    return magic<InputT>(expected_bytes);
+}
+
+namespace details {
+    // Checks the result of a length parser and turns it into a size_t. Fails for lengths that exceed the input.
+    template<class Length, class InputT>
+    constexpr ParseResult<size_t, InputT> frame_length(const ParseResult<Length, InputT>& parsed_length) noexcept(details::nothrow_asserts) {
+        static_assert(std::is_integral_v<Length>, "The length parser must return an integer");
+        if (!parsed_length.is_success()) {
+            return unsuccessful<size_t>(parsed_length);
+        }
+        const InputT next = parsed_length.next();
+        const Length length = parsed_length.result();
+        if (!std::in_range<size_t>(length)) {
+            return ParseResult<size_t, InputT>::failure(next);
+        }
+        if (next.input.size() < static_cast<size_t>(length)) {
+            return truncated<size_t>(next);
+        }
+        return ParseResult<size_t, InputT>::success(next, static_cast<size_t>(length));
+    }
+}
+
+/**
+ * Parses a length with the given parser, e.g. be<uint16_t>() or uleb128(), and then returns a view of that many
+ * elements following it. Works for text inputs as well, e.g. for netstrings.
+ */
+template<class LengthParser>
+constexpr auto length_prefixed(LengthParser&& length_parser) {
+    using InputT = parser_input_t<LengthParser>;
+    using result_type = typename InputT::view_type;
+    return details::dual_mode_parser{
+        [length_parser = std::forward<LengthParser>(length_parser)] (InputT input, auto mode) noexcept(details::is_nothrow_combinator_v<LengthParser>) -> details::mode_result_t<decltype(mode), result_type, InputT> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, InputT>;
+            // The length is needed in both modes, so the length parser always runs in parse mode
+            const auto length = details::frame_length(length_parser(input));
+            if (!length.is_success()) {
+                return details::unsuccessful<typename parse_result::result_type>(length);
+            }
+            if constexpr (decltype(mode)::recognize) {
+                return parse_result::success(length.next().advance(length.result()));
+            } else {
+                return parse_result::success(length.next().advance(length.result()), length.next().take(length.result()));
+            }
+        }
+    };
+}
+
+/**
+ * Parses a length with the given length parser, and then parses exactly that many elements with the body parser.
+ * Fails if the body parser doesn't consume the whole body. Since the body parser only sees the body, it can't read
+ * beyond the end of the frame, even if the length is wrong.
+ */
+template<class LengthParser, class BodyParser>
+constexpr auto length_prefixed(LengthParser&& length_parser, BodyParser&& body_parser) {
+    using InputT = common_parser_input_t<LengthParser, BodyParser>;
+    using result_type = parser_result_t<BodyParser>;
+    return details::dual_mode_parser{
+        [length_parser = std::forward<LengthParser>(length_parser), body_parser = std::forward<BodyParser>(body_parser)] (InputT input, auto mode) noexcept(details::is_nothrow_combinator_v<LengthParser> && details::is_nothrow_in_mode_v<decltype(mode), BodyParser>) -> details::mode_result_t<decltype(mode), result_type, InputT> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, InputT>;
+            const auto length = details::frame_length(length_parser(input));
+            if (!length.is_success()) {
+                return details::unsuccessful<typename parse_result::result_type>(length);
+            }
+            auto body = details::run_on_complete_subinput(body_parser, length.next().take(length.result()), mode);
+            if (!body.is_success()) {
+                return body;
+            }
+            if (body.next().input.size() != 0) {
+                // The body parser didn't consume the whole frame
+                return parse_result::failure(body.next());
+            }
+            body.setNext(length.next().advance(length.result()));
+            return body;
+        }
+    };
+}
+
+/**
+ * Runs the parser and then skips padding, so that the number of consumed elements is a multiple of ALIGNMENT,
+ * e.g. for fields padded to 4 bytes like in XDR or pcapng. The padding isn't checked.
+ * Inputs don't know their position, so the alignment is relative to where the parser started.
+ * To align fields relative to the start of a record, wrap the fields from the start of the record.
+ */
+template<size_t ALIGNMENT, class Parser>
+constexpr auto aligned(Parser&& parser) {
+    static_assert(ALIGNMENT > 0 && (ALIGNMENT & (ALIGNMENT - 1)) == 0, "The alignment must be a power of two");
+    using InputT = parser_input_t<Parser>;
+    using result_type = parser_result_t<Parser>;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser)] (InputT input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), Parser>) -> details::mode_result_t<decltype(mode), result_type, InputT> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, InputT>;
+            auto parsed = details::run_in_mode(parser, input, mode);
+            if (!parsed.is_success()) {
+                return parsed;
+            }
+            const size_t consumed = input.input.size() - parsed.next().input.size();
+            const size_t padding = (ALIGNMENT - consumed % ALIGNMENT) % ALIGNMENT;
+            if (parsed.next().input.size() < padding) {
+                return details::truncated<typename parse_result::result_type>(parsed.next());
+            }
+            parsed.setNext(parsed.next().advance(padding));
+            return parsed;
+        }
+    };
+}
+
+}
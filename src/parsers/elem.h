@@ -4,21 +4,31 @@
 
 namespace ctpc {
 
-template<class MatchFunction>
+/**
+ * Matches a single element of the input, if the match function returns true for it.
+ * Instead of a match function, the expected element can be given.
+ * For other inputs than plain text, give the input type, e.g. elem<PartialInput>('a') or elem<SpanInput<std::byte>>(std::byte{0x7F}).
+ */
+template<class InputT = Input, class MatchFunction>
 constexpr auto elem(MatchFunction&& match) {
-    return [match = std::forward<MatchFunction>(match)] (Input input) -> ParseResult<char> {
-        if (input.input.size() == 0) {
-            return ParseResult<char>::failure(input);
-        } else if (match(input.input[0])) {
-            return ParseResult<char>::success(Input{input.input.substr(1)}, input.input[0]);
-        } else {
-            return ParseResult<char>::failure(input);
-        }
-    };
-}
-
-constexpr auto elem(char expected) {
-    return elem([expected] (char v) {return v == expected;});
+    using element_type = typename InputT::element_type;
+    if constexpr (!std::is_invocable_r_v<bool, const std::decay_t<MatchFunction>&, const element_type&>) {
+        return elem<InputT>([expected = element_type(std::forward<MatchFunction>(match))] (const element_type& v) noexcept(noexcept(v == v)) {return v == expected;});
+    } else {
+        constexpr bool is_noexcept = std::is_nothrow_invocable_v<const std::decay_t<MatchFunction>&, const element_type&> && details::nothrow_paranoid_asserts;
+        return [match = std::forward<MatchFunction>(match)] (InputT input) noexcept(is_noexcept) CTPC_LEAF_INLINE -> ParseResult<element_type, InputT> {
+            if (input.input.size() == 0) {
+                if (input.reaches_partial_end(0)) {
+                    return ParseResult<element_type, InputT>::need_more(input);
+                }
+                return ParseResult<element_type, InputT>::failure(input);
+            } else if (match(input.input[0])) {
+                return ParseResult<element_type, InputT>::success(input.advance(1), input.input[0]);
+            } else {
+                return ParseResult<element_type, InputT>::failure(input);
+            }
+        };
+    }
 }
 
 }
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "parsers/parse_result.h"
+#include "parsers/utils/cvector.h"
+#include "parsers/utils/fixed_string.h"
+
+namespace ctpc {
+
+/**
+ * exact_size_traits describes how parse_exact_size() turns a parser result into a result with exact-size containers.
+ *
+ *  - shape(value) returns the sizes of all containers in the value. It must be usable as a template argument.
+ *  - convert<SHAPE>(value) moves the value into the exact-size result type for the given shape.
+ *
+ * By default, results are taken over as they are. std::vector and cvector are converted to a std::array with
+ * exactly as many elements as they have, and std::tuple (e.g. seq() results) and std::optional convert their
+ * elements. Containers can't contain other containers, because the inner ones would need a std::array size per
+ * element. Specialize exact_size_traits for your own result types that contain containers, see FunctionSignature
+ * in funcsig_parser for an example.
+ */
+template<class T>
+struct exact_size_traits final {
+    static constexpr size_t shape(const T&) {
+        return 0;
+    }
+
+    template<size_t SHAPE>
+    static constexpr T convert(T&& value) {
+        return std::move(value);
+    }
+};
+
+namespace details {
+    template<class T>
+    using exact_shape_t = decltype(exact_size_traits<T>::shape(std::declval<const T&>()));
+
+    template<class T, auto SHAPE>
+    using exact_size_t = decltype(exact_size_traits<T>::template convert<SHAPE>(std::declval<T>()));
+
+    // Elements of std::vector and cvector are moved into the std::array as they are
+    template<class T>
+    constexpr bool is_exact_size_element_v = std::is_same_v<T, exact_size_t<T, exact_shape_t<T>{}>>;
+
+    template<class Container, size_t... indices>
+    constexpr std::array<typename Container::value_type, sizeof...(indices)> to_array(Container&& container, std::index_sequence<indices...>) {
+        // Doesn't need a default constructor for the elements
+        return {std::move(container[indices])...};
+    }
+}
+
+template<class T, class Allocator>
+struct exact_size_traits<std::vector<T, Allocator>> final {
+    static_assert(details::is_exact_size_element_v<T>, "parse_exact_size() doesn't support containers whose elements contain containers. Specialize exact_size_traits for this result type.");
+
+    static constexpr size_t shape(const std::vector<T, Allocator>& value) {
+        return value.size();
+    }
+
+    template<size_t SIZE>
+    static constexpr std::array<T, SIZE> convert(std::vector<T, Allocator>&& value) {
+        ASSERT(value.size() == SIZE);
+        return details::to_array(std::move(value), std::make_index_sequence<SIZE>());
+    }
+};
+
+template<class T, size_t MAX_SIZE>
+struct exact_size_traits<cvector<T, MAX_SIZE>> final {
+    static_assert(details::is_exact_size_element_v<T>, "parse_exact_size() doesn't support containers whose elements contain containers. Specialize exact_size_traits for this result type.");
+
+    static constexpr size_t shape(const cvector<T, MAX_SIZE>& value) {
+        return value.size();
+    }
+
+    template<size_t SIZE>
+    static constexpr std::array<T, SIZE> convert(cvector<T, MAX_SIZE>&& value) {
+        ASSERT(value.size() == SIZE);
+        return details::to_array(std::move(value), std::make_index_sequence<SIZE>());
+    }
+};
+
+namespace details {
+    // Shape of a std::tuple, holding the shape of each element. Unlike std::tuple, it can be a template argument.
+    template<class... Shapes>
+    struct tuple_shape final {};
+    template<class Head, class... Tail>
+    struct tuple_shape<Head, Tail...> final {
+        Head head;
+        tuple_shape<Tail...> tail;
+    };
+
+    constexpr tuple_shape<> make_tuple_shape() {
+        return {};
+    }
+
+    template<class Head, class... Tail>
+    constexpr tuple_shape<Head, Tail...> make_tuple_shape(Head head, Tail... tail) {
+        return {head, make_tuple_shape(tail...)};
+    }
+
+    template<size_t INDEX, class Head, class... Tail>
+    constexpr auto get_shape(const tuple_shape<Head, Tail...>& shape) {
+        if constexpr (INDEX == 0) {
+            return shape.head;
+        } else {
+            return get_shape<INDEX - 1>(shape.tail);
+        }
+    }
+}
+
+template<class... Ts>
+struct exact_size_traits<std::tuple<Ts...>> final {
+    static constexpr auto shape(const std::tuple<Ts...>& value) {
+        return std::apply([] (const Ts&... elements) {
+            return details::make_tuple_shape(exact_size_traits<Ts>::shape(elements)...);
+        }, value);
+    }
+
+    template<auto SHAPE>
+    static constexpr auto convert(std::tuple<Ts...>&& value) {
+        return convert_<SHAPE>(std::move(value), std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template<auto SHAPE, size_t... indices>
+    static constexpr auto convert_(std::tuple<Ts...>&& value, std::index_sequence<indices...>) {
+        return std::tuple<details::exact_size_t<Ts, details::get_shape<indices>(SHAPE)>...>(
+            exact_size_traits<Ts>::template convert<details::get_shape<indices>(SHAPE)>(std::get<indices>(std::move(value)))...
+        );
+    }
+};
+
+// An empty optional has the default shape, e.g. a std::array of size zero
+template<class T>
+struct exact_size_traits<std::optional<T>> final {
+    static constexpr details::exact_shape_t<T> shape(const std::optional<T>& value) {
+        if (!value.has_value()) {
+            return {};
+        }
+        return exact_size_traits<T>::shape(*value);
+    }
+
+    template<auto SHAPE>
+    static constexpr std::optional<details::exact_size_t<T, SHAPE>> convert(std::optional<T>&& value) {
+        if (!value.has_value()) {
+            return std::nullopt;
+        }
+        return exact_size_traits<T>::template convert<SHAPE>(std::move(*value));
+    }
+};
+
+namespace details {
+    template<class ParserFactory>
+    using factory_parser_result_t = parser_result_t<decltype(std::declval<ParserFactory>()())>;
+
+    // First pass: Parse the input to find out the container sizes
+    template<fixed_string INPUT, class ParserFactory>
+    constexpr auto exact_shape() {
+        auto parsed = ParserFactory()()(Input{INPUT.view()});
+        using Traits = exact_size_traits<factory_parser_result_t<ParserFactory>>;
+        if (!parsed.is_success()) {
+            // The shape doesn't matter, the result won't have a value
+            return decltype(Traits::shape(parsed.result()))();
+        }
+        return Traits::shape(parsed.result());
+    }
+}
+
+/**
+ * Parses a compile time input into a result that only contains exact-size containers.
+ *
+ * The parser isn't limited by a compile time capacity, so you can (and should) use a parser with
+ * runtime_optimization. The input is parsed twice. The first pass finds out how many elements each container has,
+ * the second pass moves the elements into std::arrays of exactly that size. The std::vectors only exist while
+ * the compiler evaluates these passes, so the result is a constant without any unused capacity.
+ *
+ * ParserFactory must be a lambda without captures that returns the parser, because parsers themselves can't
+ * be template arguments. Example:
+ *
+ *   constexpr auto parsed = parse_exact_size<"1,2,3">([] {return repsep(runtime_optimization, integer(), elem(','));});
+ *   static_assert(std::is_same_v<std::array<int64_t, 3>, std::decay_t<decltype(parsed.result())>>);
+ */
+template<fixed_string INPUT, class ParserFactory>
+constexpr auto parse_exact_size(ParserFactory) {
+    static_assert(std::is_empty_v<ParserFactory> && std::is_default_constructible_v<ParserFactory>, "The parser factory must be a lambda without captures");
+    using Traits = exact_size_traits<details::factory_parser_result_t<ParserFactory>>;
+    constexpr auto shape = details::exact_shape<INPUT, ParserFactory>();
+    using result_type = decltype(Traits::template convert<shape>(std::declval<details::factory_parser_result_t<ParserFactory>>()));
+
+    // Second pass: Parse again and move the result into the exact-size containers
+    auto parsed = ParserFactory()()(Input{INPUT.view()});
+    switch (parsed.status()) {
+        case ResultStatus::SUCCESS: return ParseResult<result_type>::success(parsed.next(), Traits::template convert<shape>(std::move(parsed).result()));
+        case ResultStatus::FAILURE: return ParseResult<result_type>::failure(parsed.next());
+        case ResultStatus::ERROR: return ParseResult<result_type>::error(parsed.next());
+        case ResultStatus::NEED_MORE: return ParseResult<result_type>::need_more(parsed.next());
+    }
+}
+
+/**
+ * Parses a compile time input into static, read-only data, e.g. an embedded routing table or registry.
+ *
+ * Returns the parse_exact_size() result without the ParseResult wrapper and fails to compile if the input doesn't
+ * parse. Since the result is a constant, it can initialize constinit or static constexpr variables without any code
+ * running at program startup, independent of how large the input is. string_views in the result point into INPUT.
+ *
+ *   static constexpr auto numbers = materialize<"1,2,3">([] {return phrase(repsep(runtime_optimization, integer(), elem(',')));});
+ */
+template<fixed_string INPUT, class ParserFactory>
+constexpr auto materialize(ParserFactory) {
+    constexpr auto parsed = parse_exact_size<INPUT>(ParserFactory());
+    static_assert(parsed.is_success(), "Couldn't parse the input");
+    return parsed.result();
+}
+
+}
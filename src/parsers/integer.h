@@ -3,34 +3,54 @@
 #include "parsers/parse_result.h"
 #include "parsers/elem.h"
 #include "parsers/map.h"
+#include "parsers/recognize.h"
 #include "parsers/rep.h"
+#include "parsers/utils/kernels.h"
 
 namespace ctpc {
 
+template<class InputT = Input>
 constexpr auto numeric() {
-    return elem([] (char v) {
+    return elem<InputT>([] (char v) noexcept {
         return v >= '0' && v <= '9';
     });
 }
 
+template<class InputT = Input>
 constexpr auto digit() {
     return map(
-            numeric(),
+            numeric<InputT>(),
             [] (char digit) -> uint8_t {
                 return digit - '0';
             }
     );
 }
 
+template<class InputT = Input>
 constexpr auto integer() {
-    return rep1(
-        digit(),
-        [] () -> int64_t {return 0;},
-        [] (int64_t* accumulator, uint8_t digit) {
-            *accumulator *= 10;
-            *accumulator += digit;
+    return details::dual_mode_parser{[] (InputT input, auto mode) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> details::mode_result_t<decltype(mode), int64_t, InputT> {
+        using parse_result = details::mode_result_t<decltype(mode), int64_t, InputT>;
+        int64_t value = 0;
+        size_t num_digits;
+        if constexpr (decltype(mode)::recognize) {
+            // Only find the end of the number, without accumulating its value
+            num_digits = kernels::scan_while_class(input.input, kernels::make_char_class(kernels::char_range{'0', '9'}), input.padding);
+        } else {
+            num_digits = kernels::accumulate_digits(input.input, &value, input.padding);
         }
-    );
+        if (input.reaches_partial_end(num_digits)) {
+            // The number might continue in the next chunk
+            return parse_result::need_more(input.advance(num_digits));
+        }
+        if (num_digits == 0) {
+            return parse_result::failure(input);
+        }
+        if constexpr (decltype(mode)::recognize) {
+            return parse_result::success(input.advance(num_digits));
+        } else {
+            return parse_result::success(input.advance(num_digits), value);
+        }
+    }};
 }
 
 }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "parsers/parse_result.h"
+#include "parsers/recognize.h"
+
+namespace ctpc {
+
+/**
+ * Result of lazy(), see below. Holds a part of the input together with the parser for it,
+ * and only runs the parser when the value is accessed for the first time.
+ *
+ * The parse result is cached in the lazy_value, so the parser runs at most once. Accessing the value therefore
+ * modifies the lazy_value and needs a non-const reference to it. This also keeps it usable in constant expressions,
+ * which don't allow mutable members.
+ */
+template<class Parser>
+class lazy_value final {
+public:
+    using value_type = parser_result_t<Parser>;
+    using input_type = parser_input_t<Parser>;
+
+    constexpr lazy_value(std::string_view text, Parser parser) noexcept(std::is_nothrow_move_constructible_v<Parser>)
+    : text_(text), parser_(std::move(parser)), parsed_(std::nullopt) {}
+
+    constexpr lazy_value(const lazy_value& rhs) = default;
+    constexpr lazy_value(lazy_value&& rhs) = default;
+
+    // Parsers are lambdas, which can't be assigned. Instead, the parser is destructed and constructed again.
+    // That would construct it from the destructed parser on self-assignment, so self-assignment does nothing.
+    constexpr lazy_value& operator=(const lazy_value& rhs) {
+        if (this != &rhs) {
+            text_ = rhs.text_;
+            parser_.emplace(*rhs.parser_);
+            parsed_ = rhs.parsed_;
+        }
+        return *this;
+    }
+
+    constexpr lazy_value& operator=(lazy_value&& rhs) {
+        if (this != &rhs) {
+            text_ = rhs.text_;
+            parser_.emplace(std::move(*rhs.parser_));
+            parsed_ = std::move(rhs.parsed_);
+        }
+        return *this;
+    }
+
+    // The text the parser will parse
+    constexpr std::string_view text() const {
+        return text_;
+    }
+
+    // True if the parser already ran
+    constexpr bool is_parsed() const {
+        return parsed_.has_value();
+    }
+
+    // Parses the text on the first call. The result is a FAILURE if the parser doesn't consume the whole text.
+    constexpr const ParseResult<value_type, input_type>& parse() {
+        if (!parsed_.has_value()) {
+            auto parsed = details::run_on_complete_subinput(*parser_, text_, details::parse_mode{});
+            if (parsed.is_success() && parsed.next().input.size() != 0) {
+                // The parser didn't consume the whole text
+                parsed_.emplace(ParseResult<value_type, input_type>::failure(parsed.next()));
+            } else {
+                parsed_.emplace(std::move(parsed));
+            }
+        }
+        return *parsed_;
+    }
+
+    // Parses the text on the first call and returns the parsed value. The parser must succeed.
+    constexpr const value_type& get() {
+        const ParseResult<value_type, input_type>& parsed = parse();
+        ASSERT(parsed.is_success());
+        return parsed.result();
+    }
+
+private:
+    std::string_view text_;
+    // Always has a value, the std::optional only allows assignments, see above
+    std::optional<Parser> parser_;
+    std::optional<ParseResult<value_type, input_type>> parsed_;
+};
+
+/**
+ * Defers parsing a part of the input until its value is needed.
+ *
+ * The skip parser only finds the boundaries of that part and returns it as a std::string_view, e.g. skip_balanced()
+ * or skip_to(). This is cheap since it doesn't build any results. The result of lazy() is a lazy_value holding the
+ * skipped text and the parser, which parses it on the first access and has to consume all of it.
+ *
+ * If most results are discarded without looking at the lazy part, e.g. when filtering records by name,
+ * this saves the work and allocations of parsing that part. Errors in it only show up when it is accessed.
+ *
+ * Example:
+ *   lazy(skip_balanced('(', ')'), parameter_list(runtime_optimization))
+ */
+template<class SkipParser, class Parser>
+constexpr auto lazy(SkipParser&& skip, Parser&& parser) {
+    static_assert(std::is_same_v<std::string_view, parser_result_t<SkipParser>>, "The skip parser must return the text to parse lazily");
+    using InputT = parser_input_t<SkipParser>;
+    using value_type = lazy_value<std::decay_t<Parser>>;
+    // Each result gets a copy of the parser
+    constexpr bool is_noexcept = std::is_nothrow_constructible_v<value_type, std::string_view, const std::decay_t<Parser>&> && std::is_nothrow_move_constructible_v<value_type>;
+    // In recognizer mode, only the skip parser runs and no lazy_value is created
+    return details::dual_mode_parser{
+        [skip = std::forward<SkipParser>(skip), parser = std::forward<Parser>(parser)] (InputT input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), SkipParser> && (decltype(mode)::recognize || is_noexcept)) -> details::mode_result_t<decltype(mode), value_type, InputT> {
+            if constexpr (decltype(mode)::recognize) {
+                return details::run_recognizer(skip, input);
+            } else {
+                using result_type = ParseResult<value_type, InputT>;
+                const auto skipped = skip(input);
+                if (!skipped.is_success()) {
+                    return details::unsuccessful<value_type>(skipped);
+                }
+                return result_type::success(skipped.next(), skipped.result(), parser);
+            }
+        }
+    };
+}
+
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "parsers/parse_result.h"
+#include "parsers/recognize.h"
+
+namespace ctpc {
+
+/**
+ * A token produced by a lexer, see lexer() below. It points to its text in the lexed input.
+ * Tokens are 16 bytes, so token arrays stay compact and token parsers only pass a std::span around.
+ */
+template<class Kind>
+struct Token final {
+    const char* begin;
+    uint32_t length;
+    Kind kind;
+
+    constexpr std::string_view text() const noexcept {
+        return std::string_view(begin, length);
+    }
+
+    constexpr bool operator==(const Token& rhs) const {
+        return kind == rhs.kind && text() == rhs.text();
+    }
+};
+
+// Input of token parsers, see tokenized(). It's partial while the lexer hasn't reached the end of the tokens yet.
+template<class Kind> using TokenInput = BasicInput<std::span<const Token<Kind>>, false, true>;
+
+template<class Kind, class Parser>
+struct lexer_rule final {
+    Kind kind;
+    Parser parser;
+};
+
+// A lexer rule producing tokens of the given kind for all text matched by the parser
+template<class Kind, class Parser>
+constexpr lexer_rule<Kind, std::decay_t<Parser>> rule(Kind kind, Parser&& parser) {
+    return {kind, std::forward<Parser>(parser)};
+}
+
+namespace details {
+    // Lexing a token can't throw if the rules can't throw in recognizer mode. Building the token array can.
+    template<class... RuleParsers>
+    constexpr bool is_nothrow_lex_token_v = details::nothrow_asserts && (... && is_nothrow_recognizer_v<RuleParsers>);
+
+    // Tries the rules in order, the first one that doesn't fail decides. Tokens only need the length of the match,
+    // so the rules run in recognizer mode.
+    template<size_t I = 0, class Kind, class InputT, class... RuleParsers>
+    constexpr ResultStatus lex_token(const std::tuple<lexer_rule<Kind, RuleParsers>...>& rules, InputT input, Token<Kind>* token) noexcept(is_nothrow_lex_token_v<RuleParsers...>) {
+        if constexpr (I == sizeof...(RuleParsers)) {
+            return ResultStatus::FAILURE;
+        } else {
+            const auto& rule = std::get<I>(rules);
+            const auto parsed = run_recognizer(rule.parser, input);
+            // Empty tokens would be produced forever, so a rule matching the empty string doesn't match
+            if (parsed.is_failure() || (parsed.is_success() && parsed.next().input.size() == input.input.size())) {
+                return lex_token<I + 1>(rules, input, token);
+            }
+            if (parsed.is_success()) {
+                const size_t length = input.input.size() - parsed.next().input.size();
+                if (length > std::numeric_limits<uint32_t>::max()) {
+                    // Too long for Token::length
+                    return ResultStatus::ERROR;
+                }
+                *token = Token<Kind>{input.input.data(), static_cast<uint32_t>(length), rule.kind};
+            }
+            return parsed.status();
+        }
+    }
+}
+
+namespace details {
+    // Reserves space for the next batch, but not for more tokens than the rest of the text likely has. Most grammars
+    // have a token every few characters. Reserving for that avoids most reallocations of large token arrays.
+    template<class Token, class InputT>
+    constexpr void reserve_token_batch(std::vector<Token>* tokens, size_t batch, InputT rest) {
+        tokens->reserve(tokens->size() + std::min(batch, rest.input.size() / 8));
+    }
+
+    template<class InputT, class SkipParser, class Kind, class... RuleParsers>
+    struct lexer_parser final {
+        using input_type = InputT;
+        using token_type = Token<Kind>;
+        static constexpr bool is_nothrow_lex = is_nothrow_recognizer_v<SkipParser> && is_nothrow_lex_token_v<RuleParsers...>;
+
+        SkipParser skip;
+        std::tuple<lexer_rule<Kind, RuleParsers>...> rules;
+
+        constexpr ParseResult<std::vector<token_type>, InputT> operator()(InputT input) const {
+            std::vector<token_type> tokens;
+            reserve_token_batch(&tokens, SIZE_MAX, input);
+            const auto lexed = lex(input, std::numeric_limits<size_t>::max(), &tokens);
+            if (!lexed.is_success()) {
+                return unsuccessful<std::vector<token_type>>(lexed);
+            }
+            return ParseResult<std::vector<token_type>, InputT>::success(lexed.next(), std::move(tokens));
+        }
+
+        // In recognizer mode, the lexer only finds the end of the last token and doesn't build the token array
+        constexpr recognized<InputT> recognize(InputT input) const noexcept(is_nothrow_lex) {
+            const auto lexed = lex_<false>(input, std::numeric_limits<size_t>::max(), nullptr);
+            if (!lexed.is_success()) {
+                return unsuccessful<unit>(lexed);
+            }
+            return recognized<InputT>::success(lexed.next());
+        }
+
+        // Lexes at most max_tokens tokens and appends them to tokens. The result is true if no more tokens follow,
+        // and next() points after the last token. On NEED_MORE or ERROR, the tokens lexed before are appended as well.
+        constexpr ParseResult<bool, InputT> lex(InputT input, size_t max_tokens, std::vector<token_type>* tokens) const {
+            return lex_<true>(input, max_tokens, tokens);
+        }
+
+        template<bool STORE>
+        constexpr ParseResult<bool, InputT> lex_(InputT input, size_t max_tokens, std::vector<token_type>* tokens) const noexcept(!STORE && is_nothrow_lex) {
+            InputT current = input;
+            for (size_t num_tokens = 0; num_tokens < max_tokens; ++num_tokens) {
+                const auto skipped = run_recognizer(skip, current);
+                if (skipped.is_need_more() || skipped.is_error()) {
+                    return unsuccessful<bool>(skipped);
+                }
+                const InputT token_begin = skipped.is_success() ? skipped.next() : current;
+                token_type token{};
+                switch (lex_token(rules, token_begin, &token)) {
+                    case ResultStatus::SUCCESS:
+                        if constexpr (STORE) {
+                            tokens->push_back(token);
+                        }
+                        current = token_begin.advance(token.length);
+                        break;
+                    case ResultStatus::FAILURE: return ParseResult<bool, InputT>::success(current, true);
+                    case ResultStatus::ERROR: return ParseResult<bool, InputT>::error(token_begin);
+                    case ResultStatus::NEED_MORE: return ParseResult<bool, InputT>::need_more(token_begin);
+                }
+            }
+            return ParseResult<bool, InputT>::success(current, false);
+        }
+    };
+}
+
+/**
+ * First stage of a two-stage parser, see tokenized() below.
+ *
+ * The lexer is a text parser that splits its input into tokens in a single pass. Before each token, it skips
+ * anything the skip parser matches, e.g. whitespaces(). Then it tries the rules in the given order, and the first
+ * rule that matches produces the next token. Rules matching the empty string, e.g. opt(...) or whitespaces(), don't
+ * produce a token, and the next rule is tried instead. Lexing stops at the first position no rule matches, so the result
+ * is always a success with all tokens up to there.
+ *
+ * Example:
+ *   lexer(whitespaces(), rule(Kind::NUMBER, integer()), rule(Kind::PLUS, elem('+')))
+ */
+template<class SkipParser, class Kind, class... RuleParsers>
+constexpr auto lexer(SkipParser&& skip, lexer_rule<Kind, RuleParsers>... rules) {
+    using InputT = parser_input_t<SkipParser>;
+    return details::lexer_parser<InputT, std::decay_t<SkipParser>, Kind, RuleParsers...>{std::forward<SkipParser>(skip), std::make_tuple(std::move(rules)...)};
+}
+
+// Matches a token of the given kind and returns its text
+template<class Kind>
+constexpr auto token(Kind kind) {
+    using result_type = ParseResult<std::string_view, TokenInput<Kind>>;
+    return [kind] (TokenInput<Kind> input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> result_type {
+        if (input.input.empty()) {
+            if (input.reaches_partial_end(0)) {
+                return result_type::need_more(input);
+            }
+            return result_type::failure(input);
+        }
+        if (input.input[0].kind != kind) {
+            return result_type::failure(input);
+        }
+        return result_type::success(input.advance(1), input.input[0].text());
+    };
+}
+
+namespace details {
+    // tokenized() first lexes 32 tokens, and each further round lexes until it has 8 times as many.
+    // Each round recognizes all tokens again, so a smaller growth factor makes parsing a long text noticeably slower.
+    constexpr size_t FIRST_TOKEN_BATCH = 32;
+    constexpr size_t TOKEN_BATCH_GROWTH = 8;
+}
+
+/**
+ * Two-stage parser: Splits the text into tokens with the lexer, and then parses the tokens with the token parser.
+ *
+ * Character-level parsers look at the same characters again whenever an alternative fails, and every
+ * whitespaces() in the grammar scans the input again. With a lexer, each character is only scanned once, and the
+ * token parser only compares token kinds, which are integers.
+ *
+ * The tokens are lexed in batches of growing size, only as far as the token parser needs them. Until the lexer
+ * reached the end of the tokens, the token parser gets a partial input and returns NEED_MORE if it needs more tokens.
+ * It then runs again on 8 times as many tokens. So the work stays proportional to the consumed input, even
+ * if tokenized() is called many times on the same text, e.g. in a rep(). Only the last run builds a result, the runs
+ * before only recognize.
+ *
+ * The result is a text parser again. On success, it consumes the text up to the end of the last token the token
+ * parser consumed. Otherwise, next() points to the token it stopped at. Results of the token parser can contain
+ * std::string_views of token texts, but they must not keep references to the tokens, which only live during the call.
+ */
+template<class Lexer, class TokenParser>
+constexpr auto tokenized(Lexer&& lexer, TokenParser&& parser) {
+    using InputT = parser_input_t<Lexer>;
+    using token_type = typename std::decay_t<Lexer>::token_type;
+    using token_input = parser_input_t<TokenParser>;
+    static_assert(std::is_same_v<token_input, TokenInput<decltype(token_type::kind)>>, "The token parser must parse the lexer's tokens");
+    using result_type = parser_result_t<TokenParser>;
+    return details::dual_mode_parser{
+        [lexer = std::forward<Lexer>(lexer), parser = std::forward<TokenParser>(parser)] (InputT input, auto mode) noexcept(details::is_nothrow_combinator_v<Lexer> && details::is_nothrow_in_mode_v<decltype(mode), TokenParser>) -> details::mode_result_t<decltype(mode), result_type, InputT> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, InputT>;
+            std::vector<token_type> tokens;
+            details::reserve_token_batch(&tokens, details::FIRST_TOKEN_BATCH, input);
+            auto lexed = lexer.lex(input, details::FIRST_TOKEN_BATCH, &tokens);
+            while (!(lexed.is_success() && lexed.result())) {
+                // Until the lexer reached the end of the tokens, it's enough to recognize whether the token parser needs more
+                const auto recognized = details::run_recognizer(parser, token_input{tokens, {}, true});
+                if (!recognized.is_need_more()) {
+                    break;
+                }
+                if (!lexed.is_success()) {
+                    // The token parser needs the tokens after the position the lexer failed at
+                    return details::unsuccessful<typename parse_result::result_type>(lexed);
+                }
+                const size_t batch = (details::TOKEN_BATCH_GROWTH - 1) * tokens.size();
+                details::reserve_token_batch(&tokens, batch, lexed.next());
+                lexed = lexer.lex(lexed.next(), batch, &tokens);
+            }
+            const bool all_tokens = lexed.is_success() && lexed.result();
+            auto parsed = details::run_in_mode(parser, token_input{tokens, {}, !all_tokens}, mode);
+
+            const size_t consumed = tokens.size() - parsed.next().input.size();
+            const char* end;
+            if (parsed.is_success()) {
+                end = consumed == 0 ? input.input.data() : tokens[consumed - 1].begin + tokens[consumed - 1].length;
+            } else {
+                end = consumed < tokens.size() ? tokens[consumed].begin : lexed.next().input.data();
+            }
+            const InputT next = input.advance(end - input.input.data());
+            switch (parsed.status()) {
+                case ResultStatus::SUCCESS:
+                    if constexpr (decltype(mode)::recognize) {
+                        return parse_result::success(next);
+                    } else {
+                        return parse_result::success(next, std::move(parsed).result());
+                    }
+                case ResultStatus::FAILURE: return parse_result::failure(next);
+                case ResultStatus::ERROR:
+                case ResultStatus::NEED_MORE: break;
+            }
+            // The recognizer didn't need more tokens, so a NEED_MORE result means the token parser decides differently
+            // in parse and recognizer mode, which is a bug. It's reported as an error, like an ERROR result.
+            return parse_result::error(next);
+        }
+    };
+}
+
+}
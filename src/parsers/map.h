@@ -1,13 +1,16 @@
 #pragma once
 
 #include "parsers/parse_result.h"
+#include "parsers/recognize.h"
 
 namespace ctpc {
 
 template<class Parser, class MapFunction>
 constexpr auto flatMap(Parser&& parser, MapFunction&& mapFunction) {
-    using result_type = typename decltype(mapFunction(std::declval<ParseResult<parser_result_t<Parser>>>()))::result_type;
-    return [parser = std::forward<Parser>(parser), mapFunction = std::forward<MapFunction>(mapFunction)] (Input input) -> ParseResult<result_type> {
+    using input_type = parser_input_t<Parser>;
+    using result_type = typename decltype(mapFunction(std::declval<ParseResult<parser_result_t<Parser>, input_type>>()))::result_type;
+    constexpr bool is_noexcept = details::is_nothrow_parser_v<Parser> && std::is_nothrow_invocable_v<const std::decay_t<MapFunction>&, ParseResult<parser_result_t<Parser>, input_type>&&>;
+    return [parser = std::forward<Parser>(parser), mapFunction = std::forward<MapFunction>(mapFunction)] (input_type input) noexcept(is_noexcept) -> ParseResult<result_type, input_type> {
         return mapFunction(parser(input));
     };
 }
@@ -16,9 +19,18 @@ template<class Parser, class MapFunction>
 constexpr auto map(Parser&& parser, MapFunction&& mapFunction) {
     // This could be implemented using flatMap() and a function wrapping the result, but that'd need
     // to move the mapFunction one more time. We take a different approach to avoid that move.
+    // In recognizer mode, the map function doesn't run.
     using result_type = decltype(mapFunction(std::declval<parser_result_t<Parser>>()));
-    return [parser = std::forward<Parser>(parser), mapFunction = std::forward<MapFunction>(mapFunction)] (Input input) -> ParseResult<result_type> {
-        return parser(input).map(mapFunction);
+    using input_type = parser_input_t<Parser>;
+    constexpr bool is_noexcept = std::is_nothrow_invocable_v<const std::decay_t<MapFunction>&, parser_result_t<Parser>&&> && std::is_nothrow_move_constructible_v<result_type>;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser), mapFunction = std::forward<MapFunction>(mapFunction)] (input_type input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), Parser> && (decltype(mode)::recognize || is_noexcept)) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            if constexpr (decltype(mode)::recognize) {
+                return details::run_recognizer(parser, input);
+            } else {
+                return parser(input).map(mapFunction);
+            }
+        }
     };
 }
 
@@ -26,8 +38,17 @@ template<class Result, class Parser>
 constexpr auto mapValue(Parser&& parser, Result&& value) {
     // This could be implemented using map() and a function always returning a constant, but that'd need
     // to move the value one more time. We take a different approach to avoid that move.
-    return [parser = std::forward<Parser>(parser), value = std::forward<Result>(value)] (Input input) -> ParseResult<std::decay_t<Result>> {
-        return parser(input).mapValue(value);
+    using result_type = std::decay_t<Result>;
+    using input_type = parser_input_t<Parser>;
+    constexpr bool is_noexcept = std::is_nothrow_copy_constructible_v<result_type>;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser), value = std::forward<Result>(value)] (input_type input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), Parser> && (decltype(mode)::recognize || is_noexcept)) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            if constexpr (decltype(mode)::recognize) {
+                return details::run_recognizer(parser, input);
+            } else {
+                return parser(input).mapValue(value);
+            }
+        }
     };
 }
 
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include "parsers/parse_result.h"
+
+#if defined(_WIN32)
+#error "mapped_input needs mmap() and is only available on POSIX systems. Use padded_input::from_file() instead."
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ctpc {
+
+struct mapped_input_options final {
+    // Fault in all pages while mapping (MAP_POPULATE, Linux only). Makes the mmap() call slower,
+    // but parsing doesn't have to wait for page faults anymore.
+    bool populate = false;
+
+    // Ask the kernel to back the mapping with transparent huge pages (MADV_HUGEPAGE, Linux only).
+    // This is only a hint, for regular files it needs kernel support for read-only file THPs.
+    bool huge_pages = false;
+};
+
+namespace details {
+    class file_mapping final {
+    public:
+        file_mapping(const std::filesystem::path& path, const mapped_input_options& options)
+        : data_(nullptr), size_(0), padding_(0) {
+            const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1) {
+                details::throw_exception<std::system_error>(errno, std::generic_category(), "Couldn't open " + path.string());
+            }
+            // The mapping stays valid after closing the file descriptor
+            struct fd_closer final { int fd; ~fd_closer() { ::close(fd); } } closer{fd};
+
+            struct stat file_stat;
+            if (::fstat(fd, &file_stat) == -1) {
+                details::throw_exception<std::system_error>(errno, std::generic_category(), "Couldn't stat " + path.string());
+            }
+            size_ = static_cast<size_t>(file_stat.st_size);
+            if (size_ == 0) {
+                // mmap() doesn't support empty mappings
+                return;
+            }
+
+            int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+            if (options.populate) {
+                flags |= MAP_POPULATE;
+            }
+#endif
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+            if (mapped == MAP_FAILED) {
+                details::throw_exception<std::system_error>(errno, std::generic_category(), "Couldn't map " + path.string());
+            }
+            data_ = static_cast<const char*>(mapped);
+
+            // The rest of the last page is readable and filled with zeroes, so it can serve as PaddedInput::padding
+            const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            padding_ = (page_size - size_ % page_size) % page_size;
+
+            // Parsers read the input front to back, so the kernel can read ahead aggressively and drop pages early.
+            // These are just hints, failures don't matter.
+            ::madvise(mapped, size_, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+            if (options.huge_pages) {
+                ::madvise(mapped, size_, MADV_HUGEPAGE);
+            }
+#endif
+        }
+
+        ~file_mapping() {
+            if (data_ != nullptr) {
+                ::munmap(const_cast<char*>(data_), size_);
+            }
+        }
+
+        file_mapping(const file_mapping&) = delete;
+        file_mapping& operator=(const file_mapping&) = delete;
+
+        std::string_view view() const {
+            return std::string_view(data_, size_);
+        }
+
+        size_t padding() const {
+            return padding_;
+        }
+
+    private:
+        const char* data_;
+        size_t size_;
+        size_t padding_;
+    };
+}
+
+template<class T> class owning_parse_result;
+
+/**
+ * mapped_input makes a file available as parser Input by mapping it read-only into memory.
+ * This avoids reading the whole file into a std::string first, which would need twice the memory and a full copy.
+ *
+ * The mapping is shared between copies of a mapped_input and unmapped when the last one is destructed.
+ * Parse results can contain std::string_views pointing into the mapping. Use parse() to get a result that keeps
+ * the mapping alive, or make sure the mapped_input outlives the result.
+ *
+ * Throws std::system_error if the file can't be opened or mapped. Only available on POSIX systems.
+ */
+class mapped_input final {
+public:
+    explicit mapped_input(const std::filesystem::path& path, mapped_input_options options = {})
+    : mapping_(std::make_shared<const details::file_mapping>(path, options)) {}
+
+    PaddedInput input() const {
+        return PaddedInput{view(), mapping_->padding()};
+    }
+
+    std::string_view view() const {
+        return mapping_->view();
+    }
+
+    size_t size() const {
+        return view().size();
+    }
+
+    // Runs the parser on the file contents and returns a result that keeps the mapping alive
+    template<class Parser>
+    owning_parse_result<parser_result_t<Parser>> parse(const Parser& parser) const {
+        return owning_parse_result<parser_result_t<Parser>>(parser(input()), *this);
+    }
+
+private:
+    std::shared_ptr<const details::file_mapping> mapping_;
+};
+
+/**
+ * A ParseResult together with the mapped_input it was parsed from,
+ * so that std::string_views in the result stay valid as long as this object lives.
+ */
+template<class T>
+class owning_parse_result final {
+public:
+    owning_parse_result(ParseResult<T, PaddedInput> result, mapped_input owner)
+    : result_(std::move(result)), owner_(std::move(owner)) {}
+
+    const ParseResult<T, PaddedInput>& operator*() const {
+        return result_;
+    }
+
+    const ParseResult<T, PaddedInput>* operator->() const {
+        return &result_;
+    }
+
+private:
+    ParseResult<T, PaddedInput> result_;
+    mapped_input owner_;
+};
+
+}
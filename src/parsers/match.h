@@ -1,28 +1,34 @@
 #pragma once
 
 #include "parsers/map.h"
+#include "parsers/recognize.h"
 
 namespace ctpc {
 
 /**
  * This parser wraps another parser and discards its result.
- * Instead, if the wrapped parser was successful, it returns a std::string_view
+ * Instead, if the wrapped parser was successful, it returns a std::string_view (or the view type of the input)
  * containing the part of the input sequence matched by the inner parser.
+ * The inner parser runs in recognizer mode (see recognize()), so its result isn't even built.
  */
 template<class Parser>
 constexpr auto match(Parser&& parser) {
-    return [parser = std::forward<Parser>(parser)] (Input input) {
-        auto parsed = parser(input);
-
-        if (parsed.is_success()) {
-            const int64_t match_length = input.input.size() - parsed.next().input.size();
-            return ParseResult<std::string_view>::success(parsed.next(), input.input.substr(0, match_length));
-        }
-        if (parsed.is_failure()) {
-            return ParseResult<std::string_view>::failure(parsed.next());
+    using input_type = parser_input_t<Parser>;
+    using view_type = typename input_type::view_type;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser)] (input_type input, auto mode) noexcept(details::is_nothrow_recognizer_v<Parser>) -> details::mode_result_t<decltype(mode), view_type, input_type> {
+            auto parsed = details::run_recognizer(parser, input);
+            if constexpr (decltype(mode)::recognize) {
+                return parsed;
+            } else {
+                using parse_result = ParseResult<view_type, input_type>;
+                if (parsed.is_success()) {
+                    const int64_t match_length = input.input.size() - parsed.next().input.size();
+                    return parse_result::success(parsed.next(), input.take(match_length));
+                }
+                return details::unsuccessful<view_type>(parsed);
+            }
         }
-        ASSERT(parsed.is_error());
-        return ParseResult<std::string_view>::error(parsed.next());
     };
 }
 
@@ -4,22 +4,37 @@
 #include "parsers/basic_parsers.h"
 #include "parsers/map.h"
 #include "parsers/alternative.h"
+#include "parsers/recognize.h"
 
 namespace ctpc {
 
 template<class Parser>
 constexpr auto opt(Parser&& parser) {
-    using parse_result = ParseResult<std::optional<parser_result_t<Parser>>>;
-    return [parser = std::forward<Parser>(parser)] (Input input) -> parse_result {
-        auto parsed = parser(input);
-        if (parsed.is_success()) {
-            Input next = parsed.next();
-            return parse_result::success(next, std::move(parsed).result());
-        } else if (parsed.is_failure()) {
-            return parse_result::success(input, std::nullopt);
-        } else {
-            ASSERT(parsed.is_error());
-            return parse_result::error(parsed.next());
+    using input_type = parser_input_t<Parser>;
+    using result_type = std::optional<parser_result_t<Parser>>;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser)] (input_type input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), Parser>) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, input_type>;
+            auto parsed = details::run_in_mode(parser, input, mode);
+            if (parsed.is_success()) {
+                if constexpr (decltype(mode)::recognize) {
+                    return parsed;
+                } else {
+                    auto next = parsed.next();
+                    return parse_result::success(next, std::move(parsed).result());
+                }
+            } else if (parsed.is_failure()) {
+                if constexpr (decltype(mode)::recognize) {
+                    return parse_result::success(input);
+                } else {
+                    return parse_result::success(input, std::nullopt);
+                }
+            } else if (parsed.is_need_more()) {
+                return parse_result::need_more(parsed.next());
+            } else {
+                ASSERT_PARANOID(parsed.is_error());
+                return parse_result::error(parsed.next());
+            }
         }
     };
 }
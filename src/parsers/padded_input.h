@@ -0,0 +1,78 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include "parsers/parse_result.h"
+
+namespace ctpc {
+
+/**
+ * padded_input owns an input buffer that is followed by PADDING zero bytes.
+ *
+ * Its input() is a PaddedInput that reports the padding, so the runtime kernels can read full SIMD blocks at the end
+ * of the input as well and don't need a byte-by-byte loop for the last few characters.
+ * PADDING is large enough for the widest kernels (AVX-512).
+ */
+class padded_input final {
+public:
+    static constexpr size_t PADDING = 64;
+
+    // Copies the input into a new padded buffer
+    static padded_input copy_from(std::string_view input) {
+        std::string buffer;
+        buffer.reserve(input.size() + PADDING);
+        buffer.append(input);
+        return padded_input(std::move(buffer));
+    }
+
+    // Takes over the string and appends the padding.
+    // This only copies the string if it doesn't have PADDING bytes of spare capacity.
+    static padded_input from_string(std::string&& input) {
+        return padded_input(std::move(input));
+    }
+
+    // Reads the file directly into a padded buffer.
+    // Throws std::system_error if the file can't be read.
+    static padded_input from_file(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::error_code error;
+        const uintmax_t size = std::filesystem::file_size(path, error);
+        if (!file || error) {
+            details::throw_exception<std::system_error>(error ? error : std::make_error_code(std::errc::io_error), "Couldn't open " + path.string());
+        }
+        std::string buffer(size + PADDING, '\0');
+        if (!file.read(buffer.data(), static_cast<std::streamsize>(size))) {
+            details::throw_exception<std::system_error>(std::make_error_code(std::errc::io_error), "Couldn't read " + path.string());
+        }
+        buffer.resize(size);
+        return padded_input(std::move(buffer));
+    }
+
+    PaddedInput input() const {
+        return PaddedInput{view(), PADDING};
+    }
+
+    std::string_view view() const {
+        return std::string_view(buffer_.data(), size_);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    explicit padded_input(std::string&& buffer)
+    : buffer_(std::move(buffer)), size_(buffer_.size()) {
+        // The padding is part of the string, so that reading it is well defined. Since the buffer is always larger
+        // than the small string optimization, moving a padded_input doesn't move the characters.
+        buffer_.resize(size_ + PADDING, '\0');
+    }
+
+    std::string buffer_;
+    size_t size_;
+};
+
+}
@@ -1,9 +1,22 @@
 #pragma once
 
+#include <span>
 #include <string_view>
 #include <optional>
+#include <type_traits>
 #include "parsers/utils/assert.h"
 
+/**
+ * Leaf parsers like elem() or string() are small, but each combinator around them adds a call layer, and GCC
+ * doesn't always inline through all of them. Defining CTPC_FORCE_INLINE_LEAF_PARSERS makes the leaf parsers
+ * always_inline. This usually makes hot loops faster and the binary larger.
+ */
+#if defined(CTPC_FORCE_INLINE_LEAF_PARSERS) && defined(__GNUC__)
+#define CTPC_LEAF_INLINE __attribute__((always_inline))
+#else
+#define CTPC_LEAF_INLINE
+#endif
+
 namespace ctpc {
 
 // TODO Add test cases for ParseResult
@@ -11,44 +24,154 @@ namespace ctpc {
 // TODO For all parsers: Test mutable only results, and also count copying&moving of the result
 
 
-// TODO templatize char away?
-struct Input final {
-    std::string_view input;
+namespace details {
+    // Stand-ins for the padding and partial members of inputs that don't have them. They don't take any space,
+    // and reading them gives 0 and false.
+    struct no_padding final {
+        constexpr operator size_t() const noexcept { return 0; }
+    };
+    struct never_partial final {
+        constexpr explicit operator bool() const noexcept { return false; }
+    };
+}
+
+/**
+ * The input of a parser. View is the type of the underlying sequence, e.g. std::string_view for text (see Input),
+ * std::u8string_view, std::span<const std::byte> for binary protocols or std::span<const Token> for pre-lexed tokens.
+ * Combinators work with all of them, they take the input type from their child parsers (see parser_input_t).
+ *
+ * PADDED and PARTIAL add the padding and partial members. Inputs without them are only as large as the View,
+ * which keeps them in registers when passed between parsers, and their parsers don't check for padding or for
+ * the end of a partial input at all. Leaf parsers take the input type as template argument, e.g. integer<PartialInput>().
+ */
+template<class View, bool PADDED = false, bool PARTIAL = false>
+struct BasicInput final {
+    using view_type = View;
+    using element_type = std::remove_cv_t<typename View::value_type>;
+
+    static constexpr bool has_padding = PADDED;
+    static constexpr bool can_be_partial = PARTIAL;
+
+    View input;
+
+    // Number of bytes after the end of input that are readable and zero, see padded_input.
+    // Runtime kernels use this to process the end of the input with full SIMD blocks.
+    [[no_unique_address]] std::conditional_t<PADDED, size_t, details::no_padding> padding = {};
+
+    // True if more input can follow after the end of input, e.g. when streaming (see stream.h).
+    // Parsers whose result could change with more input return NEED_MORE instead of deciding at the end of a partial input.
+    [[no_unique_address]] std::conditional_t<PARTIAL, bool, details::never_partial> partial = {};
+
+    // Returns the rest of the input after the first num_chars characters
+    // Parsers never advance past the end, so substr() can't throw
+    constexpr BasicInput advance(size_t num_chars) const noexcept {
+        if constexpr (requires { input.substr(num_chars); }) {
+            return BasicInput{input.substr(num_chars), padding, partial};
+        } else {
+            return BasicInput{input.subspan(num_chars), padding, partial};
+        }
+    }
+
+    // Returns the first num_chars characters
+    constexpr View take(size_t num_chars) const noexcept {
+        if constexpr (requires { input.substr(0, num_chars); }) {
+            return input.substr(0, num_chars);
+        } else {
+            return input.first(num_chars);
+        }
+    }
+
+    // Returns true if the first num_chars characters reach the end of a partial input,
+    // i.e. if the parser that consumed them might have consumed more if more input was available.
+    constexpr bool reaches_partial_end(size_t num_chars) const noexcept {
+        if constexpr (PARTIAL) {
+            return partial && num_chars == input.size();
+        } else {
+            return false;
+        }
+    }
 };
 
+using Input = BasicInput<std::string_view>;
+static_assert(sizeof(Input) == sizeof(std::string_view));
+
+// Text followed by padding, see padded_input
+using PaddedInput = BasicInput<std::string_view, true>;
+
+// Text that more input can follow, see stream_parser and push_parser. It can be padded as well.
+using PartialInput = BasicInput<std::string_view, true, true>;
+
+// Input over a sequence of arbitrary elements, e.g. SpanInput<std::byte>
+template<class T> using SpanInput = BasicInput<std::span<const T>>;
+// Like PartialInput, it has a padding member too, which is 0 if nothing readable follows
+template<class T> using PartialSpanInput = BasicInput<std::span<const T>, true, true>;
+
 /*
  * SUCCESS: Parser successfully parsed the input
  * FAILURE: Parser didn't successfully parse the input, but alternative parsers can be tried (if chained as in the regex '|' operator)
  * ERROR: Parser hit a fatal error. Abort parsing and don't try alternatives.
+ * NEED_MORE: Parser hit the end of a partial input (see PartialInput) and can only decide once more input is available.
+ *            Like ERROR, this aborts parsing. The caller can retry with more input.
  */
-enum class ResultStatus : uint8_t {SUCCESS, FAILURE, ERROR};
+enum class ResultStatus : uint8_t {SUCCESS, FAILURE, ERROR, NEED_MORE};
 
-template<class T>
+/**
+ * Result type of parsers that only succeed or fail without a value, e.g. success() or parsers in recognizer mode
+ * (see recognize()). ParseResult<unit> doesn't store anything for it, seq() leaves it out of its result tuple and
+ * rep() and repsep() only count the elements (see unit_counter).
+ */
+struct unit final {
+    constexpr bool operator==(const unit&) const = default;
+};
+
+namespace details {
+    // Storage of ParseResult<unit>. It has the same interface as the std::optional used for other result types,
+    // but holds nothing, so ParseResult<unit> is only the input and the status.
+    struct unit_storage final {
+        constexpr unit_storage(std::nullopt_t) noexcept {}
+        constexpr unit_storage(std::in_place_t) noexcept {}
+        constexpr unit_storage(std::in_place_t, unit) noexcept {}
+
+        constexpr const unit& operator*() const & noexcept { return value_; }
+        constexpr unit& operator*() & noexcept { return value_; }
+        constexpr unit&& operator*() && noexcept { return std::move(value_); }
+
+    private:
+        [[no_unique_address]] unit value_;
+    };
+}
+
+template<class T, class InputT = Input>
 class ParseResult final {
 public:
     using result_type = T;
+    using input_type = InputT;
 
     template<class... _T>
-    static constexpr ParseResult<T> success(Input next, _T&&... result) {
+    static constexpr ParseResult success(InputT next, _T&&... result) noexcept(std::is_nothrow_constructible_v<T, _T&&...> && details::nothrow_paranoid_asserts) {
         static_assert(std::is_constructible_v<T, std::decay_t<_T>...>, "Invalid argument type");
-        ParseResult<T> created(next, std::forward<_T>(result)...);
-        ASSERT(created.status_ == ResultStatus::SUCCESS);
+        ParseResult created(next, std::forward<_T>(result)...);
+        ASSERT_PARANOID(created.status_ == ResultStatus::SUCCESS);
         return created;
     }
 
-    static constexpr ParseResult failure(Input next) {
+    static constexpr ParseResult failure(InputT next) noexcept(details::nothrow_paranoid_asserts) {
         return ParseResult(next, ResultStatus::FAILURE);
     }
 
-    static constexpr ParseResult error(Input next) {
+    static constexpr ParseResult error(InputT next) noexcept(details::nothrow_paranoid_asserts) {
         return ParseResult(next, ResultStatus::ERROR);
     }
 
+    static constexpr ParseResult need_more(InputT next) noexcept(details::nothrow_paranoid_asserts) {
+        return ParseResult(next, ResultStatus::NEED_MORE);
+    }
+
     // Warning: This function might return an rvalue reference, pointing back to the potentially dead argument.
     // Please make sure you store the result to a value before the argument gets destructed.
     // If you're unsure, better use the safer convert_from() instead of unsafe_convert_from(),
     // which always returns a new value.
-    template<class U> static constexpr decltype(auto) unsafe_convert_from(ParseResult<U>&& source) {
+    template<class U> static constexpr decltype(auto) unsafe_convert_from(ParseResult<U, InputT>&& source) noexcept(std::is_nothrow_constructible_v<T, U&&> && details::nothrow_paranoid_asserts) {
         static_assert(std::is_convertible_v<U, T>, "Invalid argument");
 
         if constexpr(std::is_same_v<U, T>) {
@@ -56,8 +179,7 @@ public:
             // call, which we can avoid in the then-clause here by directly returning the rvalue reference from the input.
             return std::move(source);
         } else {
-            if (source.result_.has_value()) {
-                ASSERT(source.status_ == ResultStatus::SUCCESS);
+            if (source.status_ == ResultStatus::SUCCESS) {
                 return ParseResult(source.next_, std::move(*source.result_));
             } else {
                 return ParseResult(source.next_, source.status_);
@@ -65,101 +187,173 @@ public:
         }
     }
 
-    template<class U> static constexpr ParseResult convert_from(ParseResult<U>&& source) {
+    template<class U> static constexpr ParseResult convert_from(ParseResult<U, InputT>&& source) noexcept(std::is_nothrow_constructible_v<T, U&&> && details::nothrow_paranoid_asserts) {
         // source lives at least until after this function created its return value,
         // which will convert any potential rvalue into a value and makes this safe.
         return unsafe_convert_from(std::move(source));
     }
 
-    constexpr const T& result() const & {
+    constexpr const T& result() const & noexcept(details::nothrow_asserts) {
         ASSERT(status_ == ResultStatus::SUCCESS);
-        ASSERT(result_.has_value());
+        ASSERT_PARANOID(has_result_());
         return *result_;
     }
 
-    constexpr T&& result() && {
+    constexpr T&& result() && noexcept(details::nothrow_asserts) {
         ASSERT(status_ == ResultStatus::SUCCESS);
-        ASSERT(result_.has_value());
+        ASSERT_PARANOID(has_result_());
         return *std::move(result_);
     }
 
-    constexpr T& result() & {
+    constexpr T& result() & noexcept(details::nothrow_asserts) {
         ASSERT(status_ == ResultStatus::SUCCESS);
-        ASSERT(result_.has_value());
+        ASSERT_PARANOID(has_result_());
         return *result_;
     }
 
-    constexpr bool is_success() const {
+    constexpr bool is_success() const noexcept {
         return status_ == ResultStatus::SUCCESS;
     }
 
-    constexpr bool is_failure() const {
+    constexpr bool is_failure() const noexcept {
         return status_ == ResultStatus::FAILURE;
     }
 
-    constexpr bool is_error() const {
+    constexpr bool is_error() const noexcept {
         return status_ == ResultStatus::ERROR;
     }
 
-    constexpr ResultStatus status() const {
+    constexpr bool is_need_more() const noexcept {
+        return status_ == ResultStatus::NEED_MORE;
+    }
+
+    constexpr ResultStatus status() const noexcept {
         return status_;
     }
 
-    constexpr Input next() const {
+    constexpr InputT next() const noexcept {
         return next_;
     }
 
     template<class MapFunction>
-    constexpr auto map(MapFunction&& mapper) && {
+    constexpr auto map(MapFunction&& mapper) && noexcept(std::is_nothrow_invocable_v<MapFunction&&, T&&> && std::is_nothrow_move_constructible_v<std::invoke_result_t<MapFunction&&, T&&>> && details::nothrow_paranoid_asserts) {
         using result_type = decltype(std::forward<MapFunction>(mapper)(std::move(*result_)));
         switch(status_) {
-            case ResultStatus::SUCCESS: return ParseResult<result_type>::success(next_, std::forward<MapFunction>(mapper)(std::move(*result_)));
-            case ResultStatus::FAILURE: return ParseResult<result_type>::failure(next_);
-            case ResultStatus::ERROR: return ParseResult<result_type>::error(next_);
+            case ResultStatus::SUCCESS: return ParseResult<result_type, InputT>::success(next_, std::forward<MapFunction>(mapper)(std::move(*result_)));
+            case ResultStatus::FAILURE: return ParseResult<result_type, InputT>::failure(next_);
+            case ResultStatus::ERROR: return ParseResult<result_type, InputT>::error(next_);
+            case ResultStatus::NEED_MORE: return ParseResult<result_type, InputT>::need_more(next_);
         }
+        ASSERT_PARANOID(false);
+        return ParseResult<result_type, InputT>::error(next_);
     }
 
     template<class U>
-    constexpr auto mapValue(U&& newValue) {
+    constexpr auto mapValue(U&& newValue) noexcept(std::is_nothrow_constructible_v<std::decay_t<U>, U&&> && details::nothrow_paranoid_asserts) {
         using result_type = std::decay_t<U>;
         switch(status_) {
-            case ResultStatus::SUCCESS: return ParseResult<result_type>::success(next_, std::forward<U>(newValue));
-            case ResultStatus::FAILURE: return ParseResult<result_type>::failure(next_);
-            case ResultStatus::ERROR: return ParseResult<result_type>::error(next_);
+            case ResultStatus::SUCCESS: return ParseResult<result_type, InputT>::success(next_, std::forward<U>(newValue));
+            case ResultStatus::FAILURE: return ParseResult<result_type, InputT>::failure(next_);
+            case ResultStatus::ERROR: return ParseResult<result_type, InputT>::error(next_);
+            case ResultStatus::NEED_MORE: return ParseResult<result_type, InputT>::need_more(next_);
         }
+        ASSERT_PARANOID(false);
+        return ParseResult<result_type, InputT>::error(next_);
     }
 
-    constexpr void setNext(Input next) {
+    constexpr void setNext(InputT next) noexcept {
         next_ = std::move(next);
     }
 
 private:
     template<class... _T>
-    constexpr ParseResult(Input next, _T&&... result)
+    constexpr ParseResult(InputT next, _T&&... result) noexcept(std::is_nothrow_constructible_v<T, _T&&...> && details::nothrow_paranoid_asserts)
             : result_(std::in_place, std::forward<_T>(result)...), next_(std::move(next)), status_(ResultStatus::SUCCESS) {
         // note: the std::in_place above is important so that if T == optional<...> and _T == std::nullopt_t,
         //       it actually initializes result_ as an optional *with* a value of std::nullopt_t and not without a value.
-        ASSERT(status_ == ResultStatus::SUCCESS);
-        ASSERT(result_.has_value());
+        ASSERT_PARANOID(status_ == ResultStatus::SUCCESS);
+        ASSERT_PARANOID(has_result_());
     }
 
-    constexpr ParseResult(Input next, ResultStatus status)
+    constexpr ParseResult(InputT next, ResultStatus status) noexcept(details::nothrow_paranoid_asserts)
             : result_(std::nullopt), next_(std::move(next)), status_(std::move(status)) {
-        ASSERT(status_ != ResultStatus::SUCCESS);
+        ASSERT_PARANOID(status_ != ResultStatus::SUCCESS);
     }
 
-    template<class U> friend class ParseResult;
+    template<class U, class InputU> friend class ParseResult;
 
 private:
-    std::optional<T> result_;
-    Input next_;
+    constexpr bool has_result_() const noexcept {
+        if constexpr (std::is_same_v<T, unit>) {
+            return status_ == ResultStatus::SUCCESS;
+        } else {
+            return result_.has_value();
+        }
+    }
+
+    [[no_unique_address]] std::conditional_t<std::is_same_v<T, unit>, details::unit_storage, std::optional<T>> result_;
+    InputT next_;
     ResultStatus status_;
 };
 
 
+namespace details {
+    // Converts a FAILURE, ERROR or NEED_MORE result into a result of another type with the same status
+    template<class T, class U, class InputT>
+    constexpr ParseResult<T, InputT> unsuccessful(const ParseResult<U, InputT>& parsed) noexcept(details::nothrow_asserts) {
+        switch (parsed.status()) {
+            case ResultStatus::FAILURE: return ParseResult<T, InputT>::failure(parsed.next());
+            case ResultStatus::ERROR: return ParseResult<T, InputT>::error(parsed.next());
+            case ResultStatus::NEED_MORE: return ParseResult<T, InputT>::need_more(parsed.next());
+            case ResultStatus::SUCCESS: break;
+        }
+        ASSERT(false);
+        return ParseResult<T, InputT>::error(parsed.next());
+    }
+}
+
+namespace details {
+    // Input over a complete part of a larger input, e.g. a length-prefixed frame. It's never partial, even if the larger
+    // input is, because the part is already complete. It has no padding, because the rest of the larger input follows
+    // it instead of zeros.
+    template<class InputT>
+    constexpr InputT complete_subinput(typename InputT::view_type view) noexcept {
+        return InputT{view};
+    }
+}
+
+namespace details {
+    // Parsers are lambdas taking their input type as the only argument
+    template<class CallOperator> struct call_operator_input {};
+    template<class Result, class Class, class Arg, bool NOEXCEPT>
+    struct call_operator_input<Result (Class::*)(Arg) const noexcept(NOEXCEPT)> { using type = std::decay_t<Arg>; };
+    template<class Result, class Class, class Arg, bool NOEXCEPT>
+    struct call_operator_input<Result (Class::*)(Arg) noexcept(NOEXCEPT)> { using type = std::decay_t<Arg>; };
+
+    // Callables with a templated call operator (e.g. wrappers forwarding to another parser) are text parsers
+    template<class Parser, class Enable = void> struct parser_input { using type = Input; };
+    template<class Parser>
+    struct parser_input<Parser, std::void_t<decltype(&Parser::operator())>> : call_operator_input<decltype(&Parser::operator())> {};
+}
+
+// Input type a parser takes, e.g. Input for text parsers
+template<class Parser>
+using parser_input_t = typename details::parser_input<std::decay_t<Parser>>::type;
+
+namespace details {
+    // Input type of combinators with several child parsers. Without children, they parse text.
+    template<class... Parsers> struct common_parser_input { using type = Input; };
+    template<class HeadParser, class... TailParsers>
+    struct common_parser_input<HeadParser, TailParsers...> {
+        using type = parser_input_t<HeadParser>;
+        static_assert((std::is_same_v<type, parser_input_t<TailParsers>> && ...), "All child parsers must take the same input type");
+    };
+}
+template<class... Parsers> using common_parser_input_t = typename details::common_parser_input<Parsers...>::type;
+
 // TODO Test parser_result_t and is_parser
 template<class Parser>
-using parser_result_t = typename decltype(std::declval<Parser>()(std::declval<Input>()))::result_type;
+using parser_result_t = typename decltype(std::declval<Parser>()(std::declval<parser_input_t<Parser>>()))::result_type;
 
 template<class Parser, class Enable = void> struct is_parser : std::false_type {};
 template<class Parser>
@@ -168,4 +362,21 @@ struct is_parser<Parser, std::enable_if_t<!std::is_same_v<void, parser_result_t<
 template<class Parser> using is_parser_t = typename is_parser<Parser>::type;
 template<class Parser> constexpr inline bool is_parser_v = is_parser<Parser>::value;
 
+namespace details {
+    // True if running the parser can't throw
+    template<class Parser>
+    constexpr bool is_nothrow_parser_v = std::is_nothrow_invocable_v<const std::decay_t<Parser>&, parser_input_t<Parser>>;
+
+    /**
+     * Combinators declare their call operator noexcept(is_nothrow_combinator_v<ChildParsers...>), together with
+     * whatever else they call, e.g. map functions. This lets the compiler drop the unwinding code between nested
+     * parsers. Besides the child parsers, this needs their results to be nothrow movable and the ASSERT()s checking
+     * them to be off (see CTPC_ASSERT_LEVEL). Leaf parsers only need ASSERT_PARANOID() to be off, since creating a
+     * ParseResult doesn't check more than that.
+     */
+    template<class... Parsers>
+    constexpr bool is_nothrow_combinator_v = details::nothrow_asserts &&
+        (... && (is_nothrow_parser_v<Parsers> && std::is_nothrow_move_constructible_v<parser_result_t<Parsers>>));
+}
+
 }
@@ -6,10 +6,15 @@ namespace ctpc {
 
 template<class Parser>
 constexpr auto phrase(Parser&& parser) {
-    return [parser = std::forward<Parser>(parser)] (Input input) -> ParseResult<parser_result_t<Parser>> {
+    using parse_result = ParseResult<parser_result_t<Parser>, parser_input_t<Parser>>;
+    constexpr bool is_noexcept = details::is_nothrow_combinator_v<Parser> && std::is_nothrow_move_assignable_v<parse_result>;
+    return [parser = std::forward<Parser>(parser)] (parser_input_t<Parser> input) noexcept(is_noexcept) -> parse_result {
         auto result = parser(input);
         if (result.is_success() && result.next().input.size() != 0) {
-            result = ParseResult<parser_result_t<Parser>>::failure(result.next());
+            result = parse_result::failure(result.next());
+        } else if (result.is_success() && result.next().partial) {
+            // More input would make the phrase fail
+            result = parse_result::need_more(result.next());
         }
         return result;
     };
@@ -0,0 +1,588 @@
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "parsers/parse_result.h"
+#include "parsers/padded_input.h"
+#include "parsers/utils/coroutine_arena.h"
+
+namespace ctpc {
+
+/**
+ * Push parsing: Instead of handing a parser the whole input, the caller pushes bytes in as they arrive,
+ * e.g. from a socket, and the parser suspends whenever it runs out of input.
+ *
+ * push_seq() and push_rep() are coroutines. When one of their children returns NEED_MORE (see PartialInput),
+ * the coroutine suspends, and feed() resumes it exactly there, so children that already finished aren't parsed
+ * again. Only the primitive parser that hit the end of the input is retried. Children can be push parsers or
+ * regular parsers, and regular parsers can be used as a whole (e.g. seq(integer(), elem(','))) if their records
+ * are small enough that retrying them is cheap.
+ *
+ * Push parsers commit to the input their children consumed. A child that fails after consuming input makes the
+ * push parser fail, instead of backtracking.
+ *
+ * Results can contain std::string_views pointing into the input. The input is kept in chunks that never move, so
+ * these views stay valid until the input they point into is released. That only happens for input before the last
+ * commit() point. For unbounded streams, wrap the records in commit(): it hands each record to a consumer and then
+ * allows releasing it, so memory stays bounded by the chunks holding the largest record plus one chunk.
+ * Fed bytes are appended to the last chunk in place while they fit. A new chunk has room for as many bytes as the
+ * unparsed input it takes over, so a long token fed in small pieces is copied O(1) times on average, like in a
+ * std::vector.
+ * push_parser::metrics() reports the buffer high-water mark.
+ *
+ * Coroutine frames are allocated from a coroutine_arena, which a connection can reuse for all its messages.
+ */
+
+struct push_metrics final {
+    // Bytes of input held in memory, i.e. the chunks with uncommitted or unparsed input
+    size_t buffered_bytes;
+
+    // Maximum of buffered_bytes over the whole stream
+    size_t buffer_high_water;
+
+    // Bytes that were released by commit()
+    size_t committed_bytes;
+};
+
+namespace details {
+    class push_context final {
+    public:
+        explicit push_context(coroutine_arena* arena)
+        : arena_(arena), chunks_(), committed_(0), position_(0), finished_(false), pending_{nullptr, nullptr, nullptr}, metrics_{0, 0, 0} {
+            chunks_.push_back(make_chunk_(0, std::string_view(), std::span<const char>()));
+        }
+
+        push_context(const push_context&) = delete;
+        push_context& operator=(const push_context&) = delete;
+
+        coroutine_arena* arena() {
+            return arena_;
+        }
+
+        PartialInput input() const {
+            return PartialInput{window(), padded_input::PADDING, !finished_};
+        }
+
+        // Consumes the input up to next, which has to be a suffix of input()
+        void consume(PartialInput next) {
+            position_ += window().size() - next.input.size();
+        }
+
+        // Number of bytes consumed since the start of the stream
+        size_t position() const {
+            return position_;
+        }
+
+        // Allows releasing the input consumed so far. No result may point into it anymore.
+        void commit() {
+            metrics_.committed_bytes += position_ - committed_;
+            committed_ = position_;
+            release_committed_chunks_();
+        }
+
+        void append(std::span<const char> bytes) {
+            ASSERT(!finished_);
+            chunk& last = chunks_.back();
+            if (bytes.size() <= last.capacity - last.size) {
+                // Appending doesn't move anything, so results pointing into the chunk stay valid
+                std::memcpy(last.data.get() + last.size, bytes.data(), bytes.size());
+                last.size += bytes.size();
+                metrics_.buffered_bytes += bytes.size();
+            } else {
+                // The unparsed rest of the window is copied into a new chunk, followed by the new bytes. The consumed
+                // input stays where it is, because results can point into it. Results never point into unparsed
+                // input, so if nothing of the last chunk was consumed, nothing points into it and it is released.
+                chunk next = make_chunk_(position_, window(), bytes);
+                if (position_ == last.begin) {
+                    metrics_.buffered_bytes -= last.size;
+                    chunks_.pop_back();
+                }
+                metrics_.buffered_bytes += next.size;
+                chunks_.push_back(std::move(next));
+                release_committed_chunks_();
+            }
+            metrics_.buffer_high_water = std::max(metrics_.buffer_high_water, metrics_.buffered_bytes);
+        }
+
+        const push_metrics& metrics() const {
+            return metrics_;
+        }
+
+        void finish() {
+            finished_ = true;
+        }
+
+        // Called by a parser that needs more input. Once more input arrived, retry() is called, and once it returns
+        // true, the coroutine is resumed.
+        void suspend(std::coroutine_handle<> handle, void* awaitable, bool (*retry)(void*)) {
+            ASSERT(pending_.handle == nullptr);
+            pending_ = pending_parser{handle, awaitable, retry};
+        }
+
+        void resume_pending() {
+            if (pending_.handle != nullptr && pending_.retry(pending_.awaitable)) {
+                const std::coroutine_handle<> handle = pending_.handle;
+                pending_ = pending_parser{nullptr, nullptr, nullptr};
+                handle.resume();
+            }
+        }
+
+    private:
+        // Input from the stream position begin on. Like in stream_parser, it is padded for the runtime kernels.
+        // The padding follows the capacity, so appending in place doesn't overwrite it.
+        struct chunk final {
+            size_t begin;
+            size_t size;
+            size_t capacity;
+            std::unique_ptr<char[]> data;
+        };
+
+        static chunk make_chunk_(size_t begin, std::string_view rest, std::span<const char> bytes) {
+            const size_t size = rest.size() + bytes.size();
+            // Room for as many bytes as the unparsed rest has. That makes the chunks of a long token grow
+            // geometrically, while chunks of short records stay as large as the bytes fed.
+            const size_t capacity = size + rest.size();
+            // make_unique zero-initializes the array, which includes the padding
+            chunk result{begin, size, capacity, std::make_unique<char[]>(capacity + padded_input::PADDING)};
+            std::memcpy(result.data.get(), rest.data(), rest.size());
+            std::memcpy(result.data.get() + rest.size(), bytes.data(), bytes.size());
+            return result;
+        }
+
+        std::string_view window() const {
+            const chunk& last = chunks_.back();
+            return std::string_view(last.data.get() + (position_ - last.begin), last.size - (position_ - last.begin));
+        }
+
+        // Everything in a chunk from where the next chunk begins on was copied into the next chunk. So once the input
+        // up to there is committed, no result points into the chunk anymore.
+        void release_committed_chunks_() {
+            while (chunks_.size() > 1 && chunks_[1].begin <= committed_) {
+                metrics_.buffered_bytes -= chunks_.front().size;
+                chunks_.pop_front();
+            }
+        }
+
+        struct pending_parser final {
+            std::coroutine_handle<> handle;
+            void* awaitable;
+            bool (*retry)(void*);
+        };
+
+        coroutine_arena* arena_;
+        // The input that wasn't released yet. Chunks never move, so std::string_views into them stay valid until
+        // they're released. Only the last chunk contains unparsed input, the window the parsers still have to parse.
+        std::deque<chunk> chunks_;
+        size_t committed_;
+        size_t position_;
+        bool finished_;
+        pending_parser pending_;
+        push_metrics metrics_;
+    };
+
+    /**
+     * Coroutine type of the push parsers. It starts when it is awaited and transfers control back to the awaiting
+     * coroutine when it finished. Push tasks never return NEED_MORE, they suspend instead.
+     */
+    template<class T>
+    class push_task final {
+    public:
+        struct promise_type final {
+            std::optional<ParseResult<T, PartialInput>> result;
+            std::coroutine_handle<> continuation;
+#if CTPC_HAS_EXCEPTIONS
+            std::exception_ptr exception;
+#endif
+
+            push_task get_return_object() {
+                return push_task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            auto final_suspend() noexcept {
+                struct final_awaiter final {
+                    bool await_ready() noexcept {
+                        return false;
+                    }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                        const std::coroutine_handle<> continuation = handle.promise().continuation;
+                        return continuation != nullptr ? continuation : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return final_awaiter{};
+            }
+
+            void return_value(ParseResult<T, PartialInput> value) {
+                result.emplace(std::move(value));
+            }
+
+            void unhandled_exception() {
+#if CTPC_HAS_EXCEPTIONS
+                exception = std::current_exception();
+#else
+                // Without exceptions, nothing can throw into the coroutine
+                std::terminate();
+#endif
+            }
+
+            // All push coroutines take the push_context as their first argument, so their frames can go to its arena
+            template<class... Args>
+            static void* operator new(size_t size, push_context& context, const Args&... /*args*/) {
+                return context.arena()->allocate(size);
+            }
+
+            static void operator delete(void* ptr, size_t size) noexcept {
+                coroutine_arena::deallocate(ptr, size);
+            }
+        };
+
+        push_task(push_task&& rhs) noexcept
+        : handle_(std::exchange(rhs.handle_, nullptr)) {}
+
+        push_task(const push_task&) = delete;
+        push_task& operator=(const push_task&) = delete;
+        push_task& operator=(push_task&&) = delete;
+
+        ~push_task() {
+            if (handle_ != nullptr) {
+                handle_.destroy();
+            }
+        }
+
+        // Runs the task until it finished or needs more input. Only for tasks that aren't awaited.
+        void start() {
+            handle_.resume();
+        }
+
+        bool done() const {
+            return handle_.done();
+        }
+
+        ParseResult<T, PartialInput> result() {
+            ASSERT(handle_.done());
+#if CTPC_HAS_EXCEPTIONS
+            if (handle_.promise().exception != nullptr) {
+                std::rethrow_exception(handle_.promise().exception);
+            }
+#endif
+            return std::move(*handle_.promise().result);
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle_.promise().continuation = awaiting;
+            return handle_;
+        }
+
+        ParseResult<T, PartialInput> await_resume() {
+            return result();
+        }
+
+    private:
+        explicit push_task(std::coroutine_handle<promise_type> handle)
+        : handle_(handle) {}
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    // Awaits a regular parser. It only suspends the coroutine if the parser needs more input, no frame is allocated.
+    template<class Parser>
+    class parser_awaitable final {
+        static_assert(std::is_same_v<PartialInput, parser_input_t<Parser>>, "push parsers need parsers for PartialInput, e.g. integer<PartialInput>()");
+    public:
+        parser_awaitable(push_context* context, const Parser* parser)
+        : context_(context), parser_(parser), result_(std::nullopt) {}
+
+        bool await_ready() {
+            return try_parse();
+        }
+
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            context_->suspend(awaiting, this, [] (void* self) {
+                return static_cast<parser_awaitable*>(self)->try_parse();
+            });
+        }
+
+        ParseResult<parser_result_t<Parser>, PartialInput> await_resume() {
+            return std::move(*result_);
+        }
+
+    private:
+        // Returns false if the parser needs more input
+        bool try_parse() {
+            result_.emplace((*parser_)(context_->input()));
+            if (result_->is_need_more()) {
+                return false;
+            }
+            if (result_->is_success()) {
+                context_->consume(result_->next());
+            }
+            return true;
+        }
+
+        push_context* context_;
+        const Parser* parser_;
+        std::optional<ParseResult<parser_result_t<Parser>, PartialInput>> result_;
+    };
+
+    template<class Parser, class Enable = void> struct is_push_parser : std::false_type {};
+    template<class Parser>
+    struct is_push_parser<Parser, std::void_t<typename Parser::push_result_type>> : std::true_type {};
+    template<class Parser> constexpr inline bool is_push_parser_v = is_push_parser<std::decay_t<Parser>>::value;
+
+    template<class Parser, class Enable = void> struct push_result { using type = parser_result_t<Parser>; };
+    template<class Parser>
+    struct push_result<Parser, std::enable_if_t<is_push_parser_v<Parser>>> { using type = typename std::decay_t<Parser>::push_result_type; };
+}
+
+// Result type of a push parser or regular parser when used as a push parser child
+template<class Parser> using push_result_t = typename details::push_result<Parser>::type;
+
+namespace details {
+    template<class Parser>
+    auto await_child(push_context& context, const Parser& parser) {
+        if constexpr (is_push_parser_v<Parser>) {
+            return parser.run(context);
+        } else {
+            return parser_awaitable<Parser>(&context, &parser);
+        }
+    }
+
+    template<class T, class U>
+    ParseResult<T, PartialInput> forward_unsuccessful(const ParseResult<U, PartialInput>& source) {
+        ASSERT(!source.is_success() && !source.is_need_more());
+        if (source.is_failure()) {
+            return ParseResult<T, PartialInput>::failure(source.next());
+        }
+        return ParseResult<T, PartialInput>::error(source.next());
+    }
+
+    // Awaits the parsers from index I on and stores their results. Each index gets its own frame,
+    // but they're allocated from the arena, and it saves the seq from re-running the earlier parsers.
+    template<size_t I, class Parsers, class Results>
+    push_task<unit> run_push_seq_from(push_context& context, const Parsers& parsers, Results* results) {
+        auto parsed = co_await await_child(context, std::get<I>(parsers));
+        if (!parsed.is_success()) {
+            co_return forward_unsuccessful<unit>(parsed);
+        }
+        std::get<I>(*results).emplace(std::move(parsed).result());
+        if constexpr (I + 1 == std::tuple_size_v<Parsers>) {
+            co_return ParseResult<unit, PartialInput>::success(context.input());
+        } else {
+            co_return co_await run_push_seq_from<I + 1>(context, parsers, results);
+        }
+    }
+
+    template<class... Parsers>
+    push_task<std::tuple<push_result_t<Parsers>...>> run_push_seq(push_context& context, const std::tuple<Parsers...>& parsers) {
+        using result_type = std::tuple<push_result_t<Parsers>...>;
+        std::tuple<std::optional<push_result_t<Parsers>>...> results;
+        auto parsed = co_await run_push_seq_from<0>(context, parsers, &results);
+        if (!parsed.is_success()) {
+            co_return forward_unsuccessful<result_type>(parsed);
+        }
+        co_return std::apply([&] (auto&&... results) {
+            return ParseResult<result_type, PartialInput>::success(context.input(), std::move(*results)...);
+        }, std::move(results));
+    }
+
+    // push_rep() collects the elements into a std::vector, but elements without a value (e.g. commit()) are only
+    // counted, so a repetition over an unbounded stream doesn't grow.
+    template<class Element>
+    struct push_rep_accumulator final {
+        using type = std::vector<Element>;
+        static void add(type* accumulator, Element&& element) {
+            accumulator->push_back(std::move(element));
+        }
+    };
+    template<>
+    struct push_rep_accumulator<unit> final {
+        using type = size_t;
+        static void add(type* accumulator, unit /*element*/) {
+            ++*accumulator;
+        }
+    };
+    template<class Parser> using push_rep_result_t = typename push_rep_accumulator<push_result_t<Parser>>::type;
+
+    template<class Parser>
+    push_task<push_rep_result_t<Parser>> run_push_rep(push_context& context, const Parser& parser) {
+        using result_type = push_rep_result_t<Parser>;
+        result_type result{};
+        while (true) {
+            const size_t position = context.position();
+            auto parsed = co_await await_child(context, parser);
+            if (parsed.is_success()) {
+                push_rep_accumulator<push_result_t<Parser>>::add(&result, std::move(parsed).result());
+            } else if (parsed.is_failure() && context.position() == position) {
+                // The next element didn't start, the repetition ends here
+                break;
+            } else {
+                co_return forward_unsuccessful<result_type>(parsed);
+            }
+        }
+        co_return ParseResult<result_type, PartialInput>::success(context.input(), std::move(result));
+    }
+
+    template<class Parser, class Consumer>
+    push_task<unit> run_commit(push_context& context, const Parser& parser, const Consumer& consumer) {
+        auto parsed = co_await await_child(context, parser);
+        if (!parsed.is_success()) {
+            co_return forward_unsuccessful<unit>(parsed);
+        }
+        consumer(std::move(parsed).result());
+        context.commit();
+        co_return ParseResult<unit, PartialInput>::success(context.input());
+    }
+
+    template<class Result, class Parser>
+    push_task<Result> run_push_parser(push_context& context, Parser parser) {
+        co_return co_await await_child(context, parser);
+    }
+
+    template<class... Parsers>
+    struct push_seq_parser final {
+        using push_result_type = std::tuple<push_result_t<Parsers>...>;
+
+        std::tuple<Parsers...> parsers;
+
+        push_task<push_result_type> run(push_context& context) const {
+            return run_push_seq(context, parsers);
+        }
+    };
+
+    template<class Parser>
+    struct push_rep_parser final {
+        using push_result_type = push_rep_result_t<Parser>;
+
+        Parser parser;
+
+        push_task<push_result_type> run(push_context& context) const {
+            return run_push_rep(context, parser);
+        }
+    };
+
+    template<class Parser, class Consumer>
+    struct commit_parser final {
+        using push_result_type = unit;
+
+        Parser parser;
+        Consumer consumer;
+
+        push_task<push_result_type> run(push_context& context) const {
+            return run_commit(context, parser, consumer);
+        }
+    };
+}
+
+// Like seq(), but suspends when a child needs more input instead of returning NEED_MORE
+template<class... Parsers>
+constexpr auto push_seq(Parsers&&... parsers) {
+    static_assert(sizeof...(Parsers) > 0, "push_seq needs at least one parser");
+    return details::push_seq_parser<std::decay_t<Parsers>...>{std::make_tuple(std::forward<Parsers>(parsers)...)};
+}
+
+// Like rep(runtime_optimization, parser), but suspends when the element needs more input instead of returning NEED_MORE.
+// If the element has no result (e.g. commit()), the result is the number of elements instead of a std::vector.
+template<class Parser>
+constexpr auto push_rep(Parser&& parser) {
+    return details::push_rep_parser<std::decay_t<Parser>>{std::forward<Parser>(parser)};
+}
+
+/**
+ * Commit point: Runs the parser, passes its result to the consumer and then allows the push_parser to release
+ * all input up to here. The consumer has to extract or copy everything it needs from the result, since
+ * std::string_views in it become invalid once the consumer returned.
+ *
+ * Example: push_rep(commit(log_line(), [&] (auto&& line) { handle(line); }))
+ */
+template<class Parser, class Consumer>
+constexpr auto commit(Parser&& parser, Consumer&& consumer) {
+    return details::commit_parser<std::decay_t<Parser>, std::decay_t<Consumer>>{std::forward<Parser>(parser), std::forward<Consumer>(consumer)};
+}
+
+/**
+ * Runs a push parser (or a regular parser) on input pushed in with feed().
+ * The parser has to match the whole stream, finish() returns its result.
+ *
+ * Example:
+ *   coroutine_arena arena;  // one per connection
+ *   push_parser parser(&arena, push_rep(push_seq(integer<PartialInput>(), elem<PartialInput>('\n'))));
+ *   while (receive(&bytes)) {
+ *       parser.feed(bytes);
+ *   }
+ *   auto parsed = parser.finish();
+ */
+template<class Result>
+class push_parser final {
+public:
+    template<class Parser>
+    push_parser(coroutine_arena* arena, Parser parser)
+    : context_(arena), task_(details::run_push_parser<Result>(context_, std::move(parser))), trailing_input_(false) {
+        task_.start();
+    }
+
+    push_parser(const push_parser&) = delete;
+    push_parser& operator=(const push_parser&) = delete;
+
+    // Pushes more input and runs the parser until it needs more input or finished.
+    // Once the parser is done, the input isn't buffered anymore. It can only make finish() fail as trailing input.
+    void feed(std::span<const char> bytes) {
+        if (task_.done()) {
+            trailing_input_ = trailing_input_ || !bytes.empty();
+            return;
+        }
+        context_.append(bytes);
+        context_.resume_pending();
+    }
+
+    // Marks the end of the input and returns the result
+    ParseResult<Result, PartialInput> finish() {
+        context_.finish();
+        context_.resume_pending();
+        ASSERT(task_.done());
+        ParseResult<Result, PartialInput> result = task_.result();
+        if (result.is_success() && (trailing_input_ || !context_.input().input.empty())) {
+            // Like phrase(), the parser has to match the whole input
+            return ParseResult<Result, PartialInput>::failure(context_.input());
+        }
+        return result;
+    }
+
+    // True if the parser finished before the end of the input, e.g. because it failed.
+    // Further input won't change the result anymore.
+    bool done() const {
+        return task_.done();
+    }
+
+    const push_metrics& metrics() const {
+        return context_.metrics();
+    }
+
+private:
+    details::push_context context_;
+    details::push_task<Result> task_;
+    // True if input was fed after the parser was done
+    bool trailing_input_;
+};
+
+template<class Parser>
+push_parser(coroutine_arena*, Parser) -> push_parser<push_result_t<Parser>>;
+
+}
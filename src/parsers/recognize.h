@@ -0,0 +1,135 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include "parsers/parse_result.h"
+
+// The dual_mode_parser wrapper adds a call layer to every combinator, which makes GCC stop inlining child parsers
+// into hot loops like the one in repsep_(). Loops use this to inline everything they call.
+#if defined(__GNUC__)
+#define CTPC_FLATTEN __attribute__((flatten))
+#else
+#define CTPC_FLATTEN
+#endif
+
+namespace ctpc {
+
+namespace details {
+    /**
+     * Combinators run in one of two modes. In parse mode, they build their result as usual. In recognizer mode, they
+     * only track status and position. They don't build results of their child parsers, don't run map functions and
+     * don't fill containers, and their result is always unit.
+     *
+     * Combinators implement both modes in one lambda taking the mode as second argument, and dual_mode_parser turns
+     * that into a parser with an additional recognize() member. The lambda needs an explicit return type.
+     * Child parsers are called with run_in_mode() or run_recognizer(), so recognizer mode propagates down to the
+     * leaf parsers.
+     */
+    struct parse_mode final {
+        static constexpr bool recognize = false;
+    };
+    struct recognize_mode final {
+        static constexpr bool recognize = true;
+    };
+
+    template<class InputT> using recognized = ParseResult<unit, InputT>;
+
+    // Result type of a combinator with the given result type T in the given mode
+    template<class Mode, class T, class InputT>
+    using mode_result_t = ParseResult<std::conditional_t<Mode::recognize, unit, T>, InputT>;
+
+    template<class ParseFunction> struct dual_mode_signature {};
+    template<class Result, class Class, class Arg, bool NOEXCEPT>
+    struct dual_mode_signature<Result (Class::*)(Arg, parse_mode) const noexcept(NOEXCEPT)> {
+        using input_type = std::decay_t<Arg>;
+        using result_type = Result;
+    };
+
+    // This is an aggregate, so that dual_mode_parser{[...] (input_type input, auto mode) {...}} constructs the
+    // lambda in place and doesn't move the child parsers it captured once more.
+    template<class Impl>
+    struct dual_mode_parser final {
+        using signature = dual_mode_signature<decltype(&Impl::template operator()<parse_mode>)>;
+        using input_type = typename signature::input_type;
+
+        Impl impl;
+
+        constexpr typename signature::result_type operator()(input_type input) const noexcept(noexcept(impl(input, parse_mode{}))) {
+            return impl(input, parse_mode{});
+        }
+
+        constexpr recognized<input_type> recognize(input_type input) const noexcept(noexcept(impl(input, recognize_mode{}))) {
+            return impl(input, recognize_mode{});
+        }
+    };
+    template<class Impl> dual_mode_parser(Impl) -> dual_mode_parser<Impl>;
+
+    // True if running the parser in recognizer mode can't throw. This can hold even if parsing can throw,
+    // e.g. for a rep() that allocates its container.
+    template<class Parser>
+    constexpr bool is_nothrow_recognizer_v = details::nothrow_asserts && [] {
+        using parser_type = std::decay_t<Parser>;
+        if constexpr (requires (const parser_type& parser, parser_input_t<Parser> input) { parser.recognize(input); }) {
+            return noexcept(std::declval<const parser_type&>().recognize(std::declval<parser_input_t<Parser>>()));
+        } else {
+            return is_nothrow_parser_v<Parser>;
+        }
+    }();
+
+    // Runs the parser in recognizer mode. Parsers without a recognizer mode run as usual and their result is dropped.
+    // These are leaf parsers like elem() or identifier(), which get their result for free when finding its end.
+    template<class Parser>
+    constexpr recognized<parser_input_t<Parser>> run_recognizer(const Parser& parser, parser_input_t<Parser> input) noexcept(is_nothrow_recognizer_v<Parser>) {
+        if constexpr (requires { parser.recognize(input); }) {
+            return parser.recognize(input);
+        } else if constexpr (std::is_same_v<unit, parser_result_t<Parser>>) {
+            return parser(input);
+        } else {
+            const auto parsed = parser(input);
+            if (parsed.is_success()) {
+                return recognized<parser_input_t<Parser>>::success(parsed.next());
+            }
+            return unsuccessful<unit>(parsed);
+        }
+    }
+
+    template<class Mode, class Parser>
+    constexpr auto run_in_mode(const Parser& parser, parser_input_t<Parser> input, Mode) {
+        if constexpr (Mode::recognize) {
+            return run_recognizer(parser, input);
+        } else {
+            return parser(input);
+        }
+    }
+
+    // Runs the parser on a complete_subinput(). The parser can't need more input than that, so it never returns NEED_MORE.
+    template<class Mode, class Parser>
+    constexpr auto run_on_complete_subinput(const Parser& parser, typename parser_input_t<Parser>::view_type view, Mode mode) {
+        auto parsed = run_in_mode(parser, complete_subinput<parser_input_t<Parser>>(view), mode);
+        ASSERT(!parsed.is_need_more());
+        return parsed;
+    }
+
+    // Combinators running their child parsers with run_in_mode() can't throw in the given mode if their children can't
+    template<class Mode, class... Parsers>
+    constexpr bool is_nothrow_in_mode_v = Mode::recognize
+        ? (details::nothrow_asserts && ... && is_nothrow_recognizer_v<Parsers>)
+        : is_nothrow_combinator_v<Parsers...>;
+}
+
+/**
+ * Runs the parser only to check whether the input matches, without building its result, and returns unit.
+ * This skips all work for building the result, e.g. map functions and filling containers of rep() and repsep().
+ * See match() for getting the matched input instead.
+ */
+template<class Parser>
+constexpr auto recognize(Parser&& parser) {
+    using input_type = parser_input_t<Parser>;
+    return details::dual_mode_parser{
+        [parser = std::forward<Parser>(parser)] (input_type input, auto /*mode*/) noexcept(details::is_nothrow_recognizer_v<Parser>) -> details::recognized<input_type> {
+            return details::run_recognizer(parser, input);
+        }
+    };
+}
+
+}
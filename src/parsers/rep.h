@@ -1,81 +1,272 @@
 #pragma once
 
+#include <limits>
 #include "parsers/parse_result.h"
 #include "parsers/basic_parsers.h"
 #include "parsers/map.h"
+#include "parsers/recognize.h"
+#include "parsers/seq.h"
 #include "parsers/utils/cvector.h"
+#include "parsers/utils/small_vector.h"
 
-// TODO Test cvector-returning parsers to work with types that don't have a default constructor after cvector is fixed
+namespace ctpc {
 
+    /**
+     * Container of rep() and repsep() for parsers whose result is unit. The elements don't have a value,
+     * so it only counts them.
+     */
+    class unit_counter final {
+    public:
+        using value_type = unit;
 
-namespace ctpc {
+        constexpr unit_counter() noexcept: size_(0) {}
+
+        constexpr size_t size() const noexcept {
+            return size_;
+        }
+
+        constexpr void push_back(unit /*element*/) noexcept {
+            ++size_;
+        }
+
+        constexpr void reserve(size_t /*capacity*/) noexcept {}
+
+        constexpr bool operator==(const unit_counter&) const = default;
+
+    private:
+        size_t size_;
+    };
 
     namespace details {
+        template<class ElementParser, class Container>
+        using UnitCounterOr = std::conditional_t<std::is_same_v<unit, parser_result_t<ElementParser>>, unit_counter, Container>;
+
         template<class ElementParser, size_t MAX_SIZE>
-        using CompiletimeContainerForParser = cvector<parser_result_t<ElementParser>, MAX_SIZE>;
+        using CompiletimeContainerForParser = UnitCounterOr<ElementParser, cvector<parser_result_t<ElementParser>, MAX_SIZE>>;
         template<class ElementParser>
-        using RuntimeContainerForParser = std::vector<parser_result_t<ElementParser>>;
+        using RuntimeContainerForParser = UnitCounterOr<ElementParser, std::vector<parser_result_t<ElementParser>>>;
+        template<class ElementParser, size_t INLINE_SIZE>
+        using HybridContainerForParser = UnitCounterOr<ElementParser, small_vector<parser_result_t<ElementParser>, INLINE_SIZE>>;
+
+        template<class Container, class Element>
+        constexpr bool is_nothrow_push_back_v = std::is_nothrow_constructible_v<typename Container::value_type, Element&&> &&
+            noexcept(std::declval<Container&>().push_back(std::declval<typename Container::value_type&&>()));
+
+        // Initial accumulator of rep() and repsep() with a container
+        template<class Container>
+        constexpr bool is_nothrow_init_container_v = std::is_nothrow_default_constructible_v<Container> &&
+            noexcept(std::declval<Container&>().reserve(size_t{}));
+
+        template<class Container, class Element>
+        constexpr void push_back_converted(Container* container, Element&& element) noexcept(is_nothrow_push_back_v<Container, Element>) {
+            using value_type = typename Container::value_type;
+            if constexpr (std::is_convertible_v<Element&&, value_type>) {
+                container->push_back(std::forward<Element>(element));
+            } else {
+                // Only explicitly convertible (e.g. std::string_view -> std::string)
+                container->push_back(value_type(std::forward<Element>(element)));
+            }
+        }
+
+        // Default handleElementFn of rep() and repsep() with a container
+        template<class Container, class Element>
+        struct push_back_element final {
+            constexpr void operator()(Container* container, Element&& element) const noexcept(is_nothrow_push_back_v<Container, Element>) {
+                push_back_converted(container, std::move(element));
+            }
+        };
+
+        // With push_back_element, element parsers that can parse into an existing element (see construct<T>()) parse
+        // directly into a new element at the end of the container, instead of moving it there from their result.
+        // The new element is removed again if the parser doesn't succeed.
+        template<class HandleElementFn, class Accumulator, class ElementParser>
+        constexpr bool emplaces_elements_v = false;
+        template<class Container, class Element, class ElementParser>
+        constexpr bool emplaces_elements_v<push_back_element<Container, Element>, Container, ElementParser> =
+            std::is_same_v<typename Container::value_type, Element> && std::is_default_constructible_v<Element> &&
+            parses_into<ElementParser, Element>;
+
+        // With push_back_element, containers of a fixed capacity (i.e. cvector) are checked for space before adding
+        // an element, and running out of space is an ERROR result.
+        template<class HandleElementFn, class Accumulator>
+        constexpr bool checks_capacity_v = false;
+        template<class Container, class Element>
+        constexpr bool checks_capacity_v<push_back_element<Container, Element>, Container> =
+            requires (const Container& container) { container.full(); };
+
+        // In recognizer mode, there is no container to check. recognize_repsep() counts the elements instead and
+        // fails the same way once there are more than recognizer_capacity_v of them.
+        template<class HandleElementFn, class Accumulator>
+        constexpr size_t recognizer_capacity_v = std::numeric_limits<size_t>::max();
+        template<class HandleElementFn, class Accumulator> requires checks_capacity_v<HandleElementFn, Accumulator>
+        constexpr size_t recognizer_capacity_v<HandleElementFn, Accumulator> = Accumulator::max_size();
+
+        template<class Container, class ElementParser, class InputT>
+        constexpr recognized<InputT> emplace_element(const ElementParser& elementParser, Container* container, InputT input) {
+            auto& element = container->emplace_back();
+            const auto parsed = elementParser.parse_into(input, &element);
+            if (!parsed.is_success()) {
+                container->pop_back();
+            }
+            return parsed;
+        }
+
+        // repsep_() in recognizer mode, without any accumulator
+        template<bool NoMatchIsOk, size_t Capacity, class ElementParser, class SeparatorParser, class InputT>
+        constexpr recognized<InputT> recognize_repsep(const ElementParser& elementParser, const SeparatorParser& separatorParser, InputT input)
+                noexcept(is_nothrow_in_mode_v<recognize_mode, ElementParser, SeparatorParser>) {
+            auto element = run_recognizer(elementParser, input);
+            if (element.is_failure()) {
+                if constexpr (NoMatchIsOk) {
+                    return recognized<InputT>::success(input);
+                } else {
+                    return recognized<InputT>::failure(input);
+                }
+            }
+            if (!element.is_success()) {
+                return element;
+            }
+            InputT next = element.next();
+            [[maybe_unused]] size_t num_elements = 1;
+            while (true) {
+                const auto separator = run_recognizer(separatorParser, next);
+                if (separator.is_failure()) {
+                    break;
+                }
+                if (!separator.is_success()) {
+                    return separator;
+                }
+                element = run_recognizer(elementParser, separator.next());
+                if (element.is_failure()) {
+                    break;
+                }
+                if (!element.is_success()) {
+                    return element;
+                }
+                if constexpr (Capacity != std::numeric_limits<size_t>::max()) {
+                    // Same as repsep_() in parse mode, an element that doesn't fit is an error
+                    if (num_elements == Capacity) {
+                        return recognized<InputT>::error(separator.next());
+                    }
+                    ++num_elements;
+                }
+                next = element.next();
+            }
+            return recognized<InputT>::success(next);
+        }
+
+        // In parse mode, repsep_() also needs the accumulator functions to be noexcept. Parsing into emplaced elements
+        // isn't, because emplacing can allocate.
+        template<class Mode, class Accumulator, class ElementParser, class SeparatorParser, class InitAccumulatorFn, class HandleElementFn>
+        constexpr bool is_nothrow_repsep_v = is_nothrow_in_mode_v<Mode, ElementParser, SeparatorParser> && (Mode::recognize || (
+            std::is_nothrow_invocable_v<const InitAccumulatorFn&> &&
+            std::is_nothrow_invocable_v<const HandleElementFn&, Accumulator*, parser_result_t<ElementParser>&&> &&
+            std::is_nothrow_move_constructible_v<Accumulator> && std::is_nothrow_move_assignable_v<Accumulator> &&
+            !emplaces_elements_v<HandleElementFn, Accumulator, ElementParser>));
 
         template<bool NoMatchIsOk, class InitAccumulatorFn, class ElementParser, class SeparatorParser, class HandleElementFn, class Enable = std::enable_if_t<is_parser_v<ElementParser> && is_parser_v<SeparatorParser>>>
         constexpr auto repsep_(ElementParser&& elementParser, SeparatorParser&& separatorParser, InitAccumulatorFn&& initAccumulatorFn, HandleElementFn&& handleElementFn) {
-            return [elementParser = std::forward<ElementParser>(elementParser),
+            using InputT = common_parser_input_t<ElementParser, SeparatorParser>;
+            using Accumulator = std::decay_t<decltype(initAccumulatorFn())>;
+            return dual_mode_parser{[elementParser = std::forward<ElementParser>(elementParser),
                     separatorParser = std::forward<SeparatorParser>(separatorParser),
                     initAccumulatorFn = std::forward<InitAccumulatorFn>(initAccumulatorFn),
-                    handleElementFn = std::forward<HandleElementFn>(handleElementFn)] (Input input) {
-                using Accumulator = std::decay_t<decltype(initAccumulatorFn())>;
-
-                auto initResult = elementParser(input);
-                if (initResult.is_failure()) {
-                    if constexpr (NoMatchIsOk) {
-                        // A failure when parsing the first element means we didn't parse any elements.
-                        // It's still a success result, just with zero elements.
-                        return ParseResult<Accumulator>::success(input);
-                    } else {
-                        return ParseResult<Accumulator>::failure(input);
+                    handleElementFn = std::forward<HandleElementFn>(handleElementFn)] (InputT input, auto mode)
+                    noexcept(is_nothrow_repsep_v<decltype(mode), Accumulator, std::decay_t<ElementParser>, std::decay_t<SeparatorParser>, std::decay_t<InitAccumulatorFn>, std::decay_t<HandleElementFn>>)
+                    CTPC_FLATTEN -> mode_result_t<decltype(mode), Accumulator, InputT> {
+                if constexpr (decltype(mode)::recognize) {
+                    return recognize_repsep<NoMatchIsOk, recognizer_capacity_v<std::decay_t<HandleElementFn>, Accumulator>>(elementParser, separatorParser, input);
+                } else {
+                    auto initResult = elementParser(input);
+                    if (initResult.is_failure()) {
+                        if constexpr (NoMatchIsOk) {
+                            // A failure when parsing the first element means we didn't parse any elements.
+                            // It's still a success result, just with zero elements.
+                            return ParseResult<Accumulator, InputT>::success(input);
+                        } else {
+                            return ParseResult<Accumulator, InputT>::failure(input);
+                        }
                     }
-                }
-                if (initResult.is_error()) {
-                    return ParseResult<Accumulator>::error(initResult.next());
-                }
-                ASSERT(initResult.is_success());
-                Input next = initResult.next();
-
-                ParseResult<Accumulator> result = ParseResult<Accumulator>::success(next, initAccumulatorFn());
-                handleElementFn(&result.result(), std::move(initResult).result());
-
-                while(true) {
-                    auto separatorResult = separatorParser(result.next());
-                    if (separatorResult.is_failure()) {
-                        break;
+                    if (initResult.is_error()) {
+                        return ParseResult<Accumulator, InputT>::error(initResult.next());
                     }
-                    if (separatorResult.is_error()) {
-                        result = ParseResult<Accumulator>::error(separatorResult.next());
-                        break;
+                    if (initResult.is_need_more()) {
+                        return ParseResult<Accumulator, InputT>::need_more(initResult.next());
                     }
-                    ASSERT(separatorResult.is_success());
+                    ASSERT_PARANOID(initResult.is_success());
+                    InputT next = initResult.next();
 
-                    auto elementResult = elementParser(separatorResult.next());
+                    ParseResult<Accumulator, InputT> result = ParseResult<Accumulator, InputT>::success(next, initAccumulatorFn());
+                    handleElementFn(&result.result(), std::move(initResult).result());
 
-                    if (elementResult.is_failure()) {
-                        break;
-                    }
-                    if (elementResult.is_error()) {
-                        result = ParseResult<Accumulator>::error(elementResult.next());
-                        break;
+                    while(true) {
+                        auto separatorResult = separatorParser(result.next());
+                        if (separatorResult.is_failure()) {
+                            break;
+                        }
+                        if (separatorResult.is_error()) {
+                            result = ParseResult<Accumulator, InputT>::error(separatorResult.next());
+                            break;
+                        }
+                        if (separatorResult.is_need_more()) {
+                            result = ParseResult<Accumulator, InputT>::need_more(separatorResult.next());
+                            break;
+                        }
+                        ASSERT_PARANOID(separatorResult.is_success());
+
+                        constexpr bool emplace = emplaces_elements_v<std::decay_t<HandleElementFn>, Accumulator, std::decay_t<ElementParser>>;
+                        // A full container is only an error if there actually is another element
+                        const bool full = [&] {
+                            if constexpr (checks_capacity_v<std::decay_t<HandleElementFn>, Accumulator>) {
+                                return result.result().full();
+                            } else {
+                                return false;
+                            }
+                        }();
+                        auto elementResult = [&] {
+                            if constexpr (emplace) {
+                                if (full) {
+                                    return run_recognizer(elementParser, separatorResult.next());
+                                }
+                                return emplace_element(elementParser, &result.result(), separatorResult.next());
+                            } else {
+                                return elementParser(separatorResult.next());
+                            }
+                        }();
+
+                        if (elementResult.is_failure()) {
+                            break;
+                        }
+                        if (elementResult.is_error()) {
+                            result = ParseResult<Accumulator, InputT>::error(elementResult.next());
+                            break;
+                        }
+                        if (elementResult.is_need_more()) {
+                            result = ParseResult<Accumulator, InputT>::need_more(elementResult.next());
+                            break;
+                        }
+                        ASSERT_PARANOID(elementResult.is_success());
+                        if (full) {
+                            result = ParseResult<Accumulator, InputT>::error(separatorResult.next());
+                            break;
+                        }
+                        result.setNext(elementResult.next());
+                        if constexpr (!emplace) {
+                            handleElementFn(&result.result(), std::move(elementResult).result());
+                        }
                     }
-                    ASSERT(elementResult.is_success());
-                    result.setNext(elementResult.next());
-                    handleElementFn(&result.result(), std::move(elementResult).result());
-                }
 
-                return result;
-            };
+                    return result;
+                }
+            }};
         }
 
     }
 
     constexpr class _compiletime_optimization final {} compiletime_optimization;
     constexpr class _runtime_optimization final {} runtime_optimization;
+    // hybrid_optimization stores up to INLINE_SIZE elements without allocating and only goes to the heap for larger results.
+    constexpr class _hybrid_optimization final {} hybrid_optimization;
 
     template<class InitAccumulatorFn, class ElementParser, class SeparatorParser, class HandleElementFn, class Enable = std::enable_if_t<is_parser_v<ElementParser> && is_parser_v<SeparatorParser>>>
     constexpr auto repsep(ElementParser&& elementParser, SeparatorParser&& separatorParser, InitAccumulatorFn&& initAccumulatorFn, HandleElementFn&& handleElementFn) {
@@ -92,10 +283,8 @@ namespace ctpc {
         return repsep(
             std::forward<ElementParser>(elementParser),
             std::forward<SeparatorParser>(separatorParser),
-            [reserveCapacity] () { Container result; result.reserve(reserveCapacity); return result; },
-            [] (Container* accumulator, parser_result_t<ElementParser>&& element) {
-                accumulator->push_back(static_cast<typename Container::value_type &&>(std::move(element)));
-            }
+            [reserveCapacity] () noexcept(details::is_nothrow_init_container_v<Container>) { Container result; result.reserve(reserveCapacity); return result; },
+            details::push_back_element<Container, parser_result_t<ElementParser>>()
         );
     }
 
@@ -117,6 +306,15 @@ namespace ctpc {
         );
     }
 
+    template<size_t INLINE_SIZE = 8, class ElementParser, class SeparatorParser, class Enable = std::enable_if_t<is_parser_v<ElementParser> && is_parser_v<SeparatorParser>>>
+    constexpr auto repsep(_hybrid_optimization, ElementParser&& elementParser, SeparatorParser&& separatorParser, size_t reserveCapacity = 0) {
+        return repsep<details::HybridContainerForParser<ElementParser, INLINE_SIZE>, ElementParser, SeparatorParser>(
+            std::forward<ElementParser>(elementParser),
+            std::forward<SeparatorParser>(separatorParser),
+            reserveCapacity
+        );
+    }
+
     template<class InitAccumulatorFn, class ElementParser, class SeparatorParser, class HandleElementFn, class Enable = std::enable_if_t<is_parser_v<ElementParser> && is_parser_v<SeparatorParser>>>
     constexpr auto repsep1(ElementParser&& elementParser, SeparatorParser&& separatorParser, InitAccumulatorFn&& initAccumulatorFn, HandleElementFn&& handleElementFn) {
         return details::repsep_<false>(
@@ -132,10 +330,8 @@ namespace ctpc {
         return repsep1(
             std::forward<ElementParser>(elementParser),
             std::forward<SeparatorParser>(separatorParser),
-            [reserveCapacity] () {Container result; result.reserve(reserveCapacity); return result; },
-            [] (Container* accumulator, parser_result_t<ElementParser>&& element) {
-                accumulator->push_back(static_cast<typename Container::value_type &&>(std::move(element)));
-            }
+            [reserveCapacity] () noexcept(details::is_nothrow_init_container_v<Container>) {Container result; result.reserve(reserveCapacity); return result; },
+            details::push_back_element<Container, parser_result_t<ElementParser>>()
         );
     }
 
@@ -157,11 +353,20 @@ namespace ctpc {
         );
     }
 
+    template<size_t INLINE_SIZE = 8, class ElementParser, class SeparatorParser, class Enable = std::enable_if_t<is_parser_v<ElementParser> && is_parser_v<SeparatorParser>>>
+    constexpr auto repsep1(_hybrid_optimization, ElementParser&& elementParser, SeparatorParser&& separatorParser, size_t reserveCapacity = 1) {
+        return repsep1<details::HybridContainerForParser<ElementParser, INLINE_SIZE>, ElementParser, SeparatorParser>(
+            std::forward<ElementParser>(elementParser),
+            std::forward<SeparatorParser>(separatorParser),
+            reserveCapacity
+        );
+    }
+
     template<class InitAccumulatorFn, class ElementParser, class HandleElementFn, class Enable = std::enable_if_t<is_parser_v<ElementParser>>>
     constexpr auto rep(ElementParser&& elementParser, InitAccumulatorFn&& initAccumulatorFn, HandleElementFn&& handleElementFn) {
         return repsep(
             std::forward<ElementParser>(elementParser),
-            success(),
+            success<parser_input_t<ElementParser>>(),
             std::forward<InitAccumulatorFn>(initAccumulatorFn),
             std::forward<HandleElementFn>(handleElementFn)
         );
@@ -171,7 +376,7 @@ namespace ctpc {
     constexpr auto rep(Parser&& parser, size_t reserveCapacity = 0) {
         return repsep<Container>(
             std::forward<Parser>(parser),
-            success(),
+            success<parser_input_t<Parser>>(),
             reserveCapacity
         );
     }
@@ -192,11 +397,19 @@ namespace ctpc {
         );
     }
 
+    template<size_t INLINE_SIZE = 8, class Parser, class Enable = std::enable_if_t<is_parser_v<Parser>>>
+    constexpr auto rep(_hybrid_optimization, Parser&& parser, size_t reserveCapacity = 0) {
+        return rep<details::HybridContainerForParser<Parser, INLINE_SIZE>>(
+            std::forward<Parser>(parser),
+            reserveCapacity
+        );
+    }
+
     template<class InitAccumulatorFn, class ElementParser, class HandleElementFn, class Enable = std::enable_if_t<is_parser_v<ElementParser>>>
     constexpr auto rep1(ElementParser&& elementParser, InitAccumulatorFn&& initAccumulatorFn, HandleElementFn&& handleElementFn) {
         return repsep1(
             std::forward<ElementParser>(elementParser),
-            success(),
+            success<parser_input_t<ElementParser>>(),
             std::forward<InitAccumulatorFn>(initAccumulatorFn),
             std::forward<HandleElementFn>(handleElementFn)
         );
@@ -206,7 +419,7 @@ namespace ctpc {
     constexpr auto rep1(Parser&& parser, size_t reserveCapacity = 1) {
         return repsep1<Container>(
             std::forward<Parser>(parser),
-            success(),
+            success<parser_input_t<Parser>>(),
             reserveCapacity
         );
     }
@@ -227,4 +440,12 @@ namespace ctpc {
         );
     }
 
+    template<size_t INLINE_SIZE = 8, class Parser, class Enable = std::enable_if_t<is_parser_v<Parser>>>
+    constexpr auto rep1(_hybrid_optimization, Parser&& parser, size_t reserveCapacity = 1) {
+        return rep1<details::HybridContainerForParser<Parser, INLINE_SIZE>>(
+            std::forward<Parser>(parser),
+            reserveCapacity
+        );
+    }
+
 }
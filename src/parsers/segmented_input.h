@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parsers/parse_result.h"
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
+namespace ctpc {
+
+/**
+ * segmented_input parses records from a chain of non-contiguous buffers, e.g. the iovecs a readv() filled,
+ * without copying them into one contiguous string first.
+ *
+ * Each segment is parsed in place as a partial input (see PartialInput), so records that lie entirely inside
+ * one segment are parsed zero-copy and their std::string_views point into the segment. Only a record that reaches
+ * the end of its segment and returns NEED_MORE is assembled into a scratch buffer, together with as much of the
+ * following segments as it needs, and parsed again there. Its std::string_views point into the scratch buffer.
+ *
+ * The segments aren't owned and have to outlive the segmented_input. Results stay valid as long as both live.
+ */
+class segmented_input final {
+public:
+    explicit segmented_input(std::span<const std::string_view> segments)
+    : segments_(segments.begin(), segments.end()), segment_(0), offset_(0), scratch_(), scratch_size_(0) {
+        if (segments_.empty()) {
+            segments_.emplace_back();
+        }
+    }
+
+    // Only on POSIX systems, which have readv() and iovec
+#if !defined(_WIN32)
+    explicit segmented_input(std::span<const iovec> segments)
+    : segments_(), segment_(0), offset_(0), scratch_(), scratch_size_(0) {
+        segments_.reserve(segments.size());
+        for (const iovec& segment : segments) {
+            segments_.emplace_back(static_cast<const char*>(segment.iov_base), segment.iov_len);
+        }
+        if (segments_.empty()) {
+            segments_.emplace_back();
+        }
+    }
+#endif
+
+    segmented_input(const segmented_input&) = delete;
+    segmented_input& operator=(const segmented_input&) = delete;
+
+    /**
+     * Parses the next record. On success, the record is consumed.
+     * On failure, nothing is consumed, and the result's next() can point into a scratch buffer.
+     */
+    template<class Parser>
+    ParseResult<parser_result_t<Parser>, PartialInput> next(const Parser& parser) {
+        static_assert(std::is_same_v<PartialInput, parser_input_t<Parser>>, "segmented_input needs a parser for PartialInput, e.g. integer<PartialInput>()");
+        skip_finished_segments();
+        const std::string_view segment = segments_[segment_].substr(offset_);
+        auto parsed = parser(PartialInput{segment, 0, segment_ + 1 < segments_.size()});
+        if (!parsed.is_need_more()) {
+            if (parsed.is_success()) {
+                offset_ += segment.size() - parsed.next().input.size();
+            }
+            return parsed;
+        }
+        return next_straddling(parser, segment);
+    }
+
+    // True if all segments are consumed
+    bool at_end() {
+        skip_finished_segments();
+        return offset_ == segments_[segment_].size();
+    }
+
+    // Number of bytes that were copied into scratch buffers for records straddling segment boundaries
+    size_t scratch_size() const {
+        return scratch_size_;
+    }
+
+private:
+    // Moves to the next segment with unconsumed input, but never past the last one
+    void skip_finished_segments() {
+        while (offset_ == segments_[segment_].size() && segment_ + 1 < segments_.size()) {
+            ++segment_;
+            offset_ = 0;
+        }
+    }
+
+    template<class Parser>
+    ParseResult<parser_result_t<Parser>, PartialInput> next_straddling(const Parser& parser, std::string_view segment_tail) {
+        // deque never moves its elements, so std::string_views into earlier scratch buffers stay valid
+        std::string& scratch = scratch_.emplace_back(segment_tail);
+        size_t segment = segment_ + 1;
+        size_t offset = 0;
+        while (true) {
+            // Append the following segments in growing steps, so long records don't need too many attempts
+            const size_t step = std::max<size_t>(scratch.size(), 64);
+            while (scratch.size() - segment_tail.size() < step && segment < segments_.size()) {
+                const std::string_view appended = segments_[segment].substr(offset, step);
+                scratch.append(appended);
+                offset += appended.size();
+                if (offset == segments_[segment].size()) {
+                    ++segment;
+                    offset = 0;
+                }
+            }
+            const bool partial = segment < segments_.size();
+            auto parsed = parser(PartialInput{scratch, 0, partial});
+            if (parsed.is_need_more()) {
+                ASSERT(partial);
+                continue;
+            }
+            scratch_size_ += scratch.size();
+            if (parsed.is_success()) {
+                advance(scratch.size() - parsed.next().input.size());
+            }
+            return parsed;
+        }
+    }
+
+    void advance(size_t num_chars) {
+        offset_ += num_chars;
+        while (segment_ + 1 < segments_.size() && offset_ > segments_[segment_].size()) {
+            offset_ -= segments_[segment_].size();
+            ++segment_;
+        }
+    }
+
+    std::vector<std::string_view> segments_;
+    size_t segment_;
+    size_t offset_;
+    std::deque<std::string> scratch_;
+    size_t scratch_size_;
+};
+
+}
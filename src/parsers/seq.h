@@ -1,12 +1,46 @@
 #pragma once
 
+#include <concepts>
+#include <tuple>
 #include "parsers/parse_result.h"
+#include "parsers/map.h"
+#include "parsers/recognize.h"
 
 namespace ctpc {
 
 namespace details {
+    // Parser returned by ignore(), see below
+    template<class Parser>
+    struct ignored_parser final {
+        using input_type = parser_input_t<Parser>;
+
+        Parser parser;
+
+        constexpr recognized<input_type> operator()(input_type input) const noexcept(is_nothrow_recognizer_v<Parser>) {
+            return run_recognizer(parser, input);
+        }
+
+        constexpr recognized<input_type> recognize(input_type input) const noexcept(is_nothrow_recognizer_v<Parser>) {
+            return run_recognizer(parser, input);
+        }
+    };
+
+    // seq() leaves the results of these parsers out of its result tuple, e.g. ignore() or success()
+    template<class Parser> constexpr bool has_unit_result_v = std::is_same_v<unit, parser_result_t<Parser>>;
+
+    // Results of the parsers, without unit results
+    template<class... Parsers>
+    using seq_result_t = decltype(std::tuple_cat(std::declval<std::conditional_t<has_unit_result_v<Parsers>, std::tuple<>, std::tuple<parser_result_t<Parsers>>>>()...));
+
+    template<class InputT, class... Results>
+    constexpr std::tuple<ParseResult<Results, InputT>...> make_seq_result_buffer([[maybe_unused]] InputT input, std::tuple<Results...>* /*results*/) {
+        // input is unused if all results are unit
+        return {ParseResult<Results, InputT>::failure(input)...};
+    }
+
+    template<class InputT>
     struct SeqResultStatus final {
-        Input next;
+        InputT next;
         ResultStatus status;
     };
 
@@ -14,58 +48,287 @@ namespace details {
 
     template<class HeadParser, class... TailParsers>
     struct apply_seq_parsers<HeadParser, TailParsers...> final {
-        template<size_t current_index, class ResultBuffer>
-        static constexpr SeqResultStatus call(Input input, ResultBuffer* result, const HeadParser& headParser, const TailParsers&... tailParsers) {
-            static_assert(std::tuple_size_v<ResultBuffer> == current_index + 1 + sizeof...(TailParsers));
-            static_assert(std::is_same_v<std::tuple_element_t<current_index, ResultBuffer>, ParseResult<parser_result_t<HeadParser>>>);
-
-            auto& current_result = std::get<current_index>(*result);
-            current_result = headParser(input);
-            if (current_result.is_success()) {
-                return apply_seq_parsers<TailParsers...>::template call<current_index + 1>(current_result.next(), result, tailParsers...);
-            }
+        // result_index is the index in the result buffer, which has no entries for unit results
+        template<size_t result_index, class ResultBuffer, class InputT>
+        static constexpr SeqResultStatus<InputT> call(InputT input, ResultBuffer* result, const HeadParser& headParser, const TailParsers&... tailParsers) {
+            if constexpr (has_unit_result_v<HeadParser>) {
+                const auto current_result = run_recognizer(headParser, input);
+                if (current_result.is_success()) {
+                    return apply_seq_parsers<TailParsers...>::template call<result_index>(current_result.next(), result, tailParsers...);
+                }
+
+                return SeqResultStatus<InputT> { current_result.next(), current_result.status() };
+            } else {
+                static_assert(std::is_same_v<std::tuple_element_t<result_index, ResultBuffer>, ParseResult<parser_result_t<HeadParser>, InputT>>);
+
+                auto& current_result = std::get<result_index>(*result);
+                current_result = headParser(input);
+                if (current_result.is_success()) {
+                    return apply_seq_parsers<TailParsers...>::template call<result_index + 1>(current_result.next(), result, tailParsers...);
+                }
 
-            return SeqResultStatus { current_result.next(), current_result.status() };
+                return SeqResultStatus<InputT> { current_result.next(), current_result.status() };
+            }
         }
     };
 
     template<>
     struct apply_seq_parsers<> final {
-        template<size_t current_index, class ResultBuffer>
-        static constexpr SeqResultStatus call(Input input, ResultBuffer* /*result*/) {
-            static_assert(std::tuple_size_v<ResultBuffer> == current_index);
+        template<size_t result_index, class ResultBuffer, class InputT>
+        static constexpr SeqResultStatus<InputT> call(InputT input, ResultBuffer* /*result*/) {
+            static_assert(std::tuple_size_v<ResultBuffer> == result_index);
+
+            return SeqResultStatus<InputT> { input, ResultStatus::SUCCESS };
+        }
+    };
+
+    template<class T, class... Results>
+    constexpr bool is_constructible_from_v = false;
+    template<class T, class... Results>
+    constexpr bool is_constructible_from_v<T, std::tuple<Results...>> = std::is_constructible_v<T, Results&&...>;
+
+    template<class T, class... Results>
+    constexpr bool is_nothrow_constructible_from_v = false;
+    template<class T, class... Results>
+    constexpr bool is_nothrow_constructible_from_v<T, std::tuple<Results...>> = std::is_nothrow_constructible_v<T, Results&&...>;
+
+    // run_seq() can't throw if the parsers can't and, in parse mode, constructing the Result can't either
+    template<class Mode, class Result, class... Parsers>
+    constexpr bool is_nothrow_seq_v = is_nothrow_in_mode_v<Mode, Parsers...> &&
+        (Mode::recognize || is_nothrow_constructible_from_v<Result, seq_result_t<Parsers...>>);
+
+    // Runs the parsers of seq() or construct() one after the other and constructs a Result from their results,
+    // leaving out unit results
+    template<class Result, class Mode, class InputT, class... Parsers>
+    constexpr mode_result_t<Mode, Result, InputT> run_seq(const std::tuple<Parsers...>& parsers, InputT input, Mode) {
+        if constexpr (Mode::recognize) {
+            // Without results, there's nothing to buffer. Just run the parsers until one doesn't succeed.
+            return std::apply([input] (const auto&... parsers) {
+                auto result = recognized<InputT>::success(input);
+                (... && (result = run_recognizer(parsers, result.next())).is_success());
+                return result;
+            }, parsers);
+        } else {
+            using results_type = seq_result_t<Parsers...>;
+            static_assert(is_constructible_from_v<Result, results_type>, "The result can't be constructed from the results of the parsers");
+            return std::apply([input] (const auto&... parsers) {
+                auto result_buffer = make_seq_result_buffer(input, static_cast<results_type*>(nullptr));
+                SeqResultStatus<InputT> status = apply_seq_parsers<Parsers...>::template call<0>(
+                        input, &result_buffer, parsers...
+                );
+
+                if (status.status == ResultStatus::SUCCESS) {
+                    return std::apply([&] (auto&&... results) {
+                        ASSERT_PARANOID((... && results.is_success()));
+                        return ParseResult<Result, InputT>::success(status.next, std::move(results).result()...);
+                    }, std::move(result_buffer));
+                }
+
+                if (status.status == ResultStatus::FAILURE) {
+                    return ParseResult<Result, InputT>::failure(status.next);
+                }
+
+                if (status.status == ResultStatus::NEED_MORE) {
+                    return ParseResult<Result, InputT>::need_more(status.next);
+                }
+
+                ASSERT_PARANOID(status.status == ResultStatus::ERROR);
+                return ParseResult<Result, InputT>::error(status.next);
+
+            }, parsers);
+        }
+    }
+
+    // Like apply_seq_parsers, but moves each result into its member of the destination instead of a result buffer
+    template<class... Parsers> struct apply_seq_parsers_into final {};
+
+    template<class HeadParser, class... TailParsers>
+    struct apply_seq_parsers_into<HeadParser, TailParsers...> final {
+        template<size_t member_index, class Members, class InputT>
+        static constexpr recognized<InputT> call(InputT input, const Members& members, const HeadParser& headParser, const TailParsers&... tailParsers) {
+            if constexpr (has_unit_result_v<HeadParser>) {
+                const auto current_result = run_recognizer(headParser, input);
+                if (!current_result.is_success()) {
+                    return current_result;
+                }
+                return apply_seq_parsers_into<TailParsers...>::template call<member_index>(current_result.next(), members, tailParsers...);
+            } else {
+                auto current_result = headParser(input);
+                if (!current_result.is_success()) {
+                    return unsuccessful<unit>(current_result);
+                }
+                std::get<member_index>(members) = std::move(current_result).result();
+                return apply_seq_parsers_into<TailParsers...>::template call<member_index + 1>(current_result.next(), members, tailParsers...);
+            }
+        }
+    };
 
-            return SeqResultStatus { input, ResultStatus::SUCCESS };
+    template<>
+    struct apply_seq_parsers_into<> final {
+        template<size_t member_index, class Members, class InputT>
+        static constexpr recognized<InputT> call(InputT input, const Members& /*members*/) {
+            static_assert(std::tuple_size_v<Members> == member_index);
+
+            return recognized<InputT>::success(input);
         }
     };
 
+    // Converts to anything, for counting the members of aggregates
+    struct any_member final {
+        template<class T> operator T() const;
+    };
+
+    // True if the members of T can be bound to the results, i.e. T is a tuple or an aggregate with one member per result
+    template<class T, class Results> constexpr bool has_members_for_v = false;
+    template<class T, class... Results>
+    constexpr bool has_members_for_v<T, std::tuple<Results...>> = sizeof...(Results) >= 1 && sizeof...(Results) <= 8 && (
+        std::is_same_v<T, std::tuple<Results...>> ||
+        (std::is_aggregate_v<T> && requires { T{std::declval<Results>()...}; } && !requires { T{std::declval<Results>()..., any_member{}}; })
+    );
+
+    // Tuple of references to the members of T, see has_members_for_v
+    template<size_t NUM_MEMBERS, class T>
+    constexpr auto tie_members(T& value) {
+        if constexpr (NUM_MEMBERS == 1) {
+            auto& [m0] = value;
+            return std::tie(m0);
+        } else if constexpr (NUM_MEMBERS == 2) {
+            auto& [m0, m1] = value;
+            return std::tie(m0, m1);
+        } else if constexpr (NUM_MEMBERS == 3) {
+            auto& [m0, m1, m2] = value;
+            return std::tie(m0, m1, m2);
+        } else if constexpr (NUM_MEMBERS == 4) {
+            auto& [m0, m1, m2, m3] = value;
+            return std::tie(m0, m1, m2, m3);
+        } else if constexpr (NUM_MEMBERS == 5) {
+            auto& [m0, m1, m2, m3, m4] = value;
+            return std::tie(m0, m1, m2, m3, m4);
+        } else if constexpr (NUM_MEMBERS == 6) {
+            auto& [m0, m1, m2, m3, m4, m5] = value;
+            return std::tie(m0, m1, m2, m3, m4, m5);
+        } else if constexpr (NUM_MEMBERS == 7) {
+            auto& [m0, m1, m2, m3, m4, m5, m6] = value;
+            return std::tie(m0, m1, m2, m3, m4, m5, m6);
+        } else {
+            static_assert(NUM_MEMBERS == 8);
+            auto& [m0, m1, m2, m3, m4, m5, m6, m7] = value;
+            return std::tie(m0, m1, m2, m3, m4, m5, m6, m7);
+        }
+    }
+
+    // Parser returned by construct(), see below
+    template<class T, class... Parsers>
+    struct construct_parser final {
+        using input_type = common_parser_input_t<Parsers...>;
+        using results_type = seq_result_t<Parsers...>;
+
+        std::tuple<Parsers...> parsers;
+
+        constexpr ParseResult<T, input_type> operator()(input_type input) const noexcept(is_nothrow_seq_v<parse_mode, T, Parsers...>) {
+            return run_seq<T>(parsers, input, parse_mode{});
+        }
+
+        constexpr recognized<input_type> recognize(input_type input) const noexcept(is_nothrow_seq_v<recognize_mode, T, Parsers...>) {
+            return run_seq<T>(parsers, input, recognize_mode{});
+        }
+
+        // Parses into an existing T, moving each result directly into its member. On failure, some members might
+        // already be overwritten.
+        constexpr recognized<input_type> parse_into(input_type input, T* destination) const requires has_members_for_v<T, results_type> {
+            const auto members = tie_members<std::tuple_size_v<results_type>>(*destination);
+            return std::apply([&] (const auto&... parsers) {
+                return apply_seq_parsers_into<Parsers...>::template call<0>(input, members, parsers...);
+            }, parsers);
+        }
+    };
+
+    // Parsers that can parse into an existing T, e.g. construct<T>()
+    template<class Parser, class T>
+    concept parses_into = requires (const Parser& parser, parser_input_t<Parser> input, T* destination) {
+        {parser.parse_into(input, destination)} -> std::same_as<recognized<parser_input_t<Parser>>>;
+    };
+
+}
+
+/**
+ * Marks a parser whose result isn't needed, e.g. punctuation or whitespace. It runs in recognizer mode
+ * (see recognize()) and returns unit, which seq() leaves out of its result tuple, so the result is never stored or moved.
+ * Used on its own, it is the same as recognize().
+ *
+ * Example:
+ *   seq(identifier(), ignore(elem(':')), identifier())  // returns std::tuple<std::string_view, std::string_view>
+ */
+template<class Parser>
+constexpr auto ignore(Parser&& parser) {
+    return details::ignored_parser<std::decay_t<Parser>>{std::forward<Parser>(parser)};
 }
 
 template<class... Parsers>
 constexpr auto seq(Parsers&&... parsers) {
-    using result_type = std::tuple<parser_result_t<Parsers>...>;
-    return [parsers = std::make_tuple(std::forward<Parsers>(parsers)...)] (Input input) -> ParseResult<result_type> {
-        return std::apply([input] (const auto&... parsers) {
-            std::tuple<ParseResult<parser_result_t<Parsers>>...> result_buffer {ParseResult<parser_result_t<Parsers>>::failure(input)...};
-            details::SeqResultStatus status = details::apply_seq_parsers<std::decay_t<Parsers>...>::template call<0>(
-                    input, &result_buffer, parsers...
-            );
-
-            if (status.status == ResultStatus::SUCCESS) {
-                return std::apply([&] (auto&&... results) {
-                    ASSERT((... && results.is_success()));
-                    return ParseResult<result_type>::success(status.next, std::move(results).result()...);
-                }, std::move(result_buffer));
-            }
+    using result_type = details::seq_result_t<std::decay_t<Parsers>...>;
+    using input_type = common_parser_input_t<Parsers...>;
+    return details::dual_mode_parser{
+        [parsers = std::make_tuple(std::forward<Parsers>(parsers)...)] (input_type input, auto mode) noexcept(details::is_nothrow_seq_v<decltype(mode), result_type, std::decay_t<Parsers>...>) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            return details::run_seq<result_type>(parsers, input, mode);
+        }
+    };
+}
 
-            if (status.status == ResultStatus::FAILURE) {
-                return ParseResult<result_type>::failure(status.next);
-            }
+/**
+ * Like seq(), but constructs a T from the results instead of returning a tuple, e.g. an aggregate with one member per
+ * result that isn't unit. The results are moved from where they were parsed into T directly, which saves the moves
+ * into and out of the tuple that map(seq(...), ...) needs.
+ *
+ * If T is a tuple or an aggregate with exactly one member per result, the parser can also parse into an existing T.
+ * rep() and repsep() use this to parse elements directly into their container, see details::push_back_element.
+ *
+ * Example:
+ *   construct<Parameter>(identifier(), ignore(elem(':')), identifier())
+ */
+template<class T, class... Parsers>
+constexpr auto construct(Parsers&&... parsers) {
+    return details::construct_parser<T, std::decay_t<Parsers>...>{{std::forward<Parsers>(parsers)...}};
+}
 
-            ASSERT (status.status == ResultStatus::ERROR);
-            return ParseResult<result_type>::error(status.next);
+// Parses both, but only returns the result of the left one. The result is returned as parsed, without moving it
+// through a tuple, so this also works for unit results.
+template<class LeftParser, class RightParser>
+constexpr auto keep_left(LeftParser&& left, RightParser&& right) {
+    using result_type = parser_result_t<LeftParser>;
+    using input_type = common_parser_input_t<LeftParser, RightParser>;
+    return details::dual_mode_parser{
+        [left = std::forward<LeftParser>(left), right = std::forward<RightParser>(right)] (input_type input, auto mode) noexcept(details::is_nothrow_in_mode_v<decltype(mode), LeftParser> && details::is_nothrow_recognizer_v<RightParser>) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, input_type>;
+            auto parsed = details::run_in_mode(left, input, mode);
+            if (!parsed.is_success()) {
+                return parsed;
+            }
+            const auto right_parsed = details::run_recognizer(right, parsed.next());
+            if (!right_parsed.is_success()) {
+                return details::unsuccessful<typename parse_result::result_type>(right_parsed);
+            }
+            parsed.setNext(right_parsed.next());
+            return parsed;
+        }
+    };
+}
 
-        }, parsers);
+// Parses both, but only returns the result of the right one. The result is returned as parsed, without moving it
+// through a tuple, so this also works for unit results.
+template<class LeftParser, class RightParser>
+constexpr auto keep_right(LeftParser&& left, RightParser&& right) {
+    using result_type = parser_result_t<RightParser>;
+    using input_type = common_parser_input_t<LeftParser, RightParser>;
+    return details::dual_mode_parser{
+        [left = std::forward<LeftParser>(left), right = std::forward<RightParser>(right)] (input_type input, auto mode) noexcept(details::is_nothrow_recognizer_v<LeftParser> && details::is_nothrow_in_mode_v<decltype(mode), RightParser>) -> details::mode_result_t<decltype(mode), result_type, input_type> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, input_type>;
+            const auto left_parsed = details::run_recognizer(left, input);
+            if (!left_parsed.is_success()) {
+                return details::unsuccessful<typename parse_result::result_type>(left_parsed);
+            }
+            return details::run_in_mode(right, left_parsed.next(), mode);
+        }
     };
 }
 
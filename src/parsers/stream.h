@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "parsers/parse_result.h"
+#include "parsers/padded_input.h"
+
+namespace ctpc {
+
+/**
+ * stream_parser applies a record parser repeatedly to a stream of input that arrives in chunks,
+ * e.g. log lines read from a socket in 64 KiB blocks.
+ *
+ * feed() appends a chunk to a window of buffered input, and next() parses the next record from that window.
+ * Until finish() is called, the window is a partial input (see PartialInput), so a record that reaches the end
+ * of the window returns NEED_MORE instead of FAILURE, and next() can be called again after the next feed().
+ * A record that returned NEED_MORE is parsed again from its beginning once more input is available.
+ *
+ * Consumed records are released from the window when the next chunk is fed, so memory is bounded by the largest
+ * record plus the chunk size, not by the size of the stream.
+ * Results can contain std::string_views pointing into the window. They stay valid until the next call to feed().
+ *
+ * Example:
+ *   stream_parser stream(seq(integer<PartialInput>(), elem<PartialInput>('\n')));
+ *   while (read_chunk(&chunk)) {
+ *       stream.feed(chunk);
+ *       for (auto record = stream.next(); record.is_success(); record = stream.next()) { ... }
+ *   }
+ *   stream.finish();
+ *   while (!stream.at_end()) { ... stream.next() ... }
+ */
+template<class Parser>
+class stream_parser final {
+public:
+    using result_type = parser_result_t<Parser>;
+    static_assert(std::is_same_v<PartialInput, parser_input_t<Parser>>, "stream_parser needs a parser for PartialInput, e.g. integer<PartialInput>()");
+
+    explicit stream_parser(Parser parser)
+    : parser_(std::move(parser)), buffer_(padded_input::PADDING, '\0'), begin_(0), finished_(false), needs_more_(false) {}
+
+    // Appends a chunk to the window. Invalidates std::string_views in previously returned results.
+    void feed(std::string_view chunk) {
+        ASSERT(!finished_);
+        release_consumed();
+        const size_t size = window().size();
+        // The window is kept padded with zeroes so that the runtime kernels can read full blocks at its end
+        buffer_.resize(size + chunk.size() + padded_input::PADDING);
+        std::memcpy(buffer_.data() + size, chunk.data(), chunk.size());
+        std::fill_n(buffer_.data() + size + chunk.size(), padded_input::PADDING, '\0');
+        needs_more_ = false;
+    }
+
+    // Marks the end of the stream. From now on, the rest of the window is parsed as a complete input.
+    void finish() {
+        finished_ = true;
+        needs_more_ = false;
+    }
+
+    /**
+     * Parses the next record from the window.
+     * SUCCESS: The record is consumed from the window.
+     * NEED_MORE: The window ends within the record. Call feed() or finish() and try again.
+     * FAILURE/ERROR: The record parser failed. Nothing is consumed.
+     */
+    ParseResult<result_type, PartialInput> next() {
+        const PartialInput input{window(), padded_input::PADDING, !finished_};
+        if (needs_more_) {
+            // Nothing changed since the last attempt, don't parse the record again
+            return ParseResult<result_type, PartialInput>::need_more(input);
+        }
+        auto parsed = parser_(input);
+        if (parsed.is_success()) {
+            begin_ += input.input.size() - parsed.next().input.size();
+        } else if (parsed.is_need_more()) {
+            needs_more_ = true;
+        }
+        return parsed;
+    }
+
+    // True if finish() was called and all input was consumed
+    bool at_end() const {
+        return finished_ && window().empty();
+    }
+
+    // Number of bytes in the window that aren't consumed yet
+    size_t buffered_size() const {
+        return window().size();
+    }
+
+private:
+    std::string_view window() const {
+        return std::string_view(buffer_.data() + begin_, buffer_.size() - padded_input::PADDING - begin_);
+    }
+
+    void release_consumed() {
+        buffer_.erase(0, begin_);
+        begin_ = 0;
+    }
+
+    Parser parser_;
+    std::string buffer_;
+    size_t begin_;
+    bool finished_;
+    bool needs_more_;
+};
+
+}
@@ -1,20 +1,23 @@
 #pragma once
 
 #include "parsers/parse_result.h"
+#include "parsers/utils/kernels.h"
 
 namespace ctpc {
 
 // TODO This parser takes the expected string as a string_view, i.e. doesn't take ownership.
 //      Replace this with some owning compile-time string mechanism.
+template<class InputT = Input>
 constexpr auto string(std::string_view expected) {
-    return [expected] (Input input) -> ParseResult<std::string_view> {
-        size_t i = 0;
-        for(; i < expected.size(); ++i) {
-            if (expected[i] != input.input[i]) {
-                return ParseResult<std::string_view>::failure(Input{input.input.substr(i)});
+    return [expected] (InputT input) noexcept(details::nothrow_paranoid_asserts) CTPC_LEAF_INLINE -> ParseResult<std::string_view, InputT> {
+        const size_t matched = kernels::common_prefix_length(expected, input.input);
+        if (matched != expected.size()) {
+            if (input.reaches_partial_end(matched)) {
+                return ParseResult<std::string_view, InputT>::need_more(input.advance(matched));
             }
+            return ParseResult<std::string_view, InputT>::failure(input.advance(matched));
         }
-        return ParseResult<std::string_view>::success(Input{input.input.substr(i)}, input.input.substr(0, i));
+        return ParseResult<std::string_view, InputT>::success(input.advance(matched), input.input.substr(0, matched));
     };
 }
 
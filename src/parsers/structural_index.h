@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "parsers/parse_result.h"
+#include "parsers/recognize.h"
+#include "parsers/utils/kernels.h"
+
+namespace ctpc {
+
+/**
+ * Index of the structural characters of a text, e.g. separators, brackets and newlines, in the style of
+ * simdjson's stage 1.
+ *
+ * The constructor finds all structural characters of the whole text in one SIMD pass and keeps them as a bitmap
+ * with one bit per character. Afterwards, next() finds the next structural character from any position by looking
+ * at 64 characters at a time, so parsers can jump from structural character to structural character instead of
+ * scanning the text in between. See skip_to() and delimited() below.
+ *
+ * If a quote character is given, structural characters between quotes aren't structural. The quotes themselves are.
+ * Quotes can't be escaped, but doubled quotes like in CSV ("a""b") work, since they leave and enter the quote again.
+ *
+ * The index doesn't copy the text, it has to outlive the index. Parsers using the index can only parse this text
+ * or parts of it.
+ *
+ * The SIMD kernels compare against at most kernels::MAX_MATCH_BYTES_NEEDLES structural characters. The constructor
+ * throws std::invalid_argument for more.
+ */
+class structural_index final {
+public:
+    template<class InputT>
+    constexpr structural_index(InputT input, std::string_view structural_chars, std::optional<char> quote = std::nullopt)
+    : text_(input.input), masks_(kernels::num_match_bytes_blocks(input.input.size())) {
+        // This has to be checked even with assertions off, the kernels would write past their needle registers
+        if (structural_chars.size() > kernels::MAX_MATCH_BYTES_NEEDLES) {
+            details::throw_exception<std::invalid_argument>("Too many structural characters");
+        }
+        kernels::match_bytes(text_, std::span<const char>(structural_chars.data(), structural_chars.size()), masks_.data(), input.padding);
+        if (quote.has_value()) {
+            std::vector<uint64_t> quotes(masks_.size());
+            kernels::match_bytes(text_, std::span<const char>(&*quote, 1), quotes.data(), input.padding);
+            // All bits from an opening quote up to (excluding) the closing quote
+            uint64_t carry = 0;
+            for (size_t block = 0; block < masks_.size(); ++block) {
+                const uint64_t in_quotes = kernels::prefix_xor(quotes[block]) ^ carry;
+                masks_[block] = (masks_[block] & ~in_quotes) | quotes[block];
+                carry = (in_quotes >> 63) == 0 ? 0 : ~uint64_t(0);
+            }
+        }
+    }
+
+    constexpr std::string_view text() const {
+        return text_;
+    }
+
+    // Position of the first structural character at or after offset, or std::string_view::npos if there is none
+    constexpr size_t next(size_t offset) const noexcept {
+        return find_structural(offset, [] (char) noexcept {return true;});
+    }
+
+    // Like next(), but only finds the given characters
+    constexpr size_t next(size_t offset, std::string_view chars) const noexcept {
+        return find_structural(offset, [chars] (char c) noexcept {return chars.find(c) != std::string_view::npos;});
+    }
+
+    // True if the character at this position is structural
+    constexpr bool is_structural(size_t offset) const {
+        return offset < text_.size() && (masks_[offset / kernels::MATCH_BYTES_BLOCK_SIZE] >> (offset % kernels::MATCH_BYTES_BLOCK_SIZE) & 1) != 0;
+    }
+
+    // Offset of the input in the indexed text. Throws std::invalid_argument if the input isn't a part of the indexed text.
+    template<class InputT>
+    constexpr size_t offset_of(const InputT& input) const noexcept(!CTPC_HAS_EXCEPTIONS) {
+        // This has to be checked even with assertions off, the lookups would read past the masks.
+        // Comparing unrelated pointers isn't allowed in constant expressions, so check the bounds with std::less.
+        if (std::less<const char*>()(input.input.data(), text_.data()) || std::less<const char*>()(text_.data() + text_.size(), input.input.data() + input.input.size())) {
+            details::throw_exception<std::invalid_argument>("The input isn't a part of the indexed text");
+        }
+        return input.input.data() - text_.data();
+    }
+
+private:
+    template<class Predicate>
+    constexpr size_t find_structural(size_t offset, const Predicate& predicate) const noexcept {
+        size_t block = offset / kernels::MATCH_BYTES_BLOCK_SIZE;
+        if (block >= masks_.size()) {
+            return std::string_view::npos;
+        }
+        uint64_t mask = masks_[block] & (~uint64_t(0) << (offset % kernels::MATCH_BYTES_BLOCK_SIZE));
+        while (true) {
+            while (mask != 0) {
+                const size_t position = block * kernels::MATCH_BYTES_BLOCK_SIZE + std::countr_zero(mask);
+                if (predicate(text_[position])) {
+                    return position;
+                }
+                mask &= mask - 1;
+            }
+            if (++block == masks_.size()) {
+                return std::string_view::npos;
+            }
+            mask = masks_[block];
+        }
+    }
+
+    std::string_view text_;
+    std::vector<uint64_t> masks_;
+};
+
+/**
+ * Consumes everything up to (excluding) the next of the given structural characters, or up to the end of the input
+ * if none follows, and returns it. Never fails. Instead of looking at each character, this jumps there using the index.
+ * E.g. skip_to(index, ",\n") returns the next raw CSV field.
+ * If none of the characters follows in a partial input, the field could continue in the next chunk and this returns NEED_MORE.
+ */
+template<class InputT = Input>
+constexpr auto skip_to(const structural_index& index, std::string_view chars) {
+    return [&index, chars] (InputT input) noexcept(!CTPC_HAS_EXCEPTIONS) CTPC_LEAF_INLINE -> ParseResult<std::string_view, InputT> {
+        const size_t begin = index.offset_of(input);
+        const size_t found = index.next(begin, chars);
+        const size_t length = found == std::string_view::npos ? input.input.size() : std::min(found - begin, input.input.size());
+        if (input.reaches_partial_end(length)) {
+            return ParseResult<std::string_view, InputT>::need_more(input.advance(length));
+        }
+        return ParseResult<std::string_view, InputT>::success(input.advance(length), input.take(length));
+    };
+}
+
+// The parser keeps a reference to the index, so the index has to outlive it
+template<class InputT = Input>
+constexpr auto skip_to(const structural_index&& index, std::string_view chars) = delete;
+
+/**
+ * Runs the parser on everything up to (excluding) the next of the given structural characters, see skip_to().
+ * The parser has to consume all of it, e.g. delimited(index, ",)", parameter()) finds the end of each parameter
+ * with the index and fails if the parameter doesn't end there.
+ *
+ * The parser usually stops at the delimiter by itself, so it first runs on the whole input and the index only checks
+ * where it stopped. This way, short fields don't cut off the runtime kernels' blocks. Only if it didn't stop at the
+ * delimiter, e.g. because it failed or ran past it, it runs again on the delimited part alone, so it can't run past
+ * the delimiter. Parsers that decide differently at the end of their input, like alternative(phrase(a), b), see the
+ * input after the delimiter in the first run.
+ */
+template<class Parser>
+constexpr auto delimited(const structural_index& index, std::string_view chars, Parser&& parser) {
+    using InputT = parser_input_t<Parser>;
+    using result_type = parser_result_t<Parser>;
+    return details::dual_mode_parser{
+        [skip = skip_to<InputT>(index, chars), parser = std::forward<Parser>(parser)] (InputT input, auto mode) noexcept(!CTPC_HAS_EXCEPTIONS && details::is_nothrow_in_mode_v<decltype(mode), Parser>) -> details::mode_result_t<decltype(mode), result_type, InputT> {
+            using parse_result = details::mode_result_t<decltype(mode), result_type, InputT>;
+            const auto field = skip(input);
+            if (field.is_need_more()) {
+                return parse_result::need_more(field.next());
+            }
+            auto parsed = details::run_in_mode(parser, input, mode);
+            if (parsed.is_success() && parsed.next().input.size() == field.next().input.size()) {
+                return parsed;
+            }
+            auto parsed_field = details::run_on_complete_subinput(parser, field.result(), mode);
+            if (!parsed_field.is_success()) {
+                return parsed_field;
+            }
+            if (parsed_field.next().input.size() != 0) {
+                // The parser didn't consume everything up to the delimiter
+                return parse_result::failure(parsed_field.next());
+            }
+            parsed_field.setNext(field.next());
+            return parsed_field;
+        }
+    };
+}
+
+template<class Parser>
+constexpr auto delimited(const structural_index&& index, std::string_view chars, Parser&& parser) = delete;
+
+}
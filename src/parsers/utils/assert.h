@@ -1,13 +1,93 @@
 #pragma once
 
+#include <cstdlib>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Runtime checks of the library have three levels, set by defining CTPC_ASSERT_LEVEL:
+ *  - CTPC_ASSERT_LEVEL_OFF: No checks. Failed assertions are undefined behavior, and the compiler is told so,
+ *                           which lets it drop branches that would only run when an assertion fails.
+ *  - CTPC_ASSERT_LEVEL_DEBUG: ASSERT() checks preconditions of the API, e.g. that result() is only called on
+ *                             successful parse results. ASSERT_PARANOID() is off.
+ *  - CTPC_ASSERT_LEVEL_PARANOID: ASSERT_PARANOID() additionally checks internal invariants in the hot paths of the
+ *                                combinators, e.g. that every ParseResult::success() holds a result.
+ * The default is CTPC_ASSERT_LEVEL_OFF if NDEBUG is defined and CTPC_ASSERT_LEVEL_DEBUG otherwise.
+ *
+ * In constant expressions, all assertions are checked regardless of the level and failing one is a compile error.
+ */
+#define CTPC_ASSERT_LEVEL_OFF 0
+#define CTPC_ASSERT_LEVEL_DEBUG 1
+#define CTPC_ASSERT_LEVEL_PARANOID 2
+
+#ifndef CTPC_ASSERT_LEVEL
+#ifdef NDEBUG
+#define CTPC_ASSERT_LEVEL CTPC_ASSERT_LEVEL_OFF
+#else
+#define CTPC_ASSERT_LEVEL CTPC_ASSERT_LEVEL_DEBUG
+#endif
+#endif
+
+/**
+ * The library works without exceptions, e.g. with -fno-exceptions. Errors that would throw an exception,
+ * like failed assertions or files that can't be opened, abort the program instead.
+ */
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CTPC_HAS_EXCEPTIONS 1
+#else
+#define CTPC_HAS_EXCEPTIONS 0
+#endif
 
 namespace ctpc {
 
-constexpr void ASSERT(bool condition) {
-    if (!condition) {
-        throw std::runtime_error("Assertion failed");
+namespace details {
+    // Not constexpr, so that reaching it in a constant expression is a compile error
+    template<class Exception, class... Args>
+    [[noreturn]] inline void throw_exception(Args&&... args) {
+#if CTPC_HAS_EXCEPTIONS
+        throw Exception(std::forward<Args>(args)...);
+#else
+        (static_cast<void>(args), ...);
+        std::abort();
+#endif
+    }
+
+    [[noreturn]] inline void unreachable() {
+#if defined(__GNUC__)
+        __builtin_unreachable();
+#elif defined(_MSC_VER)
+        __assume(false);
+#else
+        std::abort();
+#endif
+    }
+
+    // True if ASSERT() and ASSERT_PARANOID() respectively can't throw, i.e. they're off or exceptions are disabled
+    constexpr bool nothrow_asserts = CTPC_ASSERT_LEVEL < CTPC_ASSERT_LEVEL_DEBUG || !CTPC_HAS_EXCEPTIONS;
+    constexpr bool nothrow_paranoid_asserts = CTPC_ASSERT_LEVEL < CTPC_ASSERT_LEVEL_PARANOID || !CTPC_HAS_EXCEPTIONS;
+
+    template<int LEVEL>
+    constexpr void check(bool condition) noexcept(LEVEL > CTPC_ASSERT_LEVEL || !CTPC_HAS_EXCEPTIONS) {
+        if (!condition) {
+            if constexpr (LEVEL <= CTPC_ASSERT_LEVEL) {
+                throw_exception<std::runtime_error>("Assertion failed");
+            } else {
+                if (std::is_constant_evaluated()) {
+                    throw_exception<std::runtime_error>("Assertion failed");
+                }
+                unreachable();
+            }
+        }
     }
 }
 
+constexpr void ASSERT(bool condition) noexcept(details::nothrow_asserts) {
+    details::check<CTPC_ASSERT_LEVEL_DEBUG>(condition);
+}
+
+constexpr void ASSERT_PARANOID(bool condition) noexcept(details::nothrow_paranoid_asserts) {
+    details::check<CTPC_ASSERT_LEVEL_PARANOID>(condition);
+}
+
 }
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace ctpc {
+
+/**
+ * Stack allocator for coroutine frames, see push_parser.
+ *
+ * A parent coroutine awaits each child to completion, so frames of one parse are freed in the reverse order of their
+ * allocation. That makes allocating a frame a pointer bump and freeing it a pointer decrement. Frames of different
+ * parses can be freed out of order, e.g. if a push_parser is replaced by a new one on the same arena. Such a frame is
+ * only marked as freed, and its space is reclaimed once the frames above it are freed as well. The arena keeps its memory after
+ * a parse finished, so a connection can reuse one arena for all its messages without going to the heap again.
+ * Frames that don't fit anymore are allocated from the heap instead.
+ */
+class coroutine_arena final {
+public:
+    explicit coroutine_arena(size_t capacity = 16 * 1024)
+    : data_(std::make_unique<std::byte[]>(capacity)), capacity_(capacity), top_(0), top_frame_(0), high_water_(0), num_heap_allocations_(0) {}
+
+    coroutine_arena(const coroutine_arena&) = delete;
+    coroutine_arena& operator=(const coroutine_arena&) = delete;
+
+    void* allocate(size_t size) {
+        const size_t total = total_size(size);
+        header* allocated;
+        if (total <= capacity_ - top_) {
+            allocated = new (data_.get() + top_) header{this, top_frame_};
+            top_frame_ = top_;
+            top_ += total;
+            high_water_ = std::max(high_water_, top_);
+        } else {
+            allocated = new (::operator new(total)) header{nullptr, 0};
+            ++num_heap_allocations_;
+        }
+        return reinterpret_cast<std::byte*>(allocated) + HEADER_SIZE;
+    }
+
+    // Frees memory returned by allocate() of any arena
+    static void deallocate(void* ptr, size_t /*size*/) noexcept {
+        header* allocated = reinterpret_cast<header*>(static_cast<std::byte*>(ptr) - HEADER_SIZE);
+        coroutine_arena* arena = allocated->arena;
+        if (arena == nullptr) {
+            ::operator delete(allocated);
+            return;
+        }
+        // A frame in the arena without an arena is freed. Usually it's the topmost frame, which is popped right away.
+        allocated->arena = nullptr;
+        arena->pop_freed_frames_();
+    }
+
+    // Bytes currently allocated from the arena, including frames freed out of order that aren't reclaimed yet
+    size_t used() const {
+        return top_;
+    }
+
+    // Largest number of bytes that were allocated from the arena at the same time
+    size_t high_water() const {
+        return high_water_;
+    }
+
+    // Number of frames that didn't fit into the arena
+    size_t num_heap_allocations() const {
+        return num_heap_allocations_;
+    }
+
+private:
+    // Each allocation remembers the arena it came from, because coroutine frames are freed without their arguments.
+    // Heap allocations have no arena. Frames in the arena also remember the offset of the frame below them.
+    struct header final {
+        coroutine_arena* arena;
+        size_t below;
+    };
+    static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+    static_assert(sizeof(header) <= HEADER_SIZE);
+
+    static constexpr size_t total_size(size_t size) {
+        return (HEADER_SIZE + size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+
+    // Pops the topmost frame as long as it's freed, including frames freed out of order before
+    void pop_freed_frames_() noexcept {
+        while (top_ != 0) {
+            const header* frame = reinterpret_cast<const header*>(data_.get() + top_frame_);
+            if (frame->arena != nullptr) {
+                break;
+            }
+            top_ = top_frame_;
+            top_frame_ = frame->below;
+        }
+    }
+
+    std::unique_ptr<std::byte[]> data_;
+    size_t capacity_;
+    size_t top_;
+    // Offset of the topmost frame, if top_ isn't 0
+    size_t top_frame_;
+    size_t high_water_;
+    size_t num_heap_allocations_;
+};
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CTPC_X86_KERNELS 1
+#endif
+
+namespace ctpc {
+
+/**
+ * Instruction set levels that the runtime kernels (see kernels.h) have implementations for,
+ * ordered from the least to the most capable one.
+ */
+enum class cpu_level : uint8_t {SCALAR, SSE2, AVX2, AVX512BW};
+
+constexpr std::string_view to_string(cpu_level level) {
+    switch (level) {
+        case cpu_level::SCALAR: return "scalar";
+        case cpu_level::SSE2: return "sse2";
+        case cpu_level::AVX2: return "avx2";
+        case cpu_level::AVX512BW: return "avx512bw";
+    }
+    return "unknown";
+}
+
+constexpr std::optional<cpu_level> parse_cpu_level(std::string_view name) {
+    for (cpu_level level : {cpu_level::SCALAR, cpu_level::SSE2, cpu_level::AVX2, cpu_level::AVX512BW}) {
+        if (name == to_string(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * Returns the most capable level the CPU supports.
+ * On x86, this uses cpuid, which also checks that the operating system saves the AVX registers.
+ * Other platforms don't have SIMD kernels yet and always get the scalar kernels.
+ */
+inline cpu_level detect_cpu_level() {
+#if defined(CTPC_X86_KERNELS)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return cpu_level::AVX512BW;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return cpu_level::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return cpu_level::SSE2;
+    }
+#endif
+    return cpu_level::SCALAR;
+}
+
+}
@@ -1,49 +1,171 @@
 #pragma once
 
 #include <array>
+#include <cassert>
+#include <iterator>
+#include <memory>
 #include <vector>
 #include "assert.h"
 
 namespace ctpc {
 
+    namespace details {
+        /**
+         * A cvector_slot holds either nothing or one cvector element. Elements are constructed into the slot when
+         * they're added to the cvector and destructed when they're removed, so the element type doesn't need a default
+         * constructor. The slot itself doesn't know whether it holds an element, cvector
+         * keeps track of that and copies, moves and destructs the elements.
+         */
+        template<class T>
+        union cvector_slot final {
+            constexpr cvector_slot(): empty_() {}
+            // These are trivial if T's are trivial and deleted otherwise. cvector copies element-wise anyways.
+            constexpr cvector_slot(const cvector_slot&) = default;
+            constexpr cvector_slot(cvector_slot&&) = default;
+            constexpr cvector_slot& operator=(const cvector_slot&) = default;
+            constexpr cvector_slot& operator=(cvector_slot&&) = default;
+            constexpr ~cvector_slot() requires std::is_trivially_destructible_v<T> = default;
+            constexpr ~cvector_slot() {}
+
+            // Constant expressions can't leave all members of a union inactive, so this is the active one in empty slots
+            char empty_;
+            T value_;
+        };
+
+        /**
+         * Random access iterator over the elements in a range of cvector_slot.
+         * Pointer arithmetic between the elements of different slots isn't allowed in constant expressions,
+         * so we can't just use T* as iterator and do the arithmetic on the slot pointers instead.
+         */
+        template<class T, class Slot>
+        class cvector_slot_iterator final {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_const_t<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = T*;
+            using reference = T&;
+
+            constexpr cvector_slot_iterator(): slot_(nullptr) {}
+            constexpr explicit cvector_slot_iterator(Slot* slot): slot_(slot) {}
+
+            constexpr reference operator*() const { return slot_->value_; }
+            constexpr pointer operator->() const { return &slot_->value_; }
+            constexpr reference operator[](difference_type offset) const { return slot_[offset].value_; }
+
+            constexpr cvector_slot_iterator& operator++() { ++slot_; return *this; }
+            constexpr cvector_slot_iterator operator++(int) { cvector_slot_iterator result = *this; ++slot_; return result; }
+            constexpr cvector_slot_iterator& operator--() { --slot_; return *this; }
+            constexpr cvector_slot_iterator operator--(int) { cvector_slot_iterator result = *this; --slot_; return result; }
+            constexpr cvector_slot_iterator& operator+=(difference_type offset) { slot_ += offset; return *this; }
+            constexpr cvector_slot_iterator& operator-=(difference_type offset) { slot_ -= offset; return *this; }
+            constexpr cvector_slot_iterator operator+(difference_type offset) const { return cvector_slot_iterator(slot_ + offset); }
+            constexpr cvector_slot_iterator operator-(difference_type offset) const { return cvector_slot_iterator(slot_ - offset); }
+            constexpr difference_type operator-(const cvector_slot_iterator& rhs) const { return slot_ - rhs.slot_; }
+
+            constexpr bool operator==(const cvector_slot_iterator& rhs) const { return slot_ == rhs.slot_; }
+            constexpr auto operator<=>(const cvector_slot_iterator& rhs) const { return slot_ <=> rhs.slot_; }
+
+        private:
+            Slot* slot_;
+        };
+    }
+
     /**
      * cvector is a compile time alternative for std::vector, i.e. a dynamically sized array that can grow and shrink.
      *
-     * Since heap allocations at compile time are impossible, cvector is backed by a std::array with a preallocated
-     * maximum size and cvector cannot grow past this maximum size.
+     * Since heap allocations at compile time are impossible, cvector has a preallocated maximum size and cannot grow
+     * past this maximum size.
      *
      * However, cvector is not meant to be instantiated at runtime and the compiler should strip it away in most cases,
      * meaning a large MAX_SIZE doesn't have any runtime impact.
      *
      * However, it's better to verify that in your concrete use case since it's easy to make a mistake and accidentally
      * access the cvector at runtime, in which case suddenly it does exist at runtime.
+     *
+     * Trivially copyable element types with a default constructor are stored in a std::array. Compilers evaluate
+     * copies of such an array as a whole in constant expressions, which is much faster than running constructors for
+     * MAX_SIZE slots. All other element types are stored in an array of uninitialized slots and the elements are only
+     * constructed when they're added, see cvector_slot. So they don't need a default constructor, pop_back() destructs
+     * the element, and copies and moves of non-trivially-copyable elements only touch size() elements.
      */
-     // TODO Can I make this work without requiring T to have a default constructor?
     template<class T, size_t MAX_SIZE>
     class cvector final {
+    private:
+        static constexpr bool uses_slots_ = !std::is_trivially_copyable_v<T> || !std::is_default_constructible_v<T>;
+        // Trivially copyable elements are copied together with the whole storage, everything else element by element.
+        static constexpr bool copies_elementwise_ = !std::is_trivially_copyable_v<T>;
+        using Slot = details::cvector_slot<T>;
+        using Storage = std::conditional_t<uses_slots_, std::array<Slot, MAX_SIZE>, std::array<T, MAX_SIZE>>;
+
     public:
         using value_type = T;
+        using iterator = std::conditional_t<uses_slots_, details::cvector_slot_iterator<T, Slot>, T*>;
+        using const_iterator = std::conditional_t<uses_slots_, details::cvector_slot_iterator<const T, const Slot>, const T*>;
 
         constexpr explicit cvector()
         : elements_(), size_(0) {}
 
-        constexpr cvector(cvector&&) = default;
-        constexpr cvector(const cvector&) = default;
-        constexpr cvector& operator=(cvector&&) = default;
-        constexpr cvector& operator=(const cvector&) = default;
+        constexpr cvector(const cvector&) requires (!copies_elementwise_ && std::is_copy_constructible_v<T>) = default;
+        constexpr cvector(cvector&&) requires (!copies_elementwise_) = default;
+        constexpr cvector& operator=(const cvector&) requires (!copies_elementwise_ && std::is_copy_constructible_v<T>) = default;
+        constexpr cvector& operator=(cvector&&) requires (!copies_elementwise_) = default;
+
+        constexpr cvector(const cvector& rhs) requires (copies_elementwise_ && std::is_copy_constructible_v<T>)
+        : elements_(), size_(0) {
+            for (const T& element : rhs) {
+                construct_back_(element);
+            }
+        }
+
+        constexpr cvector(cvector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) requires copies_elementwise_
+        : elements_(), size_(0) {
+            for (T& element : rhs) {
+                construct_back_(std::move(element));
+            }
+        }
+
+        constexpr cvector& operator=(const cvector& rhs) requires (copies_elementwise_ && std::is_copy_constructible_v<T>) {
+            if (this != &rhs) {
+                clear_();
+                for (const T& element : rhs) {
+                    construct_back_(element);
+                }
+            }
+            return *this;
+        }
+
+        constexpr cvector& operator=(cvector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) requires copies_elementwise_ {
+            if (this != &rhs) {
+                clear_();
+                for (T& element : rhs) {
+                    construct_back_(std::move(element));
+                }
+            }
+            return *this;
+        }
+
+        constexpr ~cvector() requires std::is_trivially_destructible_v<T> = default;
+
+        constexpr ~cvector() {
+            clear_();
+        }
 
         constexpr explicit cvector(std::initializer_list<T> elements)
-        : elements_(), size_(elements.size()) {
-            for (size_t i = 0; i < elements.size(); ++i) {
-                elements_[i] = *(elements.begin()+i);
+        : elements_(), size_(0) {
+            if (elements.size() > MAX_SIZE) {
+                details::throw_exception<std::runtime_error>("No capacity left");
+            }
+            for (const T& element : elements) {
+                construct_back_(element);
             }
         }
 
         constexpr const T& operator[](size_t index) const {
             if (index >= size_) {
-                throw std::runtime_error("out of bounds");
+                details::throw_exception<std::runtime_error>("out of bounds");
             }
-            return elements_[index];
+            return get_unsafe(index);
         }
 
         constexpr T& operator[](size_t index) {
@@ -51,7 +173,11 @@ namespace ctpc {
         }
 
         constexpr const T& get_unsafe(size_t index) const {
-            return elements_[index];
+            if constexpr (uses_slots_) {
+                return elements_[index].value_;
+            } else {
+                return elements_[index];
+            }
         }
 
         constexpr T& get_unsafe(size_t index) {
@@ -63,35 +189,63 @@ namespace ctpc {
             return *(end()-1);
         }
 
-        constexpr const T* begin() const {
-            return elements_.begin();
+        constexpr const_iterator begin() const {
+            if constexpr (uses_slots_) {
+                return const_iterator(elements_.data());
+            } else {
+                return elements_.data();
+            }
         }
 
-        constexpr T* begin() {
-            return const_cast<T*>(const_cast<const cvector*>(this)->begin());
+        constexpr iterator begin() {
+            if constexpr (uses_slots_) {
+                return iterator(elements_.data());
+            } else {
+                return elements_.data();
+            }
         }
 
-        constexpr const T* end() const {
-            return elements_.begin() + size_;
+        constexpr const_iterator end() const {
+            return begin() + size_;
         }
 
-        constexpr T* end() {
-            return const_cast<T*>(const_cast<const cvector*>(this)->end());
+        constexpr iterator end() {
+            return begin() + size_;
         }
 
         constexpr size_t size() const {
             return size_;
         }
 
+        // True if no more elements fit in. rep() and repsep() check this and return an ERROR result instead of throwing.
+        constexpr bool full() const {
+            return size_ == MAX_SIZE;
+        }
+
+        // Recognizers of rep() and repsep() don't build a cvector and check the number of elements against this instead
+        static constexpr size_t max_size() noexcept {
+            return MAX_SIZE;
+        }
+
         template<class U>
         constexpr void push_back(U&& elem) {
             static_assert(std::is_convertible_v<U, T>, "Wrong argument type for cvector::push_back");
-            if (size_ == elements_.size()) {
-                throw std::runtime_error("No capacity left");
+            if (size_ == MAX_SIZE) {
+                details::throw_exception<std::runtime_error>("No capacity left");
             }
 
-            elements_[size_] = std::forward<U>(elem);
+            construct_back_(std::forward<U>(elem));
+        }
+
+        template<class... Args>
+        constexpr T& emplace_back(Args&&... args) {
+            if (size_ == MAX_SIZE) {
+                details::throw_exception<std::runtime_error>("No capacity left");
+            }
+
+            std::construct_at(element_ptr_(size_), std::forward<Args>(args)...);
             ++size_;
+            return back();
         }
 
         constexpr void reserve(size_t capacity) {
@@ -101,12 +255,38 @@ namespace ctpc {
 
         // TODO Test pop_back()
         constexpr void pop_back() {
+            ASSERT(size_ > 0);
             --size_;
-            elements_[size_] = T();
+            if constexpr (uses_slots_) {
+                std::destroy_at(&elements_[size_].value_);
+                // Switch the slot back to its empty state
+                std::construct_at(&elements_[size_].empty_);
+            }
         }
 
     private:
-        std::array<T, MAX_SIZE> elements_;
+        template<class U>
+        constexpr void construct_back_(U&& elem) {
+            std::construct_at(element_ptr_(size_), std::forward<U>(elem));
+            ++size_;
+        }
+
+        // Elements in the std::array are trivially destructible, so constructing a new one over an old one is fine
+        constexpr T* element_ptr_(size_t index) {
+            if constexpr (uses_slots_) {
+                return &elements_[index].value_;
+            } else {
+                return &elements_[index];
+            }
+        }
+
+        constexpr void clear_() {
+            while (size_ > 0) {
+                pop_back();
+            }
+        }
+
+        Storage elements_;
         size_t size_;
     };
 
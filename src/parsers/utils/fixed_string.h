@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace ctpc {
+
+    /**
+     * fixed_string is a string literal that can be passed as a template argument, e.g. parse_exact_size<"input">(...).
+     *
+     * Template argument objects have static storage duration, so string_views pointing into a fixed_string
+     * stay valid forever and can be part of constexpr variables.
+     */
+    template<size_t SIZE_WITH_NULLTERMINATOR>
+    struct fixed_string final {
+        constexpr fixed_string(const char (&str)[SIZE_WITH_NULLTERMINATOR]) {
+            for (size_t i = 0; i < SIZE_WITH_NULLTERMINATOR; ++i) {
+                data[i] = str[i];
+            }
+        }
+
+        constexpr std::string_view view() const {
+            return std::string_view(data, SIZE_WITH_NULLTERMINATOR - 1);
+        }
+
+        // Needs to be public, otherwise fixed_string couldn't be a template argument
+        char data[SIZE_WITH_NULLTERMINATOR];
+    };
+
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include "parsers/utils/assert.h"
+#include "parsers/utils/cpu_features.h"
+#include "parsers/utils/kernels_scalar.h"
+#include "parsers/utils/kernels_x86.h"
+
+namespace ctpc {
+
+/**
+ * Kernels for the hot loops of the basic parsers.
+ *
+ * Parsers have to stay constexpr, but byte-by-byte loops are slow at runtime. Each kernel has a constexpr scalar
+ * implementation that is used in constant expressions and SIMD implementations that are used at runtime.
+ * std::is_constant_evaluated() picks between them, so parsers can just call the kernel and work in both worlds.
+ *
+ * At runtime, the kernels are called through a table of function pointers. On first use, it gets bound to the
+ * implementations for the best cpu_level the CPU supports, so the same binary runs on all x86 CPUs and still uses
+ * AVX-512 where available. The environment variable CTPC_CPU_LEVEL (e.g. CTPC_CPU_LEVEL=sse2) lowers the level,
+ * and force_cpu_level() switches it at runtime, e.g. for benchmarks or to compare against the scalar kernels.
+ */
+namespace kernels {
+
+namespace details {
+    using scan_while_class_kernel = size_t (*)(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept;
+    using common_prefix_length_kernel = size_t (*)(std::string_view lhs, std::string_view rhs) noexcept;
+    using find_byte_kernel = size_t (*)(std::string_view input, char needle, size_t padding) noexcept;
+    using accumulate_digits_kernel = size_t (*)(std::string_view input, int64_t* value, size_t padding) noexcept;
+    using match_bytes_kernel = void (*)(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept;
+
+    constexpr std::array<char_range, 1> DIGITS = {char_range{'0', '9'}};
+
+    template<scan_while_class_kernel SCAN_WHILE_CLASS>
+    size_t accumulate_digits_with_scan(std::string_view input, int64_t* value, size_t padding) noexcept {
+        const size_t num_digits = SCAN_WHILE_CLASS(input, DIGITS, padding);
+        swar::accumulate_digits(input, num_digits, value);
+        return num_digits;
+    }
+
+    // The scalar kernels with the kernel signature. They don't need the padding.
+    inline size_t scalar_scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t /*padding*/) noexcept {
+        return scalar::scan_while_class(input, ranges);
+    }
+    inline size_t scalar_find_byte(std::string_view input, char needle, size_t /*padding*/) noexcept {
+        return scalar::find_byte(input, needle);
+    }
+    inline void scalar_match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t /*padding*/) noexcept {
+        scalar::match_bytes(input, needles, masks);
+    }
+
+    struct kernel_table final {
+        scan_while_class_kernel scan_while_class;
+        common_prefix_length_kernel common_prefix_length;
+        find_byte_kernel find_byte;
+        accumulate_digits_kernel accumulate_digits;
+        match_bytes_kernel match_bytes;
+    };
+
+    constexpr kernel_table kernels_for(cpu_level level) {
+        switch (level) {
+#if defined(CTPC_X86_KERNELS)
+            case cpu_level::AVX512BW:
+                return {&avx512bw::scan_while_class, &avx512bw::common_prefix_length, &avx512bw::find_byte, &accumulate_digits_with_scan<&avx512bw::scan_while_class>, &avx512bw::match_bytes};
+            case cpu_level::AVX2:
+                return {&avx2::scan_while_class, &avx2::common_prefix_length, &avx2::find_byte, &accumulate_digits_with_scan<&avx2::scan_while_class>, &avx2::match_bytes};
+            case cpu_level::SSE2:
+                return {&sse2::scan_while_class, &sse2::common_prefix_length, &sse2::find_byte, &accumulate_digits_with_scan<&sse2::scan_while_class>, &sse2::match_bytes};
+#endif
+            default:
+                return {&scalar_scan_while_class, &scalar::common_prefix_length, &scalar_find_byte, &accumulate_digits_with_scan<&scalar_scan_while_class>, &scalar_match_bytes};
+        }
+    }
+
+    // Best level the CPU supports, unless CTPC_CPU_LEVEL asks for a lower one
+    inline cpu_level default_cpu_level() {
+        const cpu_level detected = detect_cpu_level();
+        const char* requested = std::getenv("CTPC_CPU_LEVEL");
+        if (requested != nullptr) {
+            const std::optional<cpu_level> parsed = parse_cpu_level(requested);
+            if (parsed.has_value() && *parsed < detected) {
+                return *parsed;
+            }
+        }
+        return detected;
+    }
+
+    size_t resolve_scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept;
+    size_t resolve_common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept;
+    size_t resolve_find_byte(std::string_view input, char needle, size_t padding) noexcept;
+    size_t resolve_accumulate_digits(std::string_view input, int64_t* value, size_t padding) noexcept;
+    void resolve_match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept;
+
+    /**
+     * The kernels the runtime code currently calls. The pointers initially point to resolve_* functions, which bind
+     * the table on first use. Since this is constant initialized, parsers can even run during static
+     * initialization, and after binding, calls don't need to check whether the CPU was already detected.
+     * The pointers are atomic so that force_cpu_level() can run concurrently to parsing.
+     */
+    struct active_kernel_table final {
+        std::atomic<scan_while_class_kernel> scan_while_class;
+        std::atomic<common_prefix_length_kernel> common_prefix_length;
+        std::atomic<find_byte_kernel> find_byte;
+        std::atomic<accumulate_digits_kernel> accumulate_digits;
+        std::atomic<match_bytes_kernel> match_bytes;
+        std::atomic<bool> is_bound;
+        std::atomic<cpu_level> level;
+    };
+
+    inline constinit active_kernel_table active_kernels{
+        &resolve_scan_while_class, &resolve_common_prefix_length, &resolve_find_byte, &resolve_accumulate_digits, &resolve_match_bytes, false, cpu_level::SCALAR
+    };
+
+    inline void bind_kernels(cpu_level level) {
+        const kernel_table table = kernels_for(level);
+        active_kernels.scan_while_class.store(table.scan_while_class, std::memory_order_relaxed);
+        active_kernels.common_prefix_length.store(table.common_prefix_length, std::memory_order_relaxed);
+        active_kernels.find_byte.store(table.find_byte, std::memory_order_relaxed);
+        active_kernels.accumulate_digits.store(table.accumulate_digits, std::memory_order_relaxed);
+        active_kernels.match_bytes.store(table.match_bytes, std::memory_order_relaxed);
+        active_kernels.level.store(level, std::memory_order_relaxed);
+        active_kernels.is_bound.store(true, std::memory_order_relaxed);
+    }
+
+    inline void bind_kernels_if_unbound() {
+        if (!active_kernels.is_bound.load(std::memory_order_relaxed)) {
+            bind_kernels(default_cpu_level());
+        }
+    }
+
+    inline size_t resolve_scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept {
+        bind_kernels_if_unbound();
+        return active_kernels.scan_while_class.load(std::memory_order_relaxed)(input, ranges, padding);
+    }
+
+    inline size_t resolve_common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+        bind_kernels_if_unbound();
+        return active_kernels.common_prefix_length.load(std::memory_order_relaxed)(lhs, rhs);
+    }
+
+    inline size_t resolve_find_byte(std::string_view input, char needle, size_t padding) noexcept {
+        bind_kernels_if_unbound();
+        return active_kernels.find_byte.load(std::memory_order_relaxed)(input, needle, padding);
+    }
+
+    inline size_t resolve_accumulate_digits(std::string_view input, int64_t* value, size_t padding) noexcept {
+        bind_kernels_if_unbound();
+        return active_kernels.accumulate_digits.load(std::memory_order_relaxed)(input, value, padding);
+    }
+
+    inline void resolve_match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept {
+        bind_kernels_if_unbound();
+        active_kernels.match_bytes.load(std::memory_order_relaxed)(input, needles, masks, padding);
+    }
+}
+
+/**
+ * Returns the cpu_level whose kernels are used at runtime.
+ */
+inline cpu_level active_cpu_level() {
+    details::bind_kernels_if_unbound();
+    return details::active_kernels.level.load(std::memory_order_relaxed);
+}
+
+/**
+ * Use the kernels of the given level from now on. Throws if the CPU doesn't support that level.
+ */
+inline void force_cpu_level(cpu_level level) {
+    if (level > detect_cpu_level()) {
+        ctpc::details::throw_exception<std::runtime_error>("This CPU doesn't support the requested kernels");
+    }
+    details::bind_kernels(level);
+}
+
+/**
+ * Go back to the level that was chosen automatically, see default_cpu_level().
+ */
+inline void reset_cpu_level() {
+    details::bind_kernels(details::default_cpu_level());
+}
+
+/**
+ * Returns the number of characters at the beginning of the input that are in the given character class.
+ * padding is the number of readable bytes after the end of the input, see PaddedInput.
+ */
+template<size_t NUM_RANGES>
+constexpr size_t scan_while_class(std::string_view input, const char_class<NUM_RANGES>& cls, size_t padding = 0) noexcept {
+    if (std::is_constant_evaluated()) {
+        return details::scalar::scan_while_class(input, cls.ranges);
+    }
+    return details::active_kernels.scan_while_class.load(std::memory_order_relaxed)(input, cls.ranges, padding);
+}
+
+/**
+ * Returns the number of characters at the beginning of lhs and rhs that are equal.
+ * To check whether input starts with a literal, check that the result equals the literal size.
+ */
+constexpr size_t common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+    if (std::is_constant_evaluated()) {
+        return details::scalar::common_prefix_length(lhs, rhs);
+    }
+    return details::active_kernels.common_prefix_length.load(std::memory_order_relaxed)(lhs, rhs);
+}
+
+/**
+ * Returns the index of the first occurrence of needle in the input, or std::string_view::npos if there is none.
+ * padding is the number of readable bytes after the end of the input, see PaddedInput.
+ */
+constexpr size_t find_byte(std::string_view input, char needle, size_t padding = 0) noexcept {
+    if (std::is_constant_evaluated()) {
+        return details::scalar::find_byte(input, needle);
+    }
+    return details::active_kernels.find_byte.load(std::memory_order_relaxed)(input, needle, padding);
+}
+
+/**
+ * Parses the decimal digits at the beginning of the input and adds them to *value, i.e. each digit
+ * computes *value = *value * 10 + digit. Returns the number of digits.
+ * padding is the number of readable bytes after the end of the input, see PaddedInput.
+ */
+constexpr size_t accumulate_digits(std::string_view input, int64_t* value, size_t padding = 0) noexcept {
+    if (std::is_constant_evaluated()) {
+        return details::scalar::accumulate_digits(input, value);
+    }
+    return details::active_kernels.accumulate_digits.load(std::memory_order_relaxed)(input, value, padding);
+}
+
+/**
+ * Finds all occurrences of the needles (at most MAX_MATCH_BYTES_NEEDLES) in the input. Writes one bitmask for each
+ * block of MATCH_BYTES_BLOCK_SIZE characters to masks, see num_match_bytes_blocks(). Bit j of masks[b] is set iff the
+ * character at index b * MATCH_BYTES_BLOCK_SIZE + j is one of the needles.
+ * padding is the number of readable bytes after the end of the input, see PaddedInput.
+ */
+constexpr void match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding = 0) noexcept(ctpc::details::nothrow_asserts) {
+    ASSERT(needles.size() <= MAX_MATCH_BYTES_NEEDLES);
+    if (std::is_constant_evaluated()) {
+        details::scalar::match_bytes(input, needles, masks);
+        return;
+    }
+    details::active_kernels.match_bytes.load(std::memory_order_relaxed)(input, needles, masks, padding);
+}
+
+}
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace ctpc {
+namespace kernels {
+
+// Inclusive range of characters, e.g. char_range{'a', 'z'}
+struct char_range final {
+    char first;
+    char last;
+
+    constexpr bool contains(char c) const {
+        // Unsigned arithmetic so that a single comparison checks both bounds
+        return static_cast<unsigned char>(c - first) <= static_cast<unsigned char>(last - first);
+    }
+};
+
+// The SIMD kernels keep all ranges of a class in registers
+constexpr size_t MAX_CHAR_CLASS_RANGES = 8;
+
+// Union of a few character ranges, e.g. make_char_class(char_range{'a', 'z'}, char_range{'0', '9'})
+template<size_t NUM_RANGES>
+struct char_class final {
+    static_assert(NUM_RANGES <= MAX_CHAR_CLASS_RANGES, "Too many ranges in char_class");
+
+    std::array<char_range, NUM_RANGES> ranges;
+
+    constexpr bool contains(char c) const {
+        for (const char_range& range : ranges) {
+            if (range.contains(c)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template<class... Ranges>
+constexpr char_class<sizeof...(Ranges)> make_char_class(Ranges... ranges) {
+    static_assert((std::is_same_v<char_range, Ranges> && ...), "make_char_class expects char_range arguments");
+    return char_class<sizeof...(Ranges)>{{ranges...}};
+}
+
+// match_bytes() compares against all needles at once, so the SIMD kernels keep them in registers as well
+constexpr size_t MAX_MATCH_BYTES_NEEDLES = 8;
+
+// match_bytes() returns one bitmask for each block of this many characters
+constexpr size_t MATCH_BYTES_BLOCK_SIZE = 64;
+
+constexpr size_t num_match_bytes_blocks(size_t input_size) {
+    return (input_size + MATCH_BYTES_BLOCK_SIZE - 1) / MATCH_BYTES_BLOCK_SIZE;
+}
+
+// Bit i of the result is the xor of bits 0..i of the argument. For a match_bytes() mask of quotes, this gives the
+// characters from each opening quote up to (excluding) the closing quote.
+constexpr uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+namespace details {
+    // Byte-by-byte implementations. These are used in constant expressions, for the input tails the SIMD kernels
+    // don't handle, and at runtime on CPUs without SIMD kernels.
+    namespace scalar {
+        constexpr bool contains(std::span<const char_range> ranges, char c) {
+            for (const char_range& range : ranges) {
+                if (range.contains(c)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        constexpr size_t scan_while_class(std::string_view input, std::span<const char_range> ranges) noexcept {
+            size_t i = 0;
+            while (i < input.size() && contains(ranges, input[i])) {
+                ++i;
+            }
+            return i;
+        }
+
+        constexpr size_t common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+            const size_t size = std::min(lhs.size(), rhs.size());
+            size_t i = 0;
+            while (i < size && lhs[i] == rhs[i]) {
+                ++i;
+            }
+            return i;
+        }
+
+        constexpr size_t find_byte(std::string_view input, char needle) noexcept {
+            for (size_t i = 0; i < input.size(); ++i) {
+                if (input[i] == needle) {
+                    return i;
+                }
+            }
+            return std::string_view::npos;
+        }
+
+        constexpr void match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks) noexcept {
+            for (size_t block = 0; block < num_match_bytes_blocks(input.size()); ++block) {
+                masks[block] = 0;
+            }
+            for (size_t i = 0; i < input.size(); ++i) {
+                for (char needle : needles) {
+                    if (input[i] == needle) {
+                        masks[i / MATCH_BYTES_BLOCK_SIZE] |= uint64_t(1) << (i % MATCH_BYTES_BLOCK_SIZE);
+                        break;
+                    }
+                }
+            }
+        }
+
+        constexpr size_t accumulate_digits(std::string_view input, int64_t* value) noexcept {
+            size_t i = 0;
+            for (; i < input.size() && input[i] >= '0' && input[i] <= '9'; ++i) {
+                *value *= 10;
+                *value += input[i] - '0';
+            }
+            return i;
+        }
+    }
+
+    namespace swar {
+        constexpr size_t BLOCK_SIZE = 8;
+
+        // Converts 8 ASCII digits to their value. The first digit is the most significant one.
+        // Only works on little endian platforms.
+        inline uint64_t parse_8_digits(const char* data) {
+            uint64_t block;
+            std::memcpy(&block, data, sizeof(block));
+            block -= 0x3030303030303030;
+            // Combine neighbouring digits into 2-digit, 4-digit and finally the 8-digit value
+            block = (block * 10) + (block >> 8);
+            block = (((block & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) + (((block >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+            return block;
+        }
+
+        // Like scalar::accumulate_digits, but expects the caller to already know that the first num_digits characters
+        // are digits, so the runtime kernels can find the end of the number with their SIMD scan.
+        inline void accumulate_digits(std::string_view input, size_t num_digits, int64_t* value) noexcept {
+            // Unsigned so that overflows wrap around instead of being undefined behavior
+            uint64_t accumulator = static_cast<uint64_t>(*value);
+            size_t i = 0;
+            if constexpr (std::endian::native == std::endian::little) {
+                for (; i + BLOCK_SIZE <= num_digits; i += BLOCK_SIZE) {
+                    accumulator = accumulator * 100000000 + parse_8_digits(input.data() + i);
+                }
+            }
+            for (; i < num_digits; ++i) {
+                accumulator = accumulator * 10 + static_cast<uint64_t>(input[i] - '0');
+            }
+            *value = static_cast<int64_t>(accumulator);
+        }
+    }
+}
+
+}
+}
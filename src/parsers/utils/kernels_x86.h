@@ -0,0 +1,309 @@
+#pragma once
+
+#include "parsers/utils/cpu_features.h"
+#include "parsers/utils/kernels_scalar.h"
+
+#if defined(CTPC_X86_KERNELS)
+
+#include <immintrin.h>
+
+namespace ctpc {
+namespace kernels {
+namespace details {
+
+/**
+ * SIMD implementations of the kernels for x86.
+ *
+ * Each function is compiled for its instruction set with a target attribute instead of compiler flags, so the binary
+ * can contain all of them and kernels.h can pick the best one for the CPU it runs on. Each implementation handles
+ * full blocks and leaves the rest of the input to the next smaller implementation.
+ *
+ * If the input is padded (see padded_input), blocks may extend into the padding. That way, the end of the input is
+ * processed with full blocks as well, and the results just have to be limited to the actual input.
+ */
+
+// Returns true if a full block starting at index i is readable and contains at least one input character
+constexpr bool has_block(std::string_view input, size_t padding, size_t i, size_t block_size) {
+    return i < input.size() && i + block_size <= input.size() + padding;
+}
+
+// Matches found in the padding aren't actual matches
+constexpr size_t limit_scan_result(std::string_view input, size_t result) {
+    return std::min(result, input.size());
+}
+constexpr size_t limit_find_result(std::string_view input, size_t result) {
+    return result < input.size() ? result : std::string_view::npos;
+}
+constexpr uint64_t limit_match_bytes_mask(std::string_view input, size_t i, uint64_t mask) {
+    const size_t remaining = input.size() - i;
+    return remaining >= MATCH_BYTES_BLOCK_SIZE ? mask : mask & ((uint64_t(1) << remaining) - 1);
+}
+
+namespace sse2 {
+    constexpr size_t BLOCK_SIZE = 16;
+
+    __attribute__((target("sse2"))) inline __m128i load_block(const char* data) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    }
+
+    // Bit i of the result is set iff byte i of the block matches
+    __attribute__((target("sse2"))) inline uint32_t to_bitmask(__m128i matches) noexcept {
+        return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    }
+
+    __attribute__((target("sse2"))) inline size_t scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept {
+        __m128i firsts[MAX_CHAR_CLASS_RANGES];
+        __m128i limits[MAX_CHAR_CLASS_RANGES];
+        for (size_t range = 0; range < ranges.size(); ++range) {
+            firsts[range] = _mm_set1_epi8(ranges[range].first);
+            limits[range] = _mm_set1_epi8(static_cast<char>(ranges[range].last - ranges[range].first));
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const __m128i block = load_block(input.data() + i);
+            __m128i in_class = _mm_setzero_si128();
+            for (size_t range = 0; range < ranges.size(); ++range) {
+                // Same check as char_range::contains(): unsigned (c - first) <= (last - first).
+                // SSE2 has no unsigned comparison, but min(offset, limit) == offset is equivalent.
+                const __m128i offset = _mm_sub_epi8(block, firsts[range]);
+                in_class = _mm_or_si128(in_class, _mm_cmpeq_epi8(_mm_min_epu8(offset, limits[range]), offset));
+            }
+            const uint32_t mismatches = ~to_bitmask(in_class) & 0xFFFF;
+            if (mismatches != 0) {
+                return limit_scan_result(input, i + std::countr_zero(mismatches));
+            }
+        }
+        if (i >= input.size()) {
+            return input.size();
+        }
+        return i + scalar::scan_while_class(input.substr(i), ranges);
+    }
+
+    __attribute__((target("sse2"))) inline size_t common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+        const size_t size = std::min(lhs.size(), rhs.size());
+        size_t i = 0;
+        for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+            const uint32_t mismatches = ~to_bitmask(_mm_cmpeq_epi8(load_block(lhs.data() + i), load_block(rhs.data() + i))) & 0xFFFF;
+            if (mismatches != 0) {
+                return i + std::countr_zero(mismatches);
+            }
+        }
+        return i + scalar::common_prefix_length(lhs.substr(i), rhs.substr(i));
+    }
+
+    __attribute__((target("sse2"))) inline size_t find_byte(std::string_view input, char needle, size_t padding) noexcept {
+        const __m128i needles = _mm_set1_epi8(needle);
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const uint32_t matches = to_bitmask(_mm_cmpeq_epi8(load_block(input.data() + i), needles));
+            if (matches != 0) {
+                return limit_find_result(input, i + std::countr_zero(matches));
+            }
+        }
+        if (i >= input.size()) {
+            return std::string_view::npos;
+        }
+        const size_t found = scalar::find_byte(input.substr(i), needle);
+        return found == std::string_view::npos ? found : i + found;
+    }
+
+    __attribute__((target("sse2"))) inline void match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept {
+        __m128i needle_blocks[MAX_MATCH_BYTES_NEEDLES];
+        for (size_t needle = 0; needle < needles.size(); ++needle) {
+            needle_blocks[needle] = _mm_set1_epi8(needles[needle]);
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, MATCH_BYTES_BLOCK_SIZE); i += MATCH_BYTES_BLOCK_SIZE) {
+            uint64_t mask = 0;
+            for (size_t part = 0; part < MATCH_BYTES_BLOCK_SIZE / BLOCK_SIZE; ++part) {
+                const __m128i block = load_block(input.data() + i + part * BLOCK_SIZE);
+                __m128i matches = _mm_setzero_si128();
+                for (size_t needle = 0; needle < needles.size(); ++needle) {
+                    matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needle_blocks[needle]));
+                }
+                mask |= static_cast<uint64_t>(to_bitmask(matches)) << (part * BLOCK_SIZE);
+            }
+            masks[i / MATCH_BYTES_BLOCK_SIZE] = limit_match_bytes_mask(input, i, mask);
+        }
+        if (i < input.size()) {
+            scalar::match_bytes(input.substr(i), needles, masks + i / MATCH_BYTES_BLOCK_SIZE);
+        }
+    }
+}
+
+namespace avx2 {
+    constexpr size_t BLOCK_SIZE = 32;
+
+    __attribute__((target("avx2"))) inline __m256i load_block(const char* data) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    }
+
+    __attribute__((target("avx2"))) inline uint32_t to_bitmask(__m256i matches) noexcept {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    }
+
+    __attribute__((target("avx2"))) inline size_t scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept {
+        __m256i firsts[MAX_CHAR_CLASS_RANGES];
+        __m256i limits[MAX_CHAR_CLASS_RANGES];
+        for (size_t range = 0; range < ranges.size(); ++range) {
+            firsts[range] = _mm256_set1_epi8(ranges[range].first);
+            limits[range] = _mm256_set1_epi8(static_cast<char>(ranges[range].last - ranges[range].first));
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const __m256i block = load_block(input.data() + i);
+            __m256i in_class = _mm256_setzero_si256();
+            for (size_t range = 0; range < ranges.size(); ++range) {
+                const __m256i offset = _mm256_sub_epi8(block, firsts[range]);
+                in_class = _mm256_or_si256(in_class, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, limits[range]), offset));
+            }
+            const uint32_t mismatches = ~to_bitmask(in_class);
+            if (mismatches != 0) {
+                return limit_scan_result(input, i + std::countr_zero(mismatches));
+            }
+        }
+        if (i >= input.size()) {
+            return input.size();
+        }
+        return i + sse2::scan_while_class(input.substr(i), ranges, padding);
+    }
+
+    __attribute__((target("avx2"))) inline size_t common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+        const size_t size = std::min(lhs.size(), rhs.size());
+        size_t i = 0;
+        for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+            const uint32_t mismatches = ~to_bitmask(_mm256_cmpeq_epi8(load_block(lhs.data() + i), load_block(rhs.data() + i)));
+            if (mismatches != 0) {
+                return i + std::countr_zero(mismatches);
+            }
+        }
+        return i + sse2::common_prefix_length(lhs.substr(i), rhs.substr(i));
+    }
+
+    __attribute__((target("avx2"))) inline size_t find_byte(std::string_view input, char needle, size_t padding) noexcept {
+        const __m256i needles = _mm256_set1_epi8(needle);
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const uint32_t matches = to_bitmask(_mm256_cmpeq_epi8(load_block(input.data() + i), needles));
+            if (matches != 0) {
+                return limit_find_result(input, i + std::countr_zero(matches));
+            }
+        }
+        if (i >= input.size()) {
+            return std::string_view::npos;
+        }
+        const size_t found = sse2::find_byte(input.substr(i), needle, padding);
+        return found == std::string_view::npos ? found : i + found;
+    }
+
+    __attribute__((target("avx2"))) inline void match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept {
+        __m256i needle_blocks[MAX_MATCH_BYTES_NEEDLES];
+        for (size_t needle = 0; needle < needles.size(); ++needle) {
+            needle_blocks[needle] = _mm256_set1_epi8(needles[needle]);
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, MATCH_BYTES_BLOCK_SIZE); i += MATCH_BYTES_BLOCK_SIZE) {
+            const __m256i low = load_block(input.data() + i);
+            const __m256i high = load_block(input.data() + i + BLOCK_SIZE);
+            __m256i low_matches = _mm256_setzero_si256();
+            __m256i high_matches = _mm256_setzero_si256();
+            for (size_t needle = 0; needle < needles.size(); ++needle) {
+                low_matches = _mm256_or_si256(low_matches, _mm256_cmpeq_epi8(low, needle_blocks[needle]));
+                high_matches = _mm256_or_si256(high_matches, _mm256_cmpeq_epi8(high, needle_blocks[needle]));
+            }
+            const uint64_t mask = static_cast<uint64_t>(to_bitmask(low_matches)) | (static_cast<uint64_t>(to_bitmask(high_matches)) << BLOCK_SIZE);
+            masks[i / MATCH_BYTES_BLOCK_SIZE] = limit_match_bytes_mask(input, i, mask);
+        }
+        if (i < input.size()) {
+            scalar::match_bytes(input.substr(i), needles, masks + i / MATCH_BYTES_BLOCK_SIZE);
+        }
+    }
+}
+
+namespace avx512bw {
+    constexpr size_t BLOCK_SIZE = 64;
+
+    __attribute__((target("avx512bw"))) inline __m512i load_block(const char* data) noexcept {
+        return _mm512_loadu_si512(data);
+    }
+
+    __attribute__((target("avx512bw"))) inline size_t scan_while_class(std::string_view input, std::span<const char_range> ranges, size_t padding) noexcept {
+        __m512i firsts[MAX_CHAR_CLASS_RANGES];
+        __m512i limits[MAX_CHAR_CLASS_RANGES];
+        for (size_t range = 0; range < ranges.size(); ++range) {
+            firsts[range] = _mm512_set1_epi8(ranges[range].first);
+            limits[range] = _mm512_set1_epi8(static_cast<char>(ranges[range].last - ranges[range].first));
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const __m512i block = load_block(input.data() + i);
+            __mmask64 in_class = 0;
+            for (size_t range = 0; range < ranges.size(); ++range) {
+                // AVX-512 has unsigned comparisons
+                in_class |= _mm512_cmple_epu8_mask(_mm512_sub_epi8(block, firsts[range]), limits[range]);
+            }
+            const uint64_t mismatches = ~static_cast<uint64_t>(in_class);
+            if (mismatches != 0) {
+                return limit_scan_result(input, i + std::countr_zero(mismatches));
+            }
+        }
+        if (i >= input.size()) {
+            return input.size();
+        }
+        return i + avx2::scan_while_class(input.substr(i), ranges, padding);
+    }
+
+    __attribute__((target("avx512bw"))) inline size_t common_prefix_length(std::string_view lhs, std::string_view rhs) noexcept {
+        const size_t size = std::min(lhs.size(), rhs.size());
+        size_t i = 0;
+        for (; i + BLOCK_SIZE <= size; i += BLOCK_SIZE) {
+            const uint64_t mismatches = ~static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(load_block(lhs.data() + i), load_block(rhs.data() + i)));
+            if (mismatches != 0) {
+                return i + std::countr_zero(mismatches);
+            }
+        }
+        return i + avx2::common_prefix_length(lhs.substr(i), rhs.substr(i));
+    }
+
+    __attribute__((target("avx512bw"))) inline size_t find_byte(std::string_view input, char needle, size_t padding) noexcept {
+        const __m512i needles = _mm512_set1_epi8(needle);
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const uint64_t matches = _mm512_cmpeq_epi8_mask(load_block(input.data() + i), needles);
+            if (matches != 0) {
+                return limit_find_result(input, i + std::countr_zero(matches));
+            }
+        }
+        if (i >= input.size()) {
+            return std::string_view::npos;
+        }
+        const size_t found = avx2::find_byte(input.substr(i), needle, padding);
+        return found == std::string_view::npos ? found : i + found;
+    }
+
+    __attribute__((target("avx512bw"))) inline void match_bytes(std::string_view input, std::span<const char> needles, uint64_t* masks, size_t padding) noexcept {
+        static_assert(BLOCK_SIZE == MATCH_BYTES_BLOCK_SIZE);
+        __m512i needle_blocks[MAX_MATCH_BYTES_NEEDLES];
+        for (size_t needle = 0; needle < needles.size(); ++needle) {
+            needle_blocks[needle] = _mm512_set1_epi8(needles[needle]);
+        }
+        size_t i = 0;
+        for (; has_block(input, padding, i, BLOCK_SIZE); i += BLOCK_SIZE) {
+            const __m512i block = load_block(input.data() + i);
+            uint64_t mask = 0;
+            for (size_t needle = 0; needle < needles.size(); ++needle) {
+                mask |= _mm512_cmpeq_epi8_mask(block, needle_blocks[needle]);
+            }
+            masks[i / BLOCK_SIZE] = limit_match_bytes_mask(input, i, mask);
+        }
+        if (i < input.size()) {
+            scalar::match_bytes(input.substr(i), needles, masks + i / BLOCK_SIZE);
+        }
+    }
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "assert.h"
+
+namespace ctpc {
+
+    /**
+     * small_vector is a dynamically sized array that stores up to INLINE_CAPACITY elements inline in the object
+     * and only falls back to a heap allocation once it grows past that.
+     *
+     * It is a middle ground between cvector (never allocates, but has a hard maximum size) and std::vector
+     * (always allocates). If most instances stay small, they never touch the heap, but the rare large instance
+     * still works.
+     *
+     * The inline storage stays uninitialized until elements are added, so T doesn't need a default constructor.
+     *
+     * small_vector is meant to be used at runtime. It can't be used in constant expressions, use cvector for that.
+     */
+    template<class T, size_t INLINE_CAPACITY>
+    class small_vector final {
+        static_assert(INLINE_CAPACITY > 0, "small_vector needs an inline capacity of at least one element. Use std::vector otherwise.");
+    public:
+        using value_type = T;
+
+        explicit small_vector() noexcept
+        : data_(inline_data_()), size_(0), capacity_(INLINE_CAPACITY) {}
+
+        explicit small_vector(std::initializer_list<T> elements)
+        : small_vector() {
+            reserve(elements.size());
+            for (const T& element : elements) {
+                emplace_back(element);
+            }
+        }
+
+        small_vector(const small_vector& rhs)
+        : small_vector() {
+            reserve(rhs.size_);
+            std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+            size_ = rhs.size_;
+        }
+
+        small_vector(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : small_vector() {
+            take_from_(std::move(rhs));
+        }
+
+        small_vector& operator=(const small_vector& rhs) {
+            if (this != &rhs) {
+                clear();
+                reserve(rhs.size_);
+                std::uninitialized_copy(rhs.begin(), rhs.end(), data_);
+                size_ = rhs.size_;
+            }
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+            if (this != &rhs) {
+                clear();
+                deallocate_();
+                take_from_(std::move(rhs));
+            }
+            return *this;
+        }
+
+        ~small_vector() {
+            clear();
+            deallocate_();
+        }
+
+        const T& operator[](size_t index) const {
+            if (index >= size_) {
+                details::throw_exception<std::runtime_error>("out of bounds");
+            }
+            return data_[index];
+        }
+
+        T& operator[](size_t index) {
+            return const_cast<T&>(const_cast<const small_vector*>(this)->operator[](index));
+        }
+
+        const T& get_unsafe(size_t index) const {
+            return data_[index];
+        }
+
+        T& get_unsafe(size_t index) {
+            return data_[index];
+        }
+
+        T& back() {
+            return *(end()-1);
+        }
+
+        const T* begin() const {
+            return data_;
+        }
+
+        T* begin() {
+            return data_;
+        }
+
+        const T* end() const {
+            return data_ + size_;
+        }
+
+        T* end() {
+            return data_ + size_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        // Returns true if the elements are stored inline, i.e. the small_vector didn't allocate.
+        bool is_inline() const {
+            return data_ == inline_data_();
+        }
+
+        template<class U>
+        void push_back(U&& elem) {
+            static_assert(std::is_convertible_v<U, T>, "Wrong argument type for small_vector::push_back");
+            emplace_back(std::forward<U>(elem));
+        }
+
+        template<class... Args>
+        T& emplace_back(Args&&... args) {
+            if (size_ == capacity_) {
+                return grow_and_emplace_back_(std::forward<Args>(args)...);
+            }
+            T* created = ::new (static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+            ++size_;
+            return *created;
+        }
+
+        void reserve(size_t capacity) {
+            if (capacity <= capacity_) {
+                return;
+            }
+            T* new_data = std::allocator<T>().allocate(capacity);
+            relocate_to_(new_data, capacity);
+        }
+
+        void pop_back() {
+            ASSERT(size_ > 0);
+            --size_;
+            std::destroy_at(data_ + size_);
+        }
+
+        void clear() {
+            std::destroy(begin(), end());
+            size_ = 0;
+        }
+
+    private:
+        const T* inline_data_() const {
+            return std::launder(reinterpret_cast<const T*>(inline_storage_));
+        }
+
+        T* inline_data_() {
+            return std::launder(reinterpret_cast<T*>(inline_storage_));
+        }
+
+        template<class... Args>
+        T& grow_and_emplace_back_(Args&&... args) {
+            const size_t new_capacity = 2 * capacity_;
+            T* new_data = std::allocator<T>().allocate(new_capacity);
+
+            // Construct the new element before moving the existing ones, because args might reference an existing element.
+            T* created;
+#if CTPC_HAS_EXCEPTIONS
+            try {
+                created = ::new (static_cast<void*>(new_data + size_)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                std::allocator<T>().deallocate(new_data, new_capacity);
+                throw;
+            }
+            try {
+                copy_or_move_to_(new_data);
+            } catch (...) {
+                std::destroy_at(created);
+                std::allocator<T>().deallocate(new_data, new_capacity);
+                throw;
+            }
+#else
+            created = ::new (static_cast<void*>(new_data + size_)) T(std::forward<Args>(args)...);
+            copy_or_move_to_(new_data);
+#endif
+            adopt_(new_data, new_capacity);
+            ++size_;
+            return *created;
+        }
+
+        // Move all elements to new_data, which must be a heap allocation with the given capacity, and take ownership of it.
+        // If that throws, new_data is freed and *this stays unchanged.
+        void relocate_to_(T* new_data, size_t new_capacity) {
+#if CTPC_HAS_EXCEPTIONS
+            try {
+                copy_or_move_to_(new_data);
+            } catch (...) {
+                std::allocator<T>().deallocate(new_data, new_capacity);
+                throw;
+            }
+#else
+            copy_or_move_to_(new_data);
+#endif
+            adopt_(new_data, new_capacity);
+        }
+
+        // Like std::vector, elements are only moved if that can't throw (or they can't be copied), so that a throwing
+        // copy leaves the original elements intact. On a throw, the elements constructed so far are destroyed again.
+        void copy_or_move_to_(T* new_data) {
+            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+                std::uninitialized_move(begin(), end(), new_data);
+            } else {
+                std::uninitialized_copy(begin(), end(), new_data);
+            }
+        }
+
+        // Destroy the old elements and switch to new_data, which already holds copies of them.
+        void adopt_(T* new_data, size_t new_capacity) {
+            std::destroy(begin(), end());
+            deallocate_();
+            data_ = new_data;
+            capacity_ = new_capacity;
+        }
+
+        // Free the heap allocation, if any, and go back to the inline storage. Expects all elements to be destroyed already.
+        void deallocate_() {
+            if (!is_inline()) {
+                std::allocator<T>().deallocate(data_, capacity_);
+                data_ = inline_data_();
+                capacity_ = INLINE_CAPACITY;
+            }
+        }
+
+        // Expects *this to be empty and to use the inline storage. Leaves rhs empty.
+        void take_from_(small_vector&& rhs) {
+            if (rhs.is_inline()) {
+                std::uninitialized_move(rhs.begin(), rhs.end(), data_);
+                size_ = rhs.size_;
+                rhs.clear();
+            } else {
+                // rhs is on the heap, we can just steal its allocation
+                data_ = rhs.data_;
+                size_ = rhs.size_;
+                capacity_ = rhs.capacity_;
+                rhs.data_ = rhs.inline_data_();
+                rhs.size_ = 0;
+                rhs.capacity_ = INLINE_CAPACITY;
+            }
+        }
+
+        T* data_;
+        size_t size_;
+        size_t capacity_;
+        alignas(T) std::byte inline_storage_[INLINE_CAPACITY * sizeof(T)];
+    };
+
+}
@@ -8,6 +8,14 @@ using namespace ctpc::funcsig_parser;
 
 namespace {
 
+namespace trimmed_parameter {
+    constexpr auto parsed = trimmed(parameter())(Input{"  a: Int  ,"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().name == "a");
+    static_assert(parsed.result().type == "Int");
+    static_assert(parsed.next().input == ",");
+    static_assert(trimmed(parameter_list(compiletime_optimization))(Input{" a: Int, b: Bool "}).result().size() == 2);
+}
 namespace function_signature_success_no_params {
     constexpr auto parsed = phrase(function_signature(compiletime_optimization))(Input{"Int some_other_func()"});
     static_assert(parsed.is_success());
@@ -54,6 +62,97 @@ namespace function_signature_success_whitespaces {
     static_assert(parsed.result().parameters[1].type == "Double");
 }
 
+namespace function_signature_exact_size_two_params {
+    constexpr auto parsed = parse_exact_size<"void my_func(arg1: Int, arg2: String)">([] {return phrase(function_signature(runtime_optimization));});
+    static_assert(std::is_same_v<const ParseResult<ExactSizeFunctionSignature<2>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().return_type == "void");
+    static_assert(parsed.result().name == "my_func");
+    static_assert(parsed.result().parameters[0].name == "arg1");
+    static_assert(parsed.result().parameters[0].type == "Int");
+    static_assert(parsed.result().parameters[1].name == "arg2");
+    static_assert(parsed.result().parameters[1].type == "String");
+    static_assert(sizeof(parsed.result().parameters) == 2 * sizeof(Parameter));
+}
+namespace function_signature_exact_size_no_params {
+    constexpr auto parsed = parse_exact_size<"Int some_other_func()">([] {return phrase(function_signature(runtime_optimization));});
+    static_assert(std::is_same_v<const ParseResult<ExactSizeFunctionSignature<0>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().name == "some_other_func");
+}
+namespace function_signature_exact_size_from_compiletime_optimization {
+    constexpr auto parsed = parse_exact_size<"void my_func(arg1: Int)">([] {return phrase(function_signature(compiletime_optimization));});
+    static_assert(std::is_same_v<const ParseResult<ExactSizeFunctionSignature<1>>, decltype(parsed)>);
+    static_assert(parsed.result().parameters[0].type == "Int");
+}
+namespace function_signature_exact_size_failure {
+    constexpr auto parsed = parse_exact_size<"void my_func(arg1: Int,)">([] {return phrase(function_signature(runtime_optimization));});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == ",)");
+}
+
+namespace function_signature_table {
+    constexpr auto table = materialize<"void f1(a: Int, b: String)\nInt f2()\n  Double f3(c: Double)">([] {return phrase(function_signatures());});
+    static_assert(table.signatures.size() == 3);
+    static_assert(table.parameters.size() == 3);
+    static_assert(table.signatures[0].return_type == "void");
+    static_assert(table.signatures[0].name == "f1");
+    static_assert(table.parameters_of(table.signatures[0]).size() == 2);
+    static_assert(table.parameters_of(table.signatures[0])[1].name == "b");
+    static_assert(table.parameters_of(table.signatures[0])[1].type == "String");
+    static_assert(table.signatures[1].name == "f2");
+    static_assert(table.parameters_of(table.signatures[1]).size() == 0);
+    static_assert(table.find("f3")->return_type == "Double");
+    static_assert(table.parameters_of(*table.find("f3"))[0].name == "c");
+    static_assert(table.find("f4") == nullptr);
+    static_assert(sizeof(table) == 3 * sizeof(FlatFunctionSignature) + 3 * sizeof(Parameter));
+}
+namespace function_signature_table_failure {
+    constexpr auto parsed = parse_exact_size<"void f1(a: Int)\nInt f2(">([] {return phrase(function_signatures());});
+    static_assert(parsed.is_failure());
+}
+
+constinit auto signature_registry = materialize<"void f1(a: Int, b: String)\nInt f2()">([] {return phrase(function_signatures());});
+
+TEST(FunctionSignatureTest, table_constinit) {
+    const FlatFunctionSignature* found = signature_registry.find("f1");
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ("void", found->return_type);
+    EXPECT_EQ(2, signature_registry.parameters_of(*found).size());
+    EXPECT_EQ("a", signature_registry.parameters_of(*found)[0].name);
+    EXPECT_EQ("String", signature_registry.parameters_of(*found)[1].type);
+    EXPECT_EQ(nullptr, signature_registry.find("f3"));
+}
+
+TEST(FunctionSignatureTest, hybrid_success_inline_params) {
+    auto parsed = phrase(function_signature(hybrid_optimization))(Input{"void my_func(arg1: Int, arg2: String)"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ("void", parsed.result().return_type);
+    EXPECT_EQ("my_func", parsed.result().name);
+    EXPECT_TRUE(parsed.result().parameters.is_inline());
+    EXPECT_EQ(2, parsed.result().parameters.size());
+    EXPECT_EQ("arg1", parsed.result().parameters[0].name);
+    EXPECT_EQ("Int", parsed.result().parameters[0].type);
+    EXPECT_EQ("arg2", parsed.result().parameters[1].name);
+    EXPECT_EQ("String", parsed.result().parameters[1].type);
+}
+TEST(FunctionSignatureTest, hybrid_success_more_params_than_inline) {
+    auto parsed = phrase(function_signature(hybrid_optimization))(Input{"void my_func(a0: T0, a1: T1, a2: T2, a3: T3, a4: T4, a5: T5)"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ("my_func", parsed.result().name);
+    EXPECT_FALSE(parsed.result().parameters.is_inline());
+    EXPECT_EQ(6, parsed.result().parameters.size());
+    EXPECT_EQ("a0", parsed.result().parameters[0].name);
+    EXPECT_EQ("T0", parsed.result().parameters[0].type);
+    EXPECT_EQ("a5", parsed.result().parameters[5].name);
+    EXPECT_EQ("T5", parsed.result().parameters[5].type);
+}
+TEST(FunctionSignatureTest, hybrid_failure) {
+    auto parsed = function_signature(hybrid_optimization)(Input{"void my_func(arg1: type, arg2: String,)"});
+    EXPECT_TRUE(parsed.is_failure());
+    EXPECT_EQ(",)", parsed.next().input);
+}
+
 namespace function_signature_failure_returntype {
     constexpr auto parsed = function_signature(compiletime_optimization)(Input{"-invalid- my_func(arg1: Int, arg2: String)"});
     static_assert(parsed.is_failure());
@@ -0,0 +1,94 @@
+#include "funcsig_parser/indexed.h"
+#include "parsers/phrase.h"
+
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+using namespace ctpc::funcsig_parser;
+
+namespace {
+
+namespace indexed_temporary_index_doesnt_compile {
+    // The parsers keep a reference to the index
+    template<class Index> concept can_parse_signature = requires (Index&& index) { indexed_function_signature(std::forward<Index>(index), runtime_optimization); };
+    template<class Index> concept can_parse_signatures = requires (Index&& index) { indexed_function_signatures(std::forward<Index>(index)); };
+    template<class Index> concept can_parse_parameters = requires (Index&& index) { indexed_parameter_list(std::forward<Index>(index), hybrid_optimization); };
+    static_assert(can_parse_signature<const structural_index&> && !can_parse_signature<structural_index>);
+    static_assert(can_parse_signatures<const structural_index&> && !can_parse_signatures<structural_index>);
+    static_assert(can_parse_parameters<const structural_index&> && !can_parse_parameters<structural_index>);
+}
+
+namespace indexed_success_two_params {
+    constexpr bool check() {
+        constexpr std::string_view text = "Int  my_other_func  (  arg1  :  String  ,  arg2  :  Double  )";
+        const structural_index index(Input{text}, ",()\n");
+        const auto parsed = phrase(indexed_function_signature(index, compiletime_optimization))(Input{text});
+        return parsed.is_success() && parsed.result().name == "my_other_func" && parsed.result().parameters.size() == 2
+            && parsed.result().parameters[0].name == "arg1" && parsed.result().parameters[0].type == "String"
+            && parsed.result().parameters[1].name == "arg2" && parsed.result().parameters[1].type == "Double";
+    }
+    static_assert(check());
+}
+namespace indexed_success_no_params {
+    constexpr bool check() {
+        constexpr std::string_view text = "Int f( )";
+        const structural_index index(Input{text}, ",()\n");
+        const auto parsed = phrase(indexed_function_signature(index, compiletime_optimization))(Input{text});
+        return parsed.is_success() && parsed.result().parameters.size() == 0;
+    }
+    static_assert(check());
+}
+namespace indexed_failure_noarg3aftercomma {
+    constexpr bool check() {
+        constexpr std::string_view text = "void my_func(arg1: type, arg2: String,)";
+        const structural_index index(Input{text}, ",()\n");
+        return indexed_function_signature(index, compiletime_optimization)(Input{text}).is_failure();
+    }
+    static_assert(check());
+}
+
+void expect_same_as_unindexed(std::string_view text) {
+    const structural_index index = signature_structural_index(Input{text});
+    auto expected = function_signature(hybrid_optimization)(Input{text});
+    auto actual = indexed_function_signature(index, hybrid_optimization)(Input{text});
+    ASSERT_EQ(expected.status(), actual.status()) << text;
+    if (expected.is_success()) {
+        EXPECT_EQ(expected.next().input, actual.next().input) << text;
+        EXPECT_EQ(expected.result().name, actual.result().name);
+        ASSERT_EQ(expected.result().parameters.size(), actual.result().parameters.size());
+        for (size_t i = 0; i < expected.result().parameters.size(); ++i) {
+            EXPECT_EQ(expected.result().parameters[i].name, actual.result().parameters[i].name);
+            EXPECT_EQ(expected.result().parameters[i].type, actual.result().parameters[i].type);
+        }
+    }
+}
+
+TEST(IndexedTest, sameResultsAsUnindexed) {
+    expect_same_as_unindexed("void f()");
+    expect_same_as_unindexed("void my_func(arg1: Int, arg2: String)");
+    expect_same_as_unindexed("void my_func(a0: T0, a1: T1, a2: T2, a3: T3, a4: T4, a5: T5)");
+    expect_same_as_unindexed("Int  my_other_func  (  arg1  :  String  ,  arg2  :  Double  )  rest");
+    expect_same_as_unindexed("void my_func(arg1: type arg2: String)");
+    expect_same_as_unindexed("void my_func(arg1: type, arg2: String");
+    expect_same_as_unindexed("-invalid- my_func(arg1: Int)");
+}
+
+TEST(IndexedTest, manySignatures) {
+    std::string text;
+    for (size_t i = 0; i < 1000; ++i) {
+        text += "void f" + std::to_string(i) + "(a: Int, b: String)\n";
+    }
+    text += "Int last()";
+    const structural_index index = signature_structural_index(Input{text});
+    auto expected = phrase(function_signatures())(Input{text});
+    auto actual = phrase(indexed_function_signatures(index))(Input{text});
+    ASSERT_TRUE(expected.is_success());
+    ASSERT_TRUE(actual.is_success());
+    ASSERT_EQ(1001, actual.result().size());
+    for (size_t i = 0; i < actual.result().size(); ++i) {
+        EXPECT_EQ(expected.result()[i].name, actual.result()[i].name);
+        EXPECT_EQ(expected.result()[i].parameters.size(), actual.result()[i].parameters.size());
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+#include "funcsig_parser/lazy.h"
+#include "parsers/phrase.h"
+
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+using namespace ctpc::funcsig_parser;
+
+namespace {
+
+namespace lazy_success_two_params {
+    constexpr bool check() {
+        auto parsed = phrase(lazy_function_signature(compiletime_optimization))(Input{"Int  my_other_func  (  arg1  :  String  ,  arg2  :  Double  )"});
+        if (!parsed.is_success() || parsed.result().return_type != "Int" || parsed.result().name != "my_other_func" || parsed.result().parameters.is_parsed()) {
+            return false;
+        }
+        const auto& parameters = parsed.result().parameters.get();
+        return parameters.size() == 2 && parameters[0].name == "arg1" && parameters[1].type == "Double";
+    }
+    static_assert(check());
+}
+namespace lazy_success_no_params {
+    constexpr bool check() {
+        auto parsed = phrase(lazy_function_signature(compiletime_optimization))(Input{"Int f( )"});
+        return parsed.is_success() && parsed.result().parameters.get().size() == 0;
+    }
+    static_assert(check());
+}
+namespace lazy_failure_noarg3aftercomma {
+    // The parentheses are balanced, so the error only shows up when accessing the parameters
+    constexpr bool check() {
+        auto parsed = lazy_function_signature(compiletime_optimization)(Input{"void my_func(arg1: type, arg2: String,)"});
+        return parsed.is_success() && parsed.result().parameters.parse().is_failure();
+    }
+    static_assert(check());
+}
+namespace lazy_failure_unbalanced {
+    constexpr auto parsed = lazy_function_signature(compiletime_optimization)(Input{"void my_func(arg1: type"});
+    static_assert(parsed.is_failure());
+}
+
+TEST(LazyTest, manySignatures) {
+    std::string text;
+    for (size_t i = 0; i < 1000; ++i) {
+        text += "void f" + std::to_string(i) + "(a: Int, b: String)\n";
+    }
+    text += "Int last()";
+    auto expected = phrase(function_signatures())(Input{text});
+    auto actual = phrase(lazy_function_signatures())(Input{text});
+    ASSERT_TRUE(expected.is_success());
+    ASSERT_TRUE(actual.is_success());
+    ASSERT_EQ(1001, actual.result().size());
+    for (size_t i = 0; i < actual.result().size(); ++i) {
+        EXPECT_EQ(expected.result()[i].name, actual.result()[i].name);
+        const auto& parameters = actual.result()[i].parameters.get();
+        ASSERT_EQ(expected.result()[i].parameters.size(), parameters.size());
+        for (size_t j = 0; j < parameters.size(); ++j) {
+            EXPECT_EQ(expected.result()[i].parameters[j].name, parameters[j].name);
+            EXPECT_EQ(expected.result()[i].parameters[j].type, parameters[j].type);
+        }
+    }
+}
+
+}
@@ -0,0 +1,113 @@
+#include "funcsig_parser/tokens.h"
+#include "parsers/phrase.h"
+
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+using namespace ctpc::funcsig_parser;
+
+namespace {
+
+namespace tokens_lexer {
+    constexpr bool check() {
+        const auto lexed = signature_lexer()(Input{"void f(a: Int)"});
+        if (!lexed.is_success() || lexed.result().size() != 7) {
+            return false;
+        }
+        const std::array<TokenKind, 7> expected_kinds = {TokenKind::IDENTIFIER, TokenKind::IDENTIFIER, TokenKind::LPAREN, TokenKind::IDENTIFIER, TokenKind::COLON, TokenKind::IDENTIFIER, TokenKind::RPAREN};
+        const std::array<std::string_view, 7> expected_texts = {"void", "f", "(", "a", ":", "Int", ")"};
+        for (size_t i = 0; i < 7; ++i) {
+            if (lexed.result()[i].kind != expected_kinds[i] || lexed.result()[i].text() != expected_texts[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(check());
+}
+namespace tokens_success_no_params {
+    constexpr auto parsed = phrase(tokenized_function_signature(compiletime_optimization))(Input{"Int  some_other_func  (  )"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().return_type == "Int");
+    static_assert(parsed.result().name == "some_other_func");
+    static_assert(parsed.result().parameters.size() == 0);
+}
+namespace tokens_success_two_params {
+    constexpr auto parsed = phrase(tokenized_function_signature(compiletime_optimization))(Input{"Int  my_other_func  (  arg1  :  String  ,  arg2  :  Double  )"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().return_type == "Int");
+    static_assert(parsed.result().name == "my_other_func");
+    static_assert(parsed.result().parameters.size() == 2);
+    static_assert(parsed.result().parameters[0].name == "arg1");
+    static_assert(parsed.result().parameters[0].type == "String");
+    static_assert(parsed.result().parameters[1].name == "arg2");
+    static_assert(parsed.result().parameters[1].type == "Double");
+}
+namespace tokens_failure_noarg3aftercomma {
+    constexpr auto parsed = tokenized_function_signature(compiletime_optimization)(Input{"void my_func(arg1: type, arg2: String,)"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == ",)");
+}
+namespace tokens_failure_invalid_character {
+    constexpr auto parsed = tokenized_function_signature(compiletime_optimization)(Input{"void my_func(-invalid-: Int)"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "-invalid-: Int)");
+}
+namespace tokens_exact_size {
+    constexpr auto parsed = parse_exact_size<"void my_func(arg1: Int, arg2: String)">([] {return phrase(tokenized_function_signature(runtime_optimization));});
+    static_assert(std::is_same_v<const ParseResult<ExactSizeFunctionSignature<2>>, decltype(parsed)>);
+    static_assert(parsed.result().parameters[1].type == "String");
+}
+namespace tokens_table {
+    constexpr auto table = materialize<"void f1(a: Int, b: String)\nInt f2()\n  Double f3(c: Double)">([] {return phrase(tokenized_function_signatures());});
+    static_assert(table.signatures.size() == 3);
+    static_assert(table.parameters.size() == 3);
+    static_assert(table.parameters_of(table.signatures[0])[1].type == "String");
+    static_assert(table.find("f3")->return_type == "Double");
+}
+
+// Both parsers have to give the same results
+void expect_same_as_single_stage(std::string_view input) {
+    auto expected = function_signature(hybrid_optimization)(Input{input});
+    auto actual = tokenized_function_signature(hybrid_optimization)(Input{input});
+    ASSERT_EQ(expected.status(), actual.status()) << input;
+    if (expected.is_success()) {
+        EXPECT_EQ(expected.next().input, actual.next().input) << input;
+        EXPECT_EQ(expected.result().return_type, actual.result().return_type);
+        EXPECT_EQ(expected.result().name, actual.result().name);
+        ASSERT_EQ(expected.result().parameters.size(), actual.result().parameters.size());
+        for (size_t i = 0; i < expected.result().parameters.size(); ++i) {
+            EXPECT_EQ(expected.result().parameters[i].name, actual.result().parameters[i].name);
+            EXPECT_EQ(expected.result().parameters[i].type, actual.result().parameters[i].type);
+        }
+    }
+}
+
+TEST(TokensTest, sameResultsAsSingleStage) {
+    expect_same_as_single_stage("void f()");
+    expect_same_as_single_stage("void my_func(arg1: Int, arg2: String)");
+    expect_same_as_single_stage("void my_func(a0: T0, a1: T1, a2: T2, a3: T3, a4: T4, a5: T5)");
+    expect_same_as_single_stage("Int  my_other_func  (  arg1  :  String  ,  arg2  :  Double  )  rest");
+    expect_same_as_single_stage("void my_func(arg1: type arg2: String)");
+    expect_same_as_single_stage("void my_func(arg1: type, arg2: String");
+    expect_same_as_single_stage("-invalid- my_func(arg1: Int)");
+}
+
+TEST(TokensTest, manySignatures) {
+    std::string input;
+    for (size_t i = 0; i < 1000; ++i) {
+        input += "void f" + std::to_string(i) + "(a: Int, b: String)\n";
+    }
+    input += "Int last()";
+    auto expected = phrase(function_signatures())(Input{input});
+    auto actual = phrase(tokenized_function_signatures())(Input{input});
+    ASSERT_TRUE(expected.is_success());
+    ASSERT_TRUE(actual.is_success());
+    ASSERT_EQ(1001, actual.result().size());
+    for (size_t i = 0; i < actual.result().size(); ++i) {
+        EXPECT_EQ(expected.result()[i].name, actual.result()[i].name);
+        EXPECT_EQ(expected.result()[i].parameters.size(), actual.result()[i].parameters.size());
+    }
+}
+
+}
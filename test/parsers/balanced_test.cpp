@@ -0,0 +1,128 @@
+#include "parsers/balanced.h"
+#include "parsers/padded_input.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace ctpc;
+
+namespace {
+
+namespace test_skip_balanced {
+    constexpr auto parsed = skip_balanced('(', ')')(Input{"(a, (b, (c)), d) e)"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == "a, (b, (c)), d");
+    static_assert(parsed.next().input == " e)");
+}
+namespace test_skip_balanced_empty {
+    constexpr auto parsed = skip_balanced('[', ']')(Input{"[]x"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == "");
+    static_assert(parsed.next().input == "x");
+}
+namespace test_skip_balanced_other_brackets {
+    constexpr auto parsed = skip_balanced('<', '>')(Input{"<a(b>c>"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == "a(b");
+}
+namespace test_skip_balanced_no_opener {
+    constexpr auto parsed = skip_balanced('(', ')')(Input{"a(b)"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "a(b)");
+}
+namespace test_skip_balanced_unbalanced {
+    constexpr auto parsed = skip_balanced('(', ')')(Input{"(a(b)"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "(a(b)");
+}
+namespace test_skip_balanced_partial {
+    constexpr auto parsed = skip_balanced<PartialInput>('(', ')')(PartialInput{"(a(b)", 0, true});
+    static_assert(parsed.is_need_more());
+    static_assert(parsed.next().input == "(a(b)");
+
+    constexpr auto parsed_empty = skip_balanced<PartialInput>('(', ')')(PartialInput{"", 0, true});
+    static_assert(parsed_empty.is_need_more());
+
+    // Once the closer is found, more input doesn't change the result
+    constexpr auto parsed_complete = skip_balanced<PartialInput>('(', ')')(PartialInput{"(a(b))", 0, true});
+    static_assert(parsed_complete.is_success());
+    static_assert(parsed_complete.result() == "a(b)");
+}
+namespace test_skip_balanced_quotes {
+    constexpr auto parsed = skip_balanced('{', '}', '"')(Input{R"({"a": "}", "b": {"{": 1}} x)"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == R"("a": "}", "b": {"{": 1})");
+    static_assert(parsed.next().input == " x");
+
+    constexpr auto parsed_without_quotes = skip_balanced('{', '}')(Input{R"({"a": "}", "b": {"{": 1}} x)"});
+    static_assert(parsed_without_quotes.is_success());
+    static_assert(parsed_without_quotes.result() == R"("a": ")");
+}
+
+// Finds the matching closer byte by byte
+size_t expected_balanced_end(const std::string& text, char quote) {
+    size_t depth = 0;
+    bool in_quotes = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == quote) {
+            in_quotes = !in_quotes;
+        } else if (!in_quotes && text[i] == '(') {
+            ++depth;
+        } else if (!in_quotes && text[i] == ')' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+// Deeply nested text with brackets in quotes, whose closer is at the end
+std::string nested_text(size_t size) {
+    std::string text = "(";
+    size_t depth = 1;
+    for (size_t i = 0; text.size() < size; ++i) {
+        if (i % 5 == 0) {
+            text += "(x \")\" ";
+            ++depth;
+        } else if (i % 3 == 0 && depth > 1) {
+            text += "y) ";
+            --depth;
+        } else {
+            text += "z(w)";
+        }
+    }
+    return text + std::string(depth, ')') + " rest";
+}
+
+TEST(BalancedTest, sameAsScalarScan) {
+    for (cpu_level level : {cpu_level::SCALAR, cpu_level::SSE2, cpu_level::AVX2, cpu_level::AVX512BW}) {
+        if (level > detect_cpu_level()) {
+            continue;
+        }
+        kernels::force_cpu_level(level);
+        // Sizes around the chunk and block boundaries
+        for (size_t size : {10, 63, 64, 65, 200, 1000, 5000, 100000}) {
+            const std::string text = nested_text(size);
+            const size_t end = expected_balanced_end(text, '"');
+            ASSERT_NE(std::string::npos, end);
+            const padded_input padded = padded_input::copy_from(text);
+            const auto parsed = skip_balanced<PaddedInput>('(', ')', '"')(padded.input());
+            ASSERT_TRUE(parsed.is_success()) << size;
+            EXPECT_EQ(std::string_view(text).substr(1, end - 1), parsed.result()) << size;
+            EXPECT_EQ(" rest", parsed.next().input) << size;
+
+            // Without the last closer, the brackets don't balance
+            const std::string unbalanced = text.substr(0, end);
+            EXPECT_TRUE(skip_balanced('(', ')', '"')(Input{unbalanced}).is_failure()) << size;
+        }
+    }
+    kernels::reset_cpu_level();
+}
+
+TEST(BalancedTest, deepNesting) {
+    const std::string text = std::string(100000, '[') + std::string(100000, ']');
+    const auto parsed = skip_balanced('[', ']')(Input{text});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(text.size() - 2, parsed.result().size());
+    EXPECT_EQ("", parsed.next().input);
+}
+
+}
@@ -7,7 +7,7 @@ namespace {
 namespace test_success {
     constexpr auto parsed = success()(Input{"sometext"});
     static_assert(parsed.is_success());
-    static_assert(parsed.result() == nullptr);
+    static_assert(parsed.result() == unit{});
     static_assert(parsed.next().input == "sometext");
 }
 namespace test_failure {
@@ -0,0 +1,253 @@
+#include "parsers/binary.h"
+#include "parsers/integer.h"
+#include "parsers/elem.h"
+#include "parsers/map.h"
+#include "parsers/phrase.h"
+#include "parsers/recognize.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include "testutils/error_parser.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+
+using namespace ctpc;
+
+namespace {
+
+template<class... Bytes>
+constexpr std::array<std::byte, sizeof...(Bytes)> make_bytes(Bytes... bytes) {
+    return {static_cast<std::byte>(bytes)...};
+}
+
+constexpr PartialBinaryInput partial(std::span<const std::byte> input) {
+    return PartialBinaryInput{input, 0, true};
+}
+
+namespace test_le {
+    constexpr auto input = make_bytes(0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xFF);
+    static_assert(le<uint8_t>()(BinaryInput{input}).result() == 0x01);
+    static_assert(le<uint16_t>()(BinaryInput{input}).result() == 0x0201);
+    static_assert(le<uint32_t>()(BinaryInput{input}).result() == 0x04030201);
+    static_assert(le<uint64_t>()(BinaryInput{input}).result() == 0x0807060504030201);
+    static_assert(le<uint32_t>()(BinaryInput{input}).next().input.size() == 5);
+    static_assert(le<int8_t>()(BinaryInput{input}.advance(8)).result() == -1);
+}
+namespace test_be {
+    constexpr auto input = make_bytes(0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08);
+    static_assert(be<uint16_t>()(BinaryInput{input}).result() == 0x0102);
+    static_assert(be<uint32_t>()(BinaryInput{input}).result() == 0x01020304);
+    static_assert(be<uint64_t>()(BinaryInput{input}).result() == 0x0102030405060708);
+    static_assert(be<int16_t>()(BinaryInput{make_bytes(0xFF, 0xFE)}).result() == -2);
+}
+namespace test_fixed_width_float {
+    constexpr auto input = make_bytes(0x00, 0x00, 0xC0, 0x3F);
+    static_assert(le<float>()(BinaryInput{input}).result() == 1.5f);
+    static_assert(be<double>()(BinaryInput{make_bytes(0x40, 0x09, 0x21, 0xFB, 0x54, 0x44, 0x2D, 0x18)}).result() == 3.141592653589793);
+}
+namespace test_fixed_width_too_short {
+    constexpr auto input = make_bytes(0x01, 0x02, 0x03);
+    static_assert(le<uint32_t>()(BinaryInput{input}).is_failure());
+    static_assert(le<uint32_t, PartialBinaryInput>()(partial(input)).is_need_more());
+    static_assert(be<uint16_t, PartialBinaryInput>()(partial(input)).is_success());
+}
+
+namespace test_uleb128 {
+    static_assert(uleb128()(BinaryInput{make_bytes(0x00)}).result() == 0);
+    static_assert(uleb128()(BinaryInput{make_bytes(0x7F)}).result() == 127);
+    static_assert(uleb128()(BinaryInput{make_bytes(0x80, 0x01)}).result() == 128);
+    static_assert(uleb128()(BinaryInput{make_bytes(0xE5, 0x8E, 0x26, 0xFF)}).result() == 624485);
+    static_assert(uleb128()(BinaryInput{make_bytes(0xE5, 0x8E, 0x26, 0xFF)}).next().input.size() == 1);
+    static_assert(uleb128()(BinaryInput{make_bytes(0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01)}).result() == UINT64_MAX);
+    // Doesn't fit into 64 bits
+    static_assert(uleb128()(BinaryInput{make_bytes(0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02)}).is_failure());
+    static_assert(uleb128()(BinaryInput{make_bytes(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00)}).is_failure());
+    // Truncated
+    static_assert(uleb128()(BinaryInput{make_bytes(0x80, 0x80)}).is_failure());
+    static_assert(uleb128<PartialBinaryInput>()(partial(make_bytes(0x80, 0x80))).is_need_more());
+    static_assert(uleb128()(BinaryInput{}).is_failure());
+}
+namespace test_sleb128 {
+    static_assert(sleb128()(BinaryInput{make_bytes(0x00)}).result() == 0);
+    static_assert(sleb128()(BinaryInput{make_bytes(0x02)}).result() == 2);
+    static_assert(sleb128()(BinaryInput{make_bytes(0x7E)}).result() == -2);
+    static_assert(sleb128()(BinaryInput{make_bytes(0xFF, 0x00)}).result() == 127);
+    static_assert(sleb128()(BinaryInput{make_bytes(0x80, 0x7F)}).result() == -128);
+    static_assert(sleb128()(BinaryInput{make_bytes(0xC0, 0xBB, 0x78)}).result() == -123456);
+    static_assert(sleb128()(BinaryInput{make_bytes(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x7F)}).result() == INT64_MIN);
+    static_assert(sleb128()(BinaryInput{make_bytes(0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00)}).result() == INT64_MAX);
+    static_assert(sleb128()(BinaryInput{make_bytes(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01)}).is_failure());
+    static_assert(sleb128<PartialBinaryInput>()(partial(make_bytes(0xC0))).is_need_more());
+}
+
+namespace test_bytes {
+    constexpr auto input = make_bytes(0x01, 0x02, 0x03);
+    constexpr auto parsed = bytes(2)(BinaryInput{input});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().data() == input.data());
+    static_assert(parsed.result().size() == 2);
+    static_assert(parsed.next().input.size() == 1);
+    static_assert(bytes(4)(BinaryInput{input}).is_failure());
+    static_assert(bytes<PartialBinaryInput>(4)(partial(input)).is_need_more());
+    static_assert(bytes(0)(BinaryInput{}).is_success());
+}
+
+namespace test_magic {
+    constexpr auto input = make_bytes(0x7F, 'E', 'L', 'F', 0x02);
+    static_assert(magic("\x7F" "ELF")(BinaryInput{input}).is_success());
+    static_assert(magic("\x7F" "ELF")(BinaryInput{input}).next().input.size() == 1);
+    static_assert(magic(make_bytes(0x7F, 'E'))(BinaryInput{input}).is_success());
+    static_assert(magic("\x7F" "ELG")(BinaryInput{input}).is_failure());
+    static_assert(magic("\x7F" "ELF")(BinaryInput{std::span<const std::byte>(input).first(2)}).is_failure());
+    static_assert(magic<PartialBinaryInput>("\x7F" "ELF")(partial(std::span<const std::byte>(input).first(2))).is_need_more());
+    // A mismatch is a failure even if the input is partial
+    static_assert(magic<PartialBinaryInput>("\x7F" "XY")(partial(std::span<const std::byte>(input).first(2))).is_failure());
+}
+
+namespace test_length_prefixed {
+    constexpr auto input = make_bytes(0x00, 0x03, 'a', 'b', 'c', 'd');
+    constexpr auto parsed = length_prefixed(be<uint16_t>())(BinaryInput{input});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().data() == input.data() + 2);
+    static_assert(parsed.result().size() == 3);
+    static_assert(parsed.next().input.size() == 1);
+    static_assert(length_prefixed(be<uint16_t>())(BinaryInput{make_bytes(0x00, 0x05, 'a')}).is_failure());
+    static_assert(length_prefixed(be<uint16_t, PartialBinaryInput>())(partial(make_bytes(0x00, 0x05, 'a'))).is_need_more());
+    static_assert(length_prefixed(be<uint16_t, PartialBinaryInput>())(partial(make_bytes(0x00))).is_need_more());
+    static_assert(length_prefixed(le<int8_t>())(BinaryInput{make_bytes(0xFF, 'a')}).is_failure());
+}
+namespace test_length_prefixed_text {
+    // netstrings, e.g. "5:hello,"
+    constexpr auto netstring = seq(length_prefixed(map(seq(integer(), elem(':')), [] (auto&& v) {return std::get<0>(v);})), elem(','));
+    constexpr auto parsed = netstring(Input{"5:hello,rest"});
+    static_assert(parsed.is_success());
+    static_assert(std::get<0>(parsed.result()) == "hello");
+    static_assert(parsed.next().input == "rest");
+    static_assert(netstring(Input{"-1:,"}).is_failure());
+}
+namespace test_length_prefixed_body {
+    constexpr auto input = make_bytes(0x04, 0x01, 0x00, 0x02, 0x00, 0xAA);
+    constexpr auto body = rep(compiletime_optimization, le<uint16_t>());
+    constexpr auto parsed = length_prefixed(uleb128(), body)(BinaryInput{input});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().size() == 2);
+    static_assert(parsed.result()[1] == 2);
+    static_assert(parsed.next().input.size() == 1);
+
+    // The body can't read beyond the frame, even though the input continues
+    static_assert(length_prefixed(uleb128(), le<uint32_t>())(BinaryInput{make_bytes(0x02, 0x01, 0x00, 0x02, 0x00)}).is_failure());
+    // The body has to consume the whole frame
+    static_assert(length_prefixed(uleb128(), le<uint16_t>())(BinaryInput{input}).is_failure());
+    // The body is complete, even if the input is partial
+    constexpr auto partial_body = rep(compiletime_optimization, le<uint16_t, PartialBinaryInput>());
+    static_assert(length_prefixed(uleb128<PartialBinaryInput>(), partial_body)(partial(input)).is_success());
+    static_assert(length_prefixed(uleb128<PartialBinaryInput>(), partial_body)(partial(std::span<const std::byte>(input).first(4))).is_need_more());
+}
+namespace test_length_prefixed_body_error {
+    constexpr auto parsed = length_prefixed(integer(), error_parser(elem('a')))(Input{"1abc"});
+    static_assert(parsed.is_error());
+}
+namespace test_recognize_length_prefixed {
+    constexpr auto input = make_bytes(0x04, 0x01, 0x00, 0x02, 0x00, 0xAA);
+    static_assert(recognize(length_prefixed(uleb128()))(BinaryInput{input}).next().input.size() == 1);
+    static_assert(recognize(length_prefixed(uleb128(), rep(compiletime_optimization, le<uint16_t>())))(BinaryInput{input}).next().input.size() == 1);
+    static_assert(recognize(length_prefixed(uleb128(), le<uint16_t>()))(BinaryInput{input}).is_failure());
+    static_assert(recognize(aligned<4>(length_prefixed(le<uint8_t>())))(BinaryInput{make_bytes(0x02, 'a', 'b', 0x00, 0x05)}).next().input.size() == 1);
+    static_assert(recognize(aligned<4>(length_prefixed(le<uint8_t>())))(BinaryInput{input}).is_failure());
+}
+
+namespace test_aligned {
+    constexpr auto input = make_bytes(0x02, 'a', 'b', 0x00, 0x01, 'c', 0x00, 0x00, 0x05);
+    constexpr auto field = aligned<4>(length_prefixed(le<uint8_t>()));
+    constexpr auto parsed = seq(field, field, le<uint8_t>())(BinaryInput{input});
+    static_assert(parsed.is_success());
+    static_assert(std::get<0>(parsed.result()).size() == 2);
+    static_assert(std::get<1>(parsed.result()).size() == 1);
+    static_assert(std::get<2>(parsed.result()) == 5);
+    // Already aligned fields don't skip anything
+    static_assert(aligned<4>(le<uint32_t>())(BinaryInput{input}).next().input.size() == input.size() - 4);
+    // Missing padding
+    static_assert(field(BinaryInput{std::span<const std::byte>(input).subspan(4, 2)}).is_failure());
+    constexpr auto partial_field = aligned<4>(length_prefixed(le<uint8_t, PartialBinaryInput>()));
+    static_assert(partial_field(partial(std::span<const std::byte>(input).subspan(4, 3))).is_need_more());
+}
+
+// A framing protocol: magic "CT", version byte, big-endian flags, then a varint length and the payload,
+// which is a sequence of little-endian (id, value) pairs
+struct Frame final {
+    uint8_t version;
+    uint16_t flags;
+    std::vector<std::pair<uint32_t, int64_t>> entries;
+};
+
+constexpr auto frame() {
+    constexpr auto entry = map(seq(le<uint32_t>(), sleb128()), [] (auto&& v) {return std::pair<uint32_t, int64_t>(std::get<0>(v), std::get<1>(v));});
+    return map(
+        seq(magic("CT"), le<uint8_t>(), be<uint16_t>(), length_prefixed(uleb128(), rep(runtime_optimization, entry))),
+        [] (auto&& v) {return Frame{std::get<1>(v), std::get<2>(v), std::move(std::get<3>(v))};}
+    );
+}
+
+std::vector<std::byte> encode_frame(uint16_t flags, const std::vector<std::pair<uint32_t, int64_t>>& entries) {
+    std::vector<std::byte> payload;
+    for (const auto& [id, value] : entries) {
+        for (size_t i = 0; i < 4; ++i) {
+            payload.push_back(static_cast<std::byte>(id >> (8 * i)));
+        }
+        int64_t rest = value;
+        while (true) {
+            const uint8_t byte = rest & 0x7F;
+            rest >>= 7;
+            const bool done = (rest == 0 && (byte & 0x40) == 0) || (rest == -1 && (byte & 0x40) != 0);
+            payload.push_back(static_cast<std::byte>(done ? byte : byte | 0x80));
+            if (done) {
+                break;
+            }
+        }
+    }
+    std::vector<std::byte> encoded = {std::byte{'C'}, std::byte{'T'}, std::byte{1}, static_cast<std::byte>(flags >> 8), static_cast<std::byte>(flags)};
+    for (size_t size = payload.size(); true; size >>= 7) {
+        encoded.push_back(static_cast<std::byte>(size < 0x80 ? size : (size & 0x7F) | 0x80));
+        if (size < 0x80) {
+            break;
+        }
+    }
+    encoded.insert(encoded.end(), payload.begin(), payload.end());
+    return encoded;
+}
+
+TEST(BinaryTest, frames) {
+    std::vector<std::pair<uint32_t, int64_t>> entries;
+    for (int64_t i = 0; i < 100; ++i) {
+        entries.emplace_back(static_cast<uint32_t>(i * 0x01010101), (i % 2 == 0 ? 1 : -1) * i * i * i * i * i);
+    }
+    std::vector<std::byte> stream = encode_frame(0xABCD, entries);
+    const std::vector<std::byte> second = encode_frame(0x0001, {});
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    auto parsed = phrase(rep(runtime_optimization, frame()))(BinaryInput{stream});
+    ASSERT_TRUE(parsed.is_success());
+    ASSERT_EQ(2, parsed.result().size());
+    EXPECT_EQ(1, parsed.result()[0].version);
+    EXPECT_EQ(0xABCD, parsed.result()[0].flags);
+    EXPECT_EQ(entries, parsed.result()[0].entries);
+    EXPECT_EQ(0x0001, parsed.result()[1].flags);
+    EXPECT_TRUE(parsed.result()[1].entries.empty());
+}
+
+TEST(BinaryTest, unalignedLoads) {
+    std::vector<std::byte> input;
+    for (size_t i = 0; i < 64; ++i) {
+        input.push_back(static_cast<std::byte>(i));
+    }
+    for (size_t offset = 0; offset < 8; ++offset) {
+        const BinaryInput unaligned{std::span<const std::byte>(input).subspan(offset)};
+        const uint64_t expected_le = 0x0706050403020100 + offset * 0x0101010101010101;
+        EXPECT_EQ(expected_le, le<uint64_t>()(unaligned).result());
+        EXPECT_EQ(__builtin_bswap64(expected_le), be<uint64_t>()(unaligned).result());
+        EXPECT_EQ(static_cast<uint32_t>(expected_le), le<uint32_t>()(unaligned).result());
+        EXPECT_EQ(__builtin_bswap16(static_cast<uint16_t>(expected_le)), be<uint16_t>()(unaligned).result());
+    }
+}
+
+}
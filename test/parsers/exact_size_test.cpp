@@ -0,0 +1,120 @@
+#include "parsers/exact_size.h"
+#include "parsers/rep.h"
+#include "parsers/integer.h"
+#include "parsers/elem.h"
+#include "parsers/string.h"
+#include "parsers/phrase.h"
+#include "parsers/map.h"
+#include "parsers/alpha.h"
+#include "parsers/opt.h"
+#include "parsers/seq.h"
+#include "testutils/error_parser.h"
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+
+namespace {
+
+namespace test_exact_size_vector {
+    constexpr auto parsed = parse_exact_size<"1,2,3">([] {return repsep(runtime_optimization, integer(), elem(','));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int64_t, 3>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result()[0] == 1);
+    static_assert(parsed.result()[1] == 2);
+    static_assert(parsed.result()[2] == 3);
+    static_assert(parsed.next().input == "");
+}
+namespace test_exact_size_vector_empty {
+    constexpr auto parsed = parse_exact_size<"text">([] {return repsep(runtime_optimization, integer(), elem(','));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int64_t, 0>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.next().input == "text");
+}
+namespace test_exact_size_vector_partial {
+    constexpr auto parsed = parse_exact_size<"1,2,text">([] {return repsep(runtime_optimization, integer(), elem(','));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int64_t, 2>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result()[1] == 2);
+    static_assert(parsed.next().input == ",text");
+}
+namespace test_exact_size_cvector {
+    constexpr auto parsed = parse_exact_size<"1,2">([] {return repsep(compiletime_optimization, integer(), elem(','));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int64_t, 2>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result()[0] == 1);
+    static_assert(parsed.result()[1] == 2);
+}
+namespace test_exact_size_no_padding {
+    constexpr auto parsed = parse_exact_size<"1,2">([] {return repsep(runtime_optimization, integer(), elem(','));});
+    static_assert(sizeof(parsed.result()) == 2 * sizeof(int64_t));
+}
+namespace test_exact_size_nested_parser {
+    constexpr auto parsed = parse_exact_size<"a,b,c">([] {return phrase(repsep(runtime_optimization, map(alpha_small(), [] (char c) {return c - 'a';}), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int, 3>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result()[0] == 0);
+    static_assert(parsed.result()[2] == 2);
+}
+namespace test_exact_size_without_container {
+    constexpr auto parsed = parse_exact_size<"123abc">([] {return integer();});
+    static_assert(std::is_same_v<const ParseResult<int64_t>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 123);
+    static_assert(parsed.next().input == "abc");
+}
+namespace test_exact_size_failure {
+    constexpr auto parsed = parse_exact_size<"1,2,text">([] {return phrase(repsep(runtime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::array<int64_t, 0>>, decltype(parsed)>);
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == ",text");
+}
+namespace test_exact_size_error {
+    constexpr auto parsed = parse_exact_size<"1,2">([] {return error_parser(repsep(runtime_optimization, integer(), elem(',')));});
+    static_assert(parsed.is_error());
+}
+
+namespace test_exact_size_seq {
+    constexpr auto parsed = parse_exact_size<"x=1,2,3">([] {return seq(alpha(), elem('='), repsep(runtime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::tuple<char, char, std::array<int64_t, 3>>>, decltype(parsed)>);
+    static_assert(parsed.is_success());
+    static_assert(std::get<0>(parsed.result()) == 'x');
+    static_assert(std::get<2>(parsed.result())[2] == 3);
+}
+namespace test_exact_size_seq_of_containers {
+    constexpr auto parsed = parse_exact_size<"a,b;1,2,3">([] {return seq(repsep(runtime_optimization, alpha(), elem(',')), elem(';'), repsep(compiletime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::tuple<std::array<char, 2>, char, std::array<int64_t, 3>>>, decltype(parsed)>);
+    static_assert(std::get<0>(parsed.result())[1] == 'b');
+    static_assert(std::get<2>(parsed.result())[0] == 1);
+}
+namespace test_exact_size_optional {
+    constexpr auto parsed = parse_exact_size<"1,2">([] {return opt(repsep1(runtime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::optional<std::array<int64_t, 2>>>, decltype(parsed)>);
+    static_assert(parsed.result().has_value());
+    static_assert((*parsed.result())[1] == 2);
+}
+namespace test_exact_size_optional_empty {
+    constexpr auto parsed = parse_exact_size<"x">([] {return opt(repsep1(runtime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const ParseResult<std::optional<std::array<int64_t, 0>>>, decltype(parsed)>);
+    static_assert(!parsed.result().has_value());
+    static_assert(parsed.next().input == "x");
+}
+
+namespace test_materialize {
+    constexpr auto materialized = materialize<"1,2,3">([] {return phrase(repsep(runtime_optimization, integer(), elem(',')));});
+    static_assert(std::is_same_v<const std::array<int64_t, 3>, decltype(materialized)>);
+    static_assert(materialized[0] == 1);
+    static_assert(materialized[2] == 3);
+}
+
+constinit std::array<int64_t, 3> constinit_materialized = materialize<"1,2,3">([] {return phrase(repsep(runtime_optimization, integer(), elem(',')));});
+
+TEST(ExactSizeTest, usableAtRuntime) {
+    static constexpr auto parsed = parse_exact_size<"1,2,3">([] {return repsep(runtime_optimization, integer(), elem(','));});
+    EXPECT_EQ((std::array<int64_t, 3>{1, 2, 3}), parsed.result());
+}
+
+TEST(ExactSizeTest, materializeConstinit) {
+    EXPECT_EQ((std::array<int64_t, 3>{1, 2, 3}), constinit_materialized);
+}
+
+}
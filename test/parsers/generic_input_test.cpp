@@ -0,0 +1,128 @@
+#include "parsers/alternative.h"
+#include "parsers/elem.h"
+#include "parsers/map.h"
+#include "parsers/match.h"
+#include "parsers/opt.h"
+#include "parsers/phrase.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <cstddef>
+
+using namespace ctpc;
+
+namespace {
+
+using ByteInput = SpanInput<std::byte>;
+using U8Input = BasicInput<std::u8string_view>;
+
+namespace test_types {
+    static_assert(std::is_same_v<Input, parser_input_t<decltype(elem('a'))>>);
+    static_assert(std::is_same_v<ByteInput, parser_input_t<decltype(elem<ByteInput>(std::byte{1}))>>);
+    static_assert(std::is_same_v<std::byte, parser_result_t<decltype(elem<ByteInput>(std::byte{1}))>>);
+    static_assert(std::is_same_v<ByteInput, parser_input_t<decltype(rep(compiletime_optimization, elem<ByteInput>(std::byte{1})))>>);
+    static_assert(std::is_same_v<std::span<const std::byte>, parser_result_t<decltype(match(elem<ByteInput>(std::byte{1})))>>);
+}
+
+// A binary message: magic byte 0x7F, a length byte, then that many payload bytes
+constexpr auto byte_message() {
+    return flatMap(
+        seq(elem<ByteInput>(std::byte{0x7F}), elem<ByteInput>([] (std::byte) {return true;})),
+        [] (ParseResult<std::tuple<std::byte, std::byte>, ByteInput> header) {
+            if (!header.is_success()) {
+                return ParseResult<std::span<const std::byte>, ByteInput>::failure(header.next());
+            }
+            const size_t length = std::to_integer<size_t>(std::get<1>(header.result()));
+            const ByteInput payload = header.next();
+            if (payload.input.size() < length) {
+                return ParseResult<std::span<const std::byte>, ByteInput>::failure(payload);
+            }
+            return ParseResult<std::span<const std::byte>, ByteInput>::success(payload.advance(length), payload.take(length));
+        }
+    );
+}
+
+namespace test_bytes {
+    constexpr std::array<std::byte, 9> input = {std::byte{0x7F}, std::byte{2}, std::byte{0xAA}, std::byte{0xBB}, std::byte{0x7F}, std::byte{1}, std::byte{0xCC}, std::byte{0x7F}, std::byte{0}};
+    constexpr auto parsed = phrase(rep(compiletime_optimization, byte_message()))(ByteInput{input});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().size() == 3);
+    static_assert(parsed.result()[0].size() == 2);
+    static_assert(parsed.result()[0][1] == std::byte{0xBB});
+    static_assert(parsed.result()[1][0] == std::byte{0xCC});
+    static_assert(parsed.result()[2].empty());
+
+    constexpr std::array<std::byte, 3> truncated = {std::byte{0x7F}, std::byte{5}, std::byte{0xAA}};
+    static_assert(byte_message()(ByteInput{truncated}).is_failure());
+}
+
+namespace test_u8 {
+    constexpr auto parsed = seq(match(rep(compiletime_optimization, elem<U8Input>([] (char8_t c) {return c != u8',';}))), elem<U8Input>(u8','))(U8Input{u8"grüße,rest"});
+    static_assert(parsed.is_success());
+    static_assert(std::get<0>(parsed.result()) == u8"grüße");
+    static_assert(parsed.next().input == u8"rest");
+}
+
+// Tokens from a separate lexer
+enum class TokenKind {IDENTIFIER, NUMBER, PLUS, LPAREN, RPAREN};
+struct Token final {
+    TokenKind kind;
+    int64_t value;
+
+    constexpr bool operator==(const Token&) const = default;
+};
+using TokenInput = SpanInput<Token>;
+
+constexpr auto token(TokenKind kind) {
+    return elem<TokenInput>([kind] (const Token& token) {return token.kind == kind;});
+}
+
+// sum := term ('+' term)*
+// term := NUMBER | '(' NUMBER ')'
+constexpr auto sum() {
+    constexpr auto number = map(token(TokenKind::NUMBER), [] (const Token& token) {return token.value;});
+    constexpr auto term = alternative(
+        number,
+        map(seq(token(TokenKind::LPAREN), number, token(TokenKind::RPAREN)), [] (auto&& parsed) {return std::get<1>(parsed);})
+    );
+    return map(repsep1(compiletime_optimization, term, token(TokenKind::PLUS)), [] (auto&& terms) {
+        int64_t result = 0;
+        for (int64_t term : terms) {
+            result += term;
+        }
+        return result;
+    });
+}
+
+namespace test_tokens {
+    constexpr std::array<Token, 7> tokens = {
+        Token{TokenKind::NUMBER, 1}, Token{TokenKind::PLUS, 0}, Token{TokenKind::LPAREN, 0}, Token{TokenKind::NUMBER, 20},
+        Token{TokenKind::RPAREN, 0}, Token{TokenKind::PLUS, 0}, Token{TokenKind::NUMBER, 300}
+    };
+    constexpr auto parsed = phrase(sum())(TokenInput{tokens});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 321);
+
+    static_assert(opt(token(TokenKind::IDENTIFIER))(TokenInput{tokens}).result() == std::nullopt);
+    static_assert(elem<TokenInput>(Token{TokenKind::NUMBER, 1})(TokenInput{tokens}).is_success());
+    static_assert(elem<TokenInput>(Token{TokenKind::NUMBER, 2})(TokenInput{tokens}).is_failure());
+    static_assert(phrase(sum())(TokenInput{std::span<const Token>(tokens).first(2)}).is_failure());
+}
+
+TEST(GenericInputTest, runtimeTokens) {
+    std::vector<Token> tokens;
+    int64_t expected = 0;
+    for (int64_t i = 0; i < 1000; ++i) {
+        if (i != 0) {
+            tokens.push_back(Token{TokenKind::PLUS, 0});
+        }
+        tokens.push_back(Token{TokenKind::NUMBER, i});
+        expected += i;
+    }
+    auto parsed = phrase(map(repsep1(runtime_optimization, token(TokenKind::NUMBER), token(TokenKind::PLUS)), [] (auto&& terms) {return terms.size();}))(TokenInput{tokens});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(1000, parsed.result());
+}
+
+}
@@ -0,0 +1,113 @@
+#include "parsers/lazy.h"
+#include "parsers/balanced.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/recognize.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace ctpc;
+
+namespace {
+
+template<class InputT = Input>
+constexpr auto lazy_numbers() {
+    return lazy(skip_balanced<InputT>('[', ']'), repsep(compiletime_optimization, integer<InputT>(), elem<InputT>(',')));
+}
+
+namespace test_lazy_defers_parsing {
+    constexpr bool check() {
+        auto parsed = lazy_numbers()(Input{"[1,2,3] rest"});
+        if (!parsed.is_success() || parsed.next().input != " rest" || parsed.result().text() != "1,2,3" || parsed.result().is_parsed()) {
+            return false;
+        }
+        const auto& numbers = parsed.result().get();
+        return parsed.result().is_parsed() && numbers.size() == 3 && numbers[2] == 3
+            // The second access returns the cached result
+            && &parsed.result().get() == &numbers;
+    }
+    static_assert(check());
+}
+namespace test_lazy_skip_failure {
+    constexpr auto parsed = lazy_numbers()(Input{"[1,2,3"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "[1,2,3");
+
+    constexpr auto parsed_partial = lazy_numbers<PartialInput>()(PartialInput{"[1,2,3", 0, true});
+    static_assert(parsed_partial.is_need_more());
+}
+namespace test_lazy_parse_failure {
+    // The skip parser only checks the brackets, the numbers are checked on access
+    constexpr bool check() {
+        auto parsed = lazy_numbers()(Input{"[1,x,3]"});
+        return parsed.is_success() && parsed.result().parse().is_failure() && parsed.result().parse().next().input == ",x,3";
+    }
+    static_assert(check());
+}
+namespace test_lazy_in_seq {
+    constexpr bool check() {
+        auto parsed = seq(lazy_numbers(), elem(';'), lazy_numbers())(Input{"[1];[2,3]"});
+        return parsed.is_success() && std::get<0>(parsed.result()).get().size() == 1 && std::get<2>(parsed.result()).get()[1] == 3;
+    }
+    static_assert(check());
+}
+namespace test_lazy_self_assignment {
+    constexpr bool check() {
+        auto parsed = lazy_numbers()(Input{"[1,2,3]"});
+        auto& value = parsed.result();
+        value.get();
+        // Assigning through a reference, so compilers don't warn about the self-assignment
+        auto& same = value;
+        value = same;
+        value = std::move(same);
+        return value.text() == "1,2,3" && value.is_parsed() && value.get().size() == 3;
+    }
+    static_assert(check());
+}
+namespace test_recognize_lazy {
+    static_assert(recognize(lazy_numbers())(Input{"[1,x,3] rest"}).next().input == " rest");
+    static_assert(recognize(lazy_numbers())(Input{"[1,2,3"}).is_failure());
+}
+
+TEST(LazyTest, parsesOnlyOnce) {
+    size_t num_parses = 0;
+    const auto counting_parser = [&num_parses] (Input input) -> ParseResult<std::string_view> {
+        ++num_parses;
+        return ParseResult<std::string_view>::success(input.advance(input.input.size()), input.input);
+    };
+    auto parsed = lazy(skip_balanced('(', ')'), counting_parser)(Input{"(abc)"});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(0, num_parses);
+    EXPECT_EQ("abc", parsed.result().get());
+    EXPECT_EQ("abc", parsed.result().get());
+    EXPECT_EQ(1, num_parses);
+}
+
+TEST(LazyTest, selfAssignment) {
+    // The parser owns memory, so constructing it from a destructed parser would show up in sanitizer builds
+    const std::string expected(100, 'x');
+    const auto owning_parser = [expected] (Input input) -> ParseResult<bool> {
+        return ParseResult<bool>::success(input.advance(input.input.size()), input.input == expected);
+    };
+    const std::string input = "(" + expected + ")";
+    auto parsed = lazy(skip_balanced('(', ')'), owning_parser)(Input{input});
+    ASSERT_TRUE(parsed.is_success());
+    auto& value = parsed.result();
+    auto& same = value;
+    value = same;
+    EXPECT_TRUE(value.get());
+    value = std::move(same);
+    EXPECT_TRUE(value.get());
+}
+
+#if CTPC_ASSERT_LEVEL >= CTPC_ASSERT_LEVEL_DEBUG
+TEST(LazyTest, getThrowsOnFailure) {
+    auto parsed = lazy_numbers()(Input{"[1,,2]"});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_ANY_THROW(parsed.result().get());
+}
+#endif
+
+}
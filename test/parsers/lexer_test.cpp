@@ -0,0 +1,223 @@
+#include "parsers/lexer.h"
+#include "parsers/alpha.h"
+#include "parsers/alternative.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/map.h"
+#include "parsers/opt.h"
+#include "parsers/phrase.h"
+#include "parsers/recognize.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include "parsers/string.h"
+#include "testutils/error_parser.h"
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+
+namespace {
+
+enum class Kind : uint8_t {NUMBER, IDENTIFIER, PLUS, LPAREN, RPAREN};
+
+constexpr Token<Kind> make_token(Kind kind, std::string_view text) {
+    return Token<Kind>{text.data(), static_cast<uint32_t>(text.size()), kind};
+}
+
+template<class InputT = Input>
+constexpr auto arithmetic_lexer() {
+    return lexer(whitespaces<InputT>(),
+        rule(Kind::NUMBER, integer<InputT>()),
+        rule(Kind::IDENTIFIER, rep1(compiletime_optimization, alpha_small<InputT>())),
+        rule(Kind::PLUS, elem<InputT>('+')),
+        rule(Kind::LPAREN, elem<InputT>('(')),
+        rule(Kind::RPAREN, elem<InputT>(')'))
+    );
+}
+
+namespace test_lexer {
+    constexpr bool check() {
+        constexpr std::string_view input = " 12 +(ab)+3";
+        const auto lexed = arithmetic_lexer()(Input{input});
+        const std::vector<Token<Kind>> expected = {
+            make_token(Kind::NUMBER, "12"), make_token(Kind::PLUS, "+"), make_token(Kind::LPAREN, "("), make_token(Kind::IDENTIFIER, "ab"),
+            make_token(Kind::RPAREN, ")"), make_token(Kind::PLUS, "+"), make_token(Kind::NUMBER, "3")
+        };
+        // Tokens point into the input
+        return lexed.is_success() && lexed.result() == expected && lexed.result()[3].begin == input.data() + 6 && lexed.next().input == "";
+    }
+    static_assert(check());
+}
+namespace test_lexer_empty {
+    constexpr bool check() {
+        const auto lexed = arithmetic_lexer()(Input{"  "});
+        return lexed.is_success() && lexed.result().empty() && lexed.next().input == "  ";
+    }
+    static_assert(check());
+}
+namespace test_lexer_stops_at_unknown_character {
+    constexpr bool check() {
+        const auto lexed = arithmetic_lexer()(Input{"1 + 2 - 3"});
+        return lexed.is_success() && lexed.result().size() == 3 && lexed.next().input == " - 3";
+    }
+    static_assert(check());
+}
+namespace test_lexer_rules_in_order {
+    // The first matching rule wins, even if a later rule would match a longer token
+    constexpr bool check() {
+        const auto lexed = lexer(whitespaces(), rule(Kind::PLUS, elem('+')), rule(Kind::NUMBER, string("++")))(Input{"++"});
+        return lexed.is_success() && lexed.result().size() == 2 && lexed.result()[1] == make_token(Kind::PLUS, "+");
+    }
+    static_assert(check());
+}
+namespace test_lexer_empty_matches {
+    // Rules matching the empty string don't produce empty tokens, the next rule is tried instead
+    constexpr bool check() {
+        const auto lexed = lexer(whitespaces(), rule(Kind::IDENTIFIER, whitespaces()), rule(Kind::NUMBER, opt(integer())), rule(Kind::PLUS, elem('+')))(Input{"1 + 2 -"});
+        return lexed.is_success() && lexed.result().size() == 3 && lexed.result()[1] == make_token(Kind::PLUS, "+") && lexed.next().input == " -";
+    }
+    static_assert(check());
+}
+namespace test_lexer_error {
+    constexpr bool check() {
+        const auto lexed = lexer(whitespaces(), rule(Kind::PLUS, elem('+')), rule(Kind::NUMBER, error_parser(elem('-'))))(Input{"+ -"});
+        return lexed.is_error();
+    }
+    static_assert(check());
+}
+namespace test_lexer_partial {
+    constexpr bool check() {
+        // The number could continue
+        const auto lexed = arithmetic_lexer<PartialInput>()(PartialInput{"1 + 23", 0, true});
+        return lexed.is_need_more();
+    }
+    static_assert(check());
+}
+
+// sum := term ('+' term)*
+// term := NUMBER | IDENTIFIER | '(' sum ')' with one level of nesting
+constexpr auto number_or_identifier() {
+    return alternative(
+        map(token(Kind::NUMBER), [] (std::string_view text) {return static_cast<int64_t>(text.size());}),
+        map(token(Kind::IDENTIFIER), [] (std::string_view text) {return static_cast<int64_t>(text.size());})
+    );
+}
+constexpr auto sum_of_lengths() {
+    constexpr auto term = alternative(
+        number_or_identifier(),
+        map(seq(token(Kind::LPAREN), repsep1(compiletime_optimization, number_or_identifier(), token(Kind::PLUS)), token(Kind::RPAREN)), [] (auto&& parsed) {
+            int64_t result = 0;
+            for (int64_t v : std::get<1>(parsed)) {
+                result += v;
+            }
+            return result;
+        })
+    );
+    return map(repsep1(compiletime_optimization, term, token(Kind::PLUS)), [] (auto&& terms) {
+        int64_t result = 0;
+        for (int64_t v : terms) {
+            result += v;
+        }
+        return result;
+    });
+}
+
+namespace test_tokenized {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), sum_of_lengths())(Input{"123 + (ab + c) + d"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 7);
+    static_assert(parsed.next().input == "");
+}
+namespace test_tokenized_token_text {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), seq(token(Kind::IDENTIFIER), token(Kind::PLUS), token(Kind::NUMBER)))(Input{"abc  +  42"});
+    static_assert(parsed.is_success());
+    static_assert(std::get<0>(parsed.result()) == "abc");
+    static_assert(std::get<1>(parsed.result()) == "+");
+    static_assert(std::get<2>(parsed.result()) == "42");
+}
+namespace test_tokenized_consumes_up_to_last_token {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), sum_of_lengths())(Input{"1 + 2 ) + 3"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 2);
+    static_assert(parsed.next().input == " ) + 3");
+}
+namespace test_tokenized_stops_at_unlexable_text {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), sum_of_lengths())(Input{"1 + 2 - 3"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.next().input == " - 3");
+}
+namespace test_tokenized_failure {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), sum_of_lengths())(Input{"(1 + 2 + 3"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "(1 + 2 + 3");
+}
+namespace test_tokenized_failure_at_end_of_tokens {
+    constexpr auto parsed = tokenized(arithmetic_lexer(), seq(token(Kind::NUMBER), token(Kind::PLUS)))(Input{"1 - 3"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == " - 3");
+}
+namespace test_tokenized_need_more_is_error {
+    constexpr auto need_more = [] (TokenInput<Kind> input) {return ParseResult<unit, TokenInput<Kind>>::need_more(input);};
+    constexpr auto parsed = tokenized(arithmetic_lexer(), need_more)(Input{"1 + 2"});
+    static_assert(parsed.is_error());
+}
+namespace test_tokenized_only_lexes_consumed_tokens {
+    // The lexer would fail at the '-', but the token parser stops before that
+    constexpr auto error_lexer = lexer(whitespaces(), rule(Kind::NUMBER, integer()), rule(Kind::PLUS, elem('+')), rule(Kind::RPAREN, elem(')')), rule(Kind::LPAREN, error_parser(elem('-'))));
+    constexpr auto parsed = tokenized(error_lexer, sum_of_lengths())(Input{"1 + 2 ) -"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 2);
+    static_assert(parsed.next().input == " ) -");
+    static_assert(tokenized(error_lexer, sum_of_lengths())(Input{"1 + 2 + -"}).is_error());
+}
+namespace test_tokenized_partial {
+    // The number at the end could continue, but the token parser doesn't need it
+    constexpr auto parsed = tokenized(arithmetic_lexer<PartialInput>(), seq(token(Kind::NUMBER), token(Kind::PLUS)))(PartialInput{"1 + 23", 0, true});
+    static_assert(parsed.is_success());
+    static_assert(parsed.next().input == " 23");
+    constexpr auto need_more = tokenized(arithmetic_lexer<PartialInput>(), sum_of_lengths())(PartialInput{"1 + 23", 0, true});
+    static_assert(need_more.is_need_more());
+    static_assert(need_more.next().input == "23");
+}
+namespace test_tokenized_in_text_grammar {
+    constexpr auto parsed = seq(string("sum="), tokenized(arithmetic_lexer(), sum_of_lengths()), elem(';'))(Input{"sum=1 + 22;"});
+    static_assert(parsed.is_success());
+    static_assert(std::get<1>(parsed.result()) == 3);
+}
+namespace test_tokenized_phrase {
+    static_assert(phrase(tokenized(arithmetic_lexer(), sum_of_lengths()))(Input{"1 + 2"}).is_success());
+    static_assert(phrase(tokenized(arithmetic_lexer(), phrase(sum_of_lengths())))(Input{"1 + 2 )"}).is_failure());
+}
+namespace test_recognize_lexer {
+    constexpr auto recognized = recognize(arithmetic_lexer())(Input{" 12 +(ab) - 3"});
+    static_assert(recognized.is_success());
+    static_assert(recognized.next().input == " - 3");
+    static_assert(recognize(arithmetic_lexer<PartialInput>())(PartialInput{"1 + 12", 0, true}).is_need_more());
+}
+namespace test_recognize_tokenized {
+    static_assert(recognize(tokenized(arithmetic_lexer(), sum_of_lengths()))(Input{"1 + 2 ) + 3"}).next().input == " ) + 3");
+    static_assert(recognize(tokenized(arithmetic_lexer(), sum_of_lengths()))(Input{"(1 + 2 + 3"}).is_failure());
+}
+
+TEST(LexerTest, manyTokens) {
+    std::string input = "x";
+    for (size_t i = 0; i < 10000; ++i) {
+        input += " + " + std::to_string(i);
+    }
+    auto parsed = phrase(tokenized(arithmetic_lexer(), map(repsep1(runtime_optimization, alternative(token(Kind::NUMBER), token(Kind::IDENTIFIER)), token(Kind::PLUS)), [] (auto&& terms) {return terms.size();})))(Input{input});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(10001, parsed.result());
+
+    // The token parser stops after many batches of tokens, the unlexable text after that doesn't matter
+    auto stopped = tokenized(arithmetic_lexer(), repsep1(runtime_optimization, alternative(token(Kind::NUMBER), token(Kind::IDENTIFIER)), token(Kind::PLUS)))(Input{input + " ) - !"});
+    ASSERT_TRUE(stopped.is_success());
+    EXPECT_EQ(10001, stopped.result().size());
+    EXPECT_EQ(" ) - !", stopped.next().input);
+
+    auto lexed = arithmetic_lexer()(Input{input});
+    ASSERT_TRUE(lexed.is_success());
+    EXPECT_EQ(20001, lexed.result().size());
+    EXPECT_EQ("x", lexed.result()[0].text());
+    EXPECT_EQ("9999", lexed.result()[20000].text());
+}
+
+}
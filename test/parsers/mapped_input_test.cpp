@@ -0,0 +1,107 @@
+#include "parsers/mapped_input.h"
+#include "parsers/rep.h"
+#include "parsers/integer.h"
+#include "parsers/elem.h"
+#include "parsers/string.h"
+#include "parsers/phrase.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <unistd.h>
+
+using namespace ctpc;
+
+namespace {
+
+class TempFile final {
+public:
+    explicit TempFile(std::string_view content)
+    : path_(std::filesystem::temp_directory_path() / ("ctpc_mapped_input_test_" + std::to_string(::getpid()) + "_" + std::to_string(counter_++))) {
+        std::ofstream file(path_, std::ios::binary);
+        file << content;
+    }
+
+    ~TempFile() {
+        std::filesystem::remove(path_);
+    }
+
+    const std::filesystem::path& path() const {
+        return path_;
+    }
+
+private:
+    static inline int counter_ = 0;
+    std::filesystem::path path_;
+};
+
+constexpr auto numbers_parser() {
+    return phrase(repsep(runtime_optimization, integer<PaddedInput>(), elem<PaddedInput>(',')));
+}
+
+TEST(MappedInputTest, parsesFileContents) {
+    TempFile file("12,34,56");
+    mapped_input input(file.path());
+    EXPECT_EQ(8, input.size());
+    EXPECT_EQ("12,34,56", input.view());
+    auto parsed = numbers_parser()(input.input());
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ((std::vector<int64_t>{12, 34, 56}), parsed.result());
+}
+
+TEST(MappedInputTest, emptyFile) {
+    TempFile file("");
+    mapped_input input(file.path());
+    EXPECT_EQ(0, input.size());
+    EXPECT_TRUE(numbers_parser()(input.input()).is_success());
+}
+
+TEST(MappedInputTest, withOptions) {
+    TempFile file("12,34");
+    mapped_input input(file.path(), mapped_input_options{.populate = true, .huge_pages = true});
+    EXPECT_EQ("12,34", input.view());
+}
+
+TEST(MappedInputTest, largeFile) {
+    std::string content;
+    for (int i = 0; i < 100000; ++i) {
+        content += std::to_string(i) + ",";
+    }
+    content += "0";
+    TempFile file(content);
+    auto parsed = mapped_input(file.path()).parse(numbers_parser());
+    EXPECT_TRUE(parsed->is_success());
+    EXPECT_EQ(100001, parsed->result().size());
+    EXPECT_EQ(99999, parsed->result()[99999]);
+}
+
+TEST(MappedInputTest, padsWithRestOfLastPage) {
+    TempFile file("12,34");
+    mapped_input input(file.path());
+    const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    EXPECT_EQ(page_size - 5, input.input().padding);
+    EXPECT_EQ('\0', input.view().data()[input.size()]);
+}
+
+TEST(MappedInputTest, nonexistingFile) {
+    EXPECT_THROW(mapped_input("/nonexisting/file"), std::system_error);
+}
+
+TEST(MappedInputTest, resultKeepsMappingAlive) {
+    TempFile file("Hello World");
+    auto parsed = mapped_input(file.path()).parse(string<PaddedInput>("Hello"));
+    // The mapped_input is already destructed, but the result still points into its mapping
+    EXPECT_TRUE(parsed->is_success());
+    EXPECT_EQ("Hello", parsed->result());
+    EXPECT_EQ(" World", (*parsed).next().input);
+}
+
+TEST(MappedInputTest, copiesShareMapping) {
+    TempFile file("Hello");
+    std::optional<mapped_input> original(std::in_place, file.path());
+    mapped_input copy = *original;
+    const char* data = original->view().data();
+    original.reset();
+    EXPECT_EQ(data, copy.view().data());
+    EXPECT_EQ("Hello", copy.view());
+}
+
+}
@@ -0,0 +1,92 @@
+// This file is compiled with -fno-exceptions, see CMakeLists.txt
+#include "parsers/alpha.h"
+#include "parsers/alternative.h"
+#include "parsers/balanced.h"
+#include "parsers/basic_parsers.h"
+#include "parsers/binary.h"
+#include "parsers/elem.h"
+#include "parsers/exact_size.h"
+#include "parsers/integer.h"
+#include "parsers/lazy.h"
+#include "parsers/lexer.h"
+#include "parsers/map.h"
+#ifndef _WIN32
+#include "parsers/mapped_input.h"
+#endif
+#include "parsers/match.h"
+#include "parsers/opt.h"
+#include "parsers/padded_input.h"
+#include "parsers/phrase.h"
+#include "parsers/push_parser.h"
+#include "parsers/recognize.h"
+#include "parsers/rep.h"
+#include "parsers/segmented_input.h"
+#include "parsers/seq.h"
+#include "parsers/stream.h"
+#include "parsers/string.h"
+#include "parsers/structural_index.h"
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+
+namespace {
+
+static_assert(!CTPC_HAS_EXCEPTIONS);
+
+// Without exceptions, only parsers that allocate can throw
+static_assert(details::is_nothrow_parser_v<decltype(phrase(seq(alpha(), elem('='), integer())))>);
+static_assert(details::is_nothrow_parser_v<decltype(rep(runtime_optimization, ignore(opt(alternative(string("ab"), whitespaces())))))>);
+static_assert(details::is_nothrow_parser_v<decltype(match(rep(runtime_optimization, seq(alpha(), elem(',')))))>);
+static_assert(!details::is_nothrow_parser_v<decltype(rep(runtime_optimization, seq(alpha(), elem(','))))>);
+static_assert(details::is_nothrow_parser_v<decltype(length_prefixed(be<uint16_t>()))>);
+static_assert(details::is_nothrow_parser_v<decltype(length_prefixed(uleb128(), seq(be<uint32_t>(), bytes(4))))>);
+static_assert(details::is_nothrow_parser_v<decltype(aligned<4>(bytes(3)))>);
+static_assert(details::is_nothrow_recognizer_v<decltype(length_prefixed(uleb128(), rep(runtime_optimization, be<uint16_t>())))>);
+
+enum class TokenKind {NUMBER, PLUS};
+using test_lexer = decltype(lexer(whitespaces(), rule(TokenKind::NUMBER, integer()), rule(TokenKind::PLUS, elem('+'))));
+static_assert(details::is_nothrow_parser_v<decltype(token(TokenKind::NUMBER))>);
+// Lexers allocate the token array, but finding the end of the tokens can't throw
+static_assert(!details::is_nothrow_parser_v<test_lexer>);
+static_assert(details::is_nothrow_recognizer_v<test_lexer>);
+static_assert(!details::is_nothrow_parser_v<decltype(tokenized(std::declval<test_lexer>(), token(TokenKind::NUMBER)))>);
+
+static_assert(details::is_nothrow_parser_v<decltype(skip_to(std::declval<const structural_index&>(), ","))>);
+static_assert(details::is_nothrow_parser_v<decltype(delimited(std::declval<const structural_index&>(), ",", seq(alpha(), elem('='), integer())))>);
+static_assert(details::is_nothrow_recognizer_v<decltype(delimited(std::declval<const structural_index&>(), ",", rep(runtime_optimization, alpha())))>);
+static_assert(details::is_nothrow_parser_v<decltype(lazy(skip_balanced('(', ')'), seq(alpha(), elem(','))))>);
+static_assert(details::is_nothrow_recognizer_v<decltype(lazy(skip_balanced('(', ')'), rep(runtime_optimization, alpha())))>);
+
+TEST(NoExceptionsTest, parses) {
+    const auto parsed = repsep(runtime_optimization, seq(alpha(), elem('='), integer()), elem(','))(Input{"a=1,b=2"});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(2, parsed.result().size());
+    EXPECT_EQ(2, std::get<2>(parsed.result()[1]));
+
+    coroutine_arena arena;
+    push_parser parser(&arena, push_rep(push_seq(integer<PartialInput>(), elem<PartialInput>(';'))));
+    parser.feed(std::string_view("12;3"));
+    parser.feed(std::string_view("4;"));
+    const auto pushed = parser.finish();
+    ASSERT_TRUE(pushed.is_success());
+    EXPECT_EQ(2, pushed.result().size());
+}
+
+TEST(NoExceptionsTest, capacityOverflowIsError) {
+    const auto parsed = rep<2>(compiletime_optimization, elem('a'))(Input{"aaa"});
+    EXPECT_TRUE(parsed.is_error());
+}
+
+#if CTPC_ASSERT_LEVEL >= CTPC_ASSERT_LEVEL_DEBUG
+TEST(NoExceptionsTest, failedAssertionAborts) {
+    const auto parsed = integer()(Input{"x"});
+    ASSERT_TRUE(parsed.is_failure());
+    EXPECT_DEATH(parsed.result(), "");
+}
+#endif
+
+TEST(NoExceptionsTest, unreadableFileAborts) {
+    EXPECT_DEATH(padded_input::from_file("/nonexisting/file"), "");
+}
+
+}
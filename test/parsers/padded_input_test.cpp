@@ -0,0 +1,101 @@
+#include "parsers/padded_input.h"
+#include "parsers/rep.h"
+#include "parsers/integer.h"
+#include "parsers/alpha.h"
+#include "parsers/elem.h"
+#include "parsers/seq.h"
+#include "parsers/phrase.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <unistd.h>
+
+using namespace ctpc;
+
+namespace {
+
+constexpr auto numbers_parser() {
+    return phrase(repsep(runtime_optimization, integer<PaddedInput>(), seq(whitespaces<PaddedInput>(), elem<PaddedInput>(','), whitespaces<PaddedInput>())));
+}
+
+void expect_zero_padding(const padded_input& input) {
+    const char* end = input.view().data() + input.size();
+    for (size_t i = 0; i < padded_input::PADDING; ++i) {
+        EXPECT_EQ('\0', end[i]);
+    }
+}
+
+TEST(PaddedInputTest, copyFrom) {
+    auto input = padded_input::copy_from("12, 34 ,56");
+    EXPECT_EQ("12, 34 ,56", input.view());
+    EXPECT_EQ(10, input.size());
+    EXPECT_EQ(padded_input::PADDING, input.input().padding);
+    expect_zero_padding(input);
+    auto parsed = numbers_parser()(input.input());
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ((std::vector<int64_t>{12, 34, 56}), parsed.result());
+}
+
+TEST(PaddedInputTest, fromString) {
+    std::string content = "12,34";
+    content.reserve(content.size() + padded_input::PADDING);
+    const char* data = content.data();
+    auto input = padded_input::from_string(std::move(content));
+    // There was enough capacity, so the characters weren't copied
+    EXPECT_EQ(data, input.view().data());
+    EXPECT_EQ("12,34", input.view());
+    expect_zero_padding(input);
+}
+
+TEST(PaddedInputTest, empty) {
+    auto input = padded_input::copy_from("");
+    EXPECT_EQ(0, input.size());
+    expect_zero_padding(input);
+    EXPECT_TRUE(numbers_parser()(input.input()).is_success());
+}
+
+TEST(PaddedInputTest, fromFile) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / ("ctpc_padded_input_test_" + std::to_string(::getpid()));
+    std::string content;
+    for (int i = 0; i < 10000; ++i) {
+        content += std::to_string(i) + ", ";
+    }
+    content += "0";
+    std::ofstream(path, std::ios::binary) << content;
+    auto input = padded_input::from_file(path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(content, input.view());
+    expect_zero_padding(input);
+    auto parsed = numbers_parser()(input.input());
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(10001, parsed.result().size());
+    EXPECT_EQ(9999, parsed.result()[9999]);
+}
+
+TEST(PaddedInputTest, nonexistingFile) {
+    EXPECT_THROW(padded_input::from_file("/nonexisting/file"), std::system_error);
+}
+
+TEST(PaddedInputTest, parsersKeepPadding) {
+    auto input = padded_input::copy_from("123  abc");
+    auto parsed = seq(integer<PaddedInput>(), whitespaces<PaddedInput>(), elem<PaddedInput>('a'))(input.input());
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ("bc", parsed.next().input);
+    EXPECT_EQ(padded_input::PADDING, parsed.next().padding);
+}
+
+TEST(PaddedInputTest, parserDoesntMatchPadding) {
+    // whitespaces() would accept the padding if it wasn't limited to the input
+    auto input = padded_input::copy_from("  ");
+    auto parsed = seq(whitespaces<PaddedInput>(), elem<PaddedInput>('\0'))(input.input());
+    EXPECT_FALSE(parsed.is_success());
+}
+
+TEST(PaddedInputTest, movingKeepsData) {
+    auto input = padded_input::copy_from("abc");
+    const char* data = input.view().data();
+    padded_input moved = std::move(input);
+    EXPECT_EQ(data, moved.view().data());
+}
+
+}
@@ -1,7 +1,26 @@
 #include "parsers/parse_result.h"
 
+using namespace ctpc;
+
 namespace {
 
+namespace test_unit_result {
+    constexpr auto parsed = ParseResult<unit>::success(Input{"ab"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == unit{});
+    static_assert(parsed.next().input == "ab");
+
+    static_assert(ParseResult<unit>::success(Input{"ab"}, unit{}).is_success());
+    static_assert(ParseResult<unit>::failure(Input{"ab"}).is_failure());
+    static_assert(ParseResult<unit>::need_more(Input{"ab"}).is_need_more());
 
+    constexpr auto mapped = ParseResult<unit>::success(Input{"ab"}).map([] (unit) {return 3;});
+    static_assert(mapped.result() == 3);
+}
+namespace test_unit_result_has_no_storage {
+    // ParseResult<char> needs alignof(Input) bytes for its std::optional<char>, ParseResult<unit> nothing
+    static_assert(sizeof(ParseResult<unit>) == sizeof(ParseResult<char>) - alignof(Input));
+    static_assert(sizeof(ParseResult<unit>) < sizeof(ParseResult<std::nullptr_t>));
+}
 
 }
@@ -94,7 +94,7 @@ TEST(PhraseParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_success
     auto parsed = phrase(success_parser_with_copycounting_result(&copy_count, &move_count))(Input{""});
     EXPECT_TRUE(parsed.is_success());
     EXPECT_EQ(0, copy_count);
-    EXPECT_EQ(1, move_count); // TODO Why isn't this RVO'd?
+    EXPECT_LE(move_count, 1); // phrase() returns a named local. That's 0 moves with NRVO (e.g. GCC 12) and 1 move without (e.g. Clang 4), and NRVO isn't guaranteed.
 }
 
 }
@@ -0,0 +1,291 @@
+#include "parsers/push_parser.h"
+#include "parsers/alpha.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/map.h"
+#include "parsers/match.h"
+#include "parsers/seq.h"
+#include "parsers/string.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace ctpc;
+
+namespace {
+
+// Delivers the data in fragments of random sizes, like a socket would
+class FakeSocket final {
+public:
+    FakeSocket(std::string data, size_t max_fragment_size, uint32_t seed)
+    : data_(std::move(data)), position_(0), max_fragment_size_(max_fragment_size), random_(seed) {}
+
+    std::optional<std::span<const char>> receive() {
+        if (position_ == data_.size()) {
+            return std::nullopt;
+        }
+        const size_t size = std::min(data_.size() - position_, std::uniform_int_distribution<size_t>(1, max_fragment_size_)(random_));
+        std::span<const char> fragment(data_.data() + position_, size);
+        position_ += size;
+        return fragment;
+    }
+
+private:
+    std::string data_;
+    size_t position_;
+    size_t max_fragment_size_;
+    std::mt19937 random_;
+};
+
+template<class Parser>
+auto parse_from_socket(coroutine_arena* arena, FakeSocket* socket, Parser parser) {
+    push_parser<push_result_t<Parser>> pushed(arena, std::move(parser));
+    while (auto fragment = socket->receive()) {
+        pushed.feed(*fragment);
+    }
+    return pushed.finish();
+}
+
+// "key=123;" records
+constexpr auto record_parser() {
+    return push_seq(
+        map(match(rep(runtime_optimization, alpha<PartialInput>())), [] (std::string_view key) {return std::string(key);}),
+        elem<PartialInput>('='),
+        integer<PartialInput>(),
+        elem<PartialInput>(';'),
+        whitespaces<PartialInput>()
+    );
+}
+
+std::string make_records(size_t num_records) {
+    std::string result;
+    for (size_t i = 0; i < num_records; ++i) {
+        result += std::string(1 + i % 7, static_cast<char>('a' + i % 26)) + "=" + std::to_string(i * 7919) + ";" + std::string(i % 3, ' ');
+    }
+    return result;
+}
+
+TEST(PushParserTest, randomFragments) {
+    const std::string input = make_records(300);
+    coroutine_arena arena;
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+        SCOPED_TRACE(seed);
+        FakeSocket socket(input, 1 + seed, seed);
+        auto parsed = parse_from_socket(&arena, &socket, push_rep(record_parser()));
+        ASSERT_TRUE(parsed.is_success());
+        ASSERT_EQ(300, parsed.result().size());
+        for (size_t i = 0; i < 300; ++i) {
+            EXPECT_EQ(std::string(1 + i % 7, static_cast<char>('a' + i % 26)), std::get<0>(parsed.result()[i]));
+            EXPECT_EQ(static_cast<int64_t>(i * 7919), std::get<2>(parsed.result()[i]));
+        }
+    }
+}
+
+TEST(PushParserTest, viewsStayValidAcrossFeeds) {
+    // Unlike record_parser(), the results point into the input fed in earlier fragments
+    const std::string input = make_records(300);
+    coroutine_arena arena;
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+        SCOPED_TRACE(seed);
+        FakeSocket socket(input, 1 + seed, seed);
+        // The views are valid as long as the push_parser lives
+        push_parser parser(&arena, push_rep(push_seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>('='), match(integer<PartialInput>()), elem<PartialInput>(';'), whitespaces<PartialInput>())));
+        while (auto fragment = socket.receive()) {
+            parser.feed(*fragment);
+        }
+        auto parsed = parser.finish();
+        ASSERT_TRUE(parsed.is_success());
+        ASSERT_EQ(300, parsed.result().size());
+        for (size_t i = 0; i < 300; ++i) {
+            EXPECT_EQ(std::string(1 + i % 7, static_cast<char>('a' + i % 26)), std::get<0>(parsed.result()[i]));
+            EXPECT_EQ(std::to_string(i * 7919), std::get<2>(parsed.result()[i]));
+            EXPECT_EQ(std::string(i % 3, ' '), std::get<4>(parsed.result()[i]));
+        }
+    }
+}
+
+TEST(PushParserTest, resumesWithoutReparsingRecordStart) {
+    // Counts how often the record start is parsed
+    int num_record_starts = 0;
+    auto record_start = [&num_record_starts] (PartialInput input) {
+        ++num_record_starts;
+        return string<PartialInput>("id=")(input);
+    };
+    const std::string input = "id=12345678;id=9;id=1234;";
+    FakeSocket socket(input, 1, 0);
+    coroutine_arena arena;
+    auto parsed = parse_from_socket(&arena, &socket, push_rep(push_seq(record_start, integer<PartialInput>(), elem<PartialInput>(';'))));
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(3, parsed.result().size());
+    // The input is fed byte by byte, so each record start is tried on "", "i", "id" and "id=". After the last record,
+    // it is tried once on "" and once more after finish(). The numbers after it don't cause it to be parsed again.
+    EXPECT_EQ(3 * 4 + 2, num_record_starts);
+}
+
+TEST(PushParserTest, failure) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_rep(push_seq(integer<PartialInput>(), elem<PartialInput>(';'))));
+    parser.feed(std::string_view("12;34"));
+    EXPECT_FALSE(parser.done());
+    parser.feed(std::string_view(",56;"));
+    // The second record failed after consuming "34", so the parser is done
+    EXPECT_TRUE(parser.done());
+    EXPECT_TRUE(parser.finish().is_failure());
+}
+
+TEST(PushParserTest, trailingInput) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_seq(integer<PartialInput>(), elem<PartialInput>(';')));
+    parser.feed(std::string_view("12;34"));
+    EXPECT_TRUE(parser.finish().is_failure());
+}
+
+TEST(PushParserTest, feedAfterDoneIsntBuffered) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_seq(integer<PartialInput>(), elem<PartialInput>(';')));
+    parser.feed(std::string_view("12;"));
+    EXPECT_TRUE(parser.done());
+    const size_t buffered_bytes = parser.metrics().buffered_bytes;
+    parser.feed(std::string(1000, 'x'));
+    EXPECT_EQ(buffered_bytes, parser.metrics().buffered_bytes);
+    // It's still trailing input
+    EXPECT_TRUE(parser.finish().is_failure());
+}
+
+TEST(PushParserTest, emptyFeedAfterDone) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_seq(integer<PartialInput>(), elem<PartialInput>(';')));
+    parser.feed(std::string_view("12;"));
+    parser.feed(std::string_view(""));
+    EXPECT_TRUE(parser.finish().is_success());
+}
+
+TEST(PushParserTest, regularParser) {
+    coroutine_arena arena;
+    push_parser parser(&arena, seq(integer<PartialInput>(), elem<PartialInput>(';')));
+    parser.feed(std::string_view("1"));
+    parser.feed(std::string_view("2;"));
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(12, std::get<0>(parsed.result()));
+}
+
+TEST(PushParserTest, emptyInput) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_rep(push_seq(integer<PartialInput>(), elem<PartialInput>(';'))));
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(0, parsed.result().size());
+}
+
+TEST(PushParserTest, arenaIsReused) {
+    coroutine_arena arena;
+    const std::string input = make_records(50);
+    for (uint32_t connection = 0; connection < 3; ++connection) {
+        FakeSocket socket(input, 16, connection);
+        EXPECT_TRUE(parse_from_socket(&arena, &socket, push_rep(record_parser())).is_success());
+        // All frames were freed and no frame needed the heap
+        EXPECT_EQ(0, arena.used());
+        EXPECT_EQ(0, arena.num_heap_allocations());
+    }
+    EXPECT_LT(0, arena.high_water());
+}
+
+TEST(PushParserTest, arenaReclaimsFramesFreedOutOfOrder) {
+    using records_parser = push_parser<push_result_t<decltype(push_rep(record_parser()))>>;
+    coroutine_arena arena;
+    auto first = std::make_unique<records_parser>(&arena, push_rep(record_parser()));
+    first->feed(std::string_view("a=1; b"));
+    const size_t used_by_first = arena.used();
+    auto second = std::make_unique<records_parser>(&arena, push_rep(record_parser()));
+    second->feed(std::string_view("c=3; d"));
+    EXPECT_LT(used_by_first, arena.used());
+    // The first parser's frames are below the second parser's frames
+    first.reset();
+    EXPECT_LT(used_by_first, arena.used());
+    second.reset();
+    EXPECT_EQ(0, arena.used());
+}
+
+TEST(PushParserTest, smallArenaFallsBackToHeap) {
+    coroutine_arena arena(64);
+    FakeSocket socket(make_records(20), 8, 0);
+    auto parsed = parse_from_socket(&arena, &socket, push_rep(record_parser()));
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(20, parsed.result().size());
+    EXPECT_LT(0, arena.num_heap_allocations());
+    EXPECT_EQ(0, arena.used());
+}
+
+
+TEST(PushParserTest, commitKeepsMemoryFlat) {
+    // A long stream in 4 KiB chunks. Each record is handed to the consumer and then committed.
+    const std::string chunk = make_records(400).substr(0, 4096);
+    const std::string_view records = std::string_view(chunk).substr(0, chunk.rfind(';') + 1);
+    size_t num_records = 0;
+    int64_t sum = 0;
+    coroutine_arena arena;
+    push_parser parser(&arena, push_rep(commit(push_seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>('='), integer<PartialInput>(), elem<PartialInput>(';'), whitespaces<PartialInput>()), [&] (auto&& record) {
+        // The key is a std::string_view into the input. It's valid until the record is committed.
+        EXPECT_FALSE(std::get<0>(record).empty());
+        ++num_records;
+        sum += std::get<2>(record);
+    })));
+    constexpr size_t NUM_CHUNKS = 500;
+    size_t expected_records = 0;
+    for (size_t i = 0; i < NUM_CHUNKS; ++i) {
+        parser.feed(records);
+        expected_records += std::count(records.begin(), records.end(), ';');
+    }
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(expected_records, parsed.result());
+    EXPECT_EQ(expected_records, num_records);
+    EXPECT_LT(0, sum);
+    // 2 MB went through, but at most two chunks were buffered at a time: the one an unfinished record started in and the new one
+    EXPECT_EQ(NUM_CHUNKS * records.size(), parser.metrics().committed_bytes);
+    EXPECT_GE(2 * records.size() + 32, parser.metrics().buffer_high_water);
+}
+
+TEST(PushParserTest, uncommittedViewsSurviveLargeFeeds) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>('='), integer<PartialInput>(), whitespaces<PartialInput>()));
+    parser.feed(std::string_view("hello="));
+    // The key was parsed in the first chunk, and this one is much larger
+    parser.feed(std::string("12") + std::string(1000, ' '));
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ("hello", std::get<0>(parsed.result()));
+    EXPECT_EQ(12, std::get<2>(parsed.result()));
+}
+
+TEST(PushParserTest, longTokenFedByteByByte) {
+    // The token doesn't fit into any chunk, so the window is copied into larger and larger chunks
+    const std::string input = "key=" + std::string(16 * 1024, '1') + ";";
+    coroutine_arena arena;
+    push_parser parser(&arena, push_seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>('='), match(rep(runtime_optimization, elem<PartialInput>('1'))), elem<PartialInput>(';')));
+    for (char c : input) {
+        parser.feed(std::span<const char>(&c, 1));
+    }
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ("key", std::get<0>(parsed.result()));
+    EXPECT_EQ(16 * 1024, std::get<2>(parsed.result()).size());
+    // Chunks nothing points into are released when the window moves to a larger chunk
+    EXPECT_GE(2 * input.size(), parser.metrics().buffer_high_water);
+}
+
+TEST(PushParserTest, withoutCommitInputIsKept) {
+    coroutine_arena arena;
+    push_parser parser(&arena, push_rep(push_seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>(';'))));
+    for (int i = 0; i < 100; ++i) {
+        parser.feed(std::string_view("abc;"));
+    }
+    auto parsed = parser.finish();
+    ASSERT_TRUE(parsed.is_success());
+    // The std::string_views in the results still point into the input
+    EXPECT_EQ(100, parsed.result().size());
+    EXPECT_EQ("abc", std::get<0>(parsed.result()[99]));
+    EXPECT_EQ(400, parser.metrics().buffer_high_water);
+    EXPECT_EQ(0, parser.metrics().committed_bytes);
+}
+}
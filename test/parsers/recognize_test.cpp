@@ -0,0 +1,144 @@
+#include "parsers/recognize.h"
+#include "parsers/alpha.h"
+#include "parsers/alternative.h"
+#include "parsers/basic_parsers.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/map.h"
+#include "parsers/match.h"
+#include "parsers/opt.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+using namespace ctpc;
+
+namespace {
+
+// A map function that can't run in constant expressions. Parsers using it only work at compile time in recognizer mode.
+constexpr auto not_constexpr_map(size_t* num_calls = nullptr) {
+    return [num_calls] (auto&& /*value*/) {
+        if (num_calls == nullptr) {
+            throw std::logic_error("Map function called");
+        }
+        ++*num_calls;
+        return 0;
+    };
+}
+
+namespace test_recognize_seq {
+    constexpr auto parsed = recognize(seq(integer(), elem(','), map(integer(), not_constexpr_map())))(Input{"12,34x"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<unit>, decltype(parsed)>);
+    static_assert(parsed.next().input == "x");
+}
+namespace test_recognize_seq_failure {
+    constexpr auto parsed = recognize(seq(integer(), elem(','), map(integer(), not_constexpr_map())))(Input{"12;34"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == ";34");
+}
+namespace test_recognize_seq_need_more {
+    constexpr auto parsed = recognize(seq(integer<PartialInput>(), elem<PartialInput>(','), map(integer<PartialInput>(), not_constexpr_map())))(PartialInput{"12,34", 0, true});
+    static_assert(parsed.is_need_more());
+    static_assert(parsed.next().input == "");
+}
+namespace test_recognize_alternative {
+    constexpr auto parser = recognize(alternative(map(seq(elem('a'), elem('b'), elem('c')), not_constexpr_map()), map(seq(elem('a'), integer()), not_constexpr_map())));
+    static_assert(parser(Input{"a1x"}).is_success());
+    static_assert(parser(Input{"a1x"}).next().input == "x");
+    // Failures return the longest match
+    static_assert(parser(Input{"abx"}).is_failure());
+    static_assert(parser(Input{"abx"}).next().input == "x");
+    static_assert(recognize(alternative(map(error(), not_constexpr_map()), integer()))(Input{"1"}).is_error());
+}
+namespace test_recognize_opt {
+    constexpr auto parser = recognize(seq(opt(map(integer(), not_constexpr_map())), alpha()));
+    static_assert(parser(Input{"12a"}).is_success());
+    static_assert(parser(Input{"12a"}).next().input == "");
+    static_assert(parser(Input{"a"}).is_success());
+    static_assert(parser(Input{"12"}).is_failure());
+}
+namespace test_recognize_rep {
+    constexpr auto parser = recognize(repsep(runtime_optimization, map(integer(), not_constexpr_map()), elem(',')));
+    static_assert(parser(Input{"1,2,3,x"}).is_success());
+    static_assert(parser(Input{"1,2,3,x"}).next().input == ",x");
+    static_assert(parser(Input{"x"}).is_success());
+    static_assert(parser(Input{"x"}).next().input == "x");
+
+    constexpr auto parser1 = recognize(rep1(runtime_optimization, map(alpha(), not_constexpr_map())));
+    static_assert(parser1(Input{"abc1"}).next().input == "1");
+    static_assert(parser1(Input{"1"}).is_failure());
+    constexpr auto partial_parser1 = recognize(rep1(runtime_optimization, map(alpha<PartialInput>(), not_constexpr_map())));
+    static_assert(partial_parser1(PartialInput{"abc", 0, true}).is_need_more());
+}
+namespace test_recognize_rep_capacity_overflow {
+    // The recognizer doesn't fill the cvector, but it fails the same way when the elements wouldn't fit into it
+    constexpr auto parser = repsep<2>(compiletime_optimization, alpha(), elem(','));
+    static_assert(parser(Input{"a,b,1"}).is_success());
+    static_assert(recognize(parser)(Input{"a,b,1"}).is_success());
+    static_assert(recognize(parser)(Input{"a,b,1"}).next().input == ",1");
+    static_assert(parser(Input{"a,b,c"}).is_error());
+    static_assert(recognize(parser)(Input{"a,b,c"}).is_error());
+    static_assert(recognize(parser)(Input{"a,b,c"}).next().input == parser(Input{"a,b,c"}).next().input);
+    static_assert(match(parser)(Input{"a,b,c"}).is_error());
+
+    constexpr auto parser1 = rep1<2>(compiletime_optimization, alpha());
+    static_assert(recognize(parser1)(Input{"ab1"}).is_success());
+    static_assert(parser1(Input{"abc"}).is_error());
+    static_assert(recognize(parser1)(Input{"abc"}).is_error());
+    static_assert(recognize(parser1)(Input{"abc"}).next().input == "c");
+}
+namespace test_recognize_error {
+    constexpr auto parsed = recognize(seq(integer(), error()))(Input{"12x"});
+    static_assert(parsed.is_error());
+    static_assert(parsed.next().input == "x");
+}
+namespace test_match_uses_recognizer {
+    constexpr auto parsed = match(rep(runtime_optimization, map(seq(integer(), elem(',')), not_constexpr_map())))(Input{"1,22,333,x"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == "1,22,333,");
+    static_assert(parsed.next().input == "x");
+}
+namespace test_integer_recognizer_doesnt_accumulate {
+    // Too large for int64_t, but recognizing it doesn't compute the value
+    constexpr auto parsed = match(integer())(Input{"123456789012345678901234567890x"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == "123456789012345678901234567890");
+}
+namespace test_noexcept_propagates {
+    // Leaves only contain paranoid assertions, combinators also contain API assertions
+    static_assert(details::is_nothrow_parser_v<decltype(elem('a'))> == details::nothrow_paranoid_asserts);
+    static_assert(details::is_nothrow_parser_v<decltype(seq(alpha(), elem('='), integer()))> == details::nothrow_asserts);
+    static_assert(details::is_nothrow_parser_v<decltype(match(rep(runtime_optimization, alternative(alpha(), elem('_')))))> == details::nothrow_asserts);
+    static_assert(details::is_nothrow_parser_v<decltype(rep(runtime_optimization, ignore(elem(' '))))> == details::nothrow_asserts);
+    // Throwing map functions and allocating containers make the parser potentially throwing, but not its recognizer
+    constexpr auto parser = rep(runtime_optimization, map(integer(), not_constexpr_map()));
+    static_assert(!details::is_nothrow_parser_v<decltype(map(integer(), not_constexpr_map()))>);
+    static_assert(!details::is_nothrow_parser_v<decltype(parser)>);
+    static_assert(details::is_nothrow_recognizer_v<decltype(parser)> == details::nothrow_asserts);
+}
+
+TEST(RecognizeTest, doesntRunMapFunctions) {
+    size_t num_calls = 0;
+    const auto parser = repsep(runtime_optimization, map(integer(), not_constexpr_map(&num_calls)), elem(','));
+    EXPECT_TRUE(recognize(parser)(Input{"1,2,3"}).is_success());
+    EXPECT_TRUE(match(parser)(Input{"1,2,3"}).is_success());
+    EXPECT_EQ(0, num_calls);
+    EXPECT_EQ(3, parser(Input{"1,2,3"}).result().size());
+    EXPECT_EQ(3, num_calls);
+}
+
+TEST(RecognizeTest, doesntBuildContainers) {
+    size_t num_accumulators = 0;
+    size_t num_elements = 0;
+    const auto parser = rep(integer(),
+        [&num_accumulators] () {++num_accumulators; return 0;},
+        [&num_elements] (int* /*accumulator*/, int64_t /*element*/) {++num_elements;}
+    );
+    EXPECT_TRUE(recognize(seq(elem('['), parser, elem(']')))(Input{"[123]"}).is_success());
+    EXPECT_EQ(0, num_accumulators);
+    EXPECT_EQ(0, num_elements);
+}
+
+}
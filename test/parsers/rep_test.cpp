@@ -1,6 +1,7 @@
 #include "parsers/rep.h"
 #include "parsers/string.h"
 #include "parsers/integer.h"
+#include "parsers/alpha.h"
 #include "testutils/move_helpers.h"
 #include "testutils/error_parser.h"
 #include <gtest/gtest.h>
@@ -12,13 +13,15 @@ namespace {
 namespace test_repsep_type {
     // compiletime / runtime overloads
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(compiletime_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, cvector<std::string_view, 1024>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(compiletime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, cvector<long long, 1024>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(compiletime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, cvector<int64_t, 1024>>::value);
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(runtime_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(runtime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(runtime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep(hybrid_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, small_vector<std::string_view, 8>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep<2>(hybrid_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, small_vector<int64_t, 2>>::value);
 
     // custom container variant
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep<std::vector<std::string_view>>(string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep<std::vector<long long>>(integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep<std::vector<int64_t>>(integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
 
     // custom container variant with parser and container having non-matching but convertible result types   
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep<std::vector<std::string>>(string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string>>::value);
@@ -62,6 +65,9 @@ public:
         test_runtime_cvector_();
         test_runtime_stdvector_();
         test_runtime_stdvector_reservecapacity_();
+        test_runtime_smallvector_();
+        test_runtime_smallvector_spilling_();
+        test_runtime_smallvector_reservecapacity_();
         test_runtime_customcontainer_cvector_();
         test_runtime_customcontainer_cvector_reservecapacity_();
         test_runtime_customcontainer_stdvector_();
@@ -92,6 +98,22 @@ private:
         expectation_(parsed);
     }
 
+    void test_runtime_smallvector_() {
+        auto parsed = repsep(hybrid_optimization, elementParserCreator_(), separatorParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_spilling_() {
+        // only one element inline, everything else has to go to the heap
+        auto parsed = repsep<1>(hybrid_optimization, elementParserCreator_(), separatorParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_reservecapacity_() {
+        auto parsed = repsep(hybrid_optimization, elementParserCreator_(), separatorParserCreator_(), 100)(input_);
+        expectation_(parsed);
+    }
+
     constexpr void test_compiletime_customcontainer_() {
         auto parsed = repsep<cvector<parser_result_t<ElementParser>, 1024>>(elementParserCreator_(), separatorParserCreator_())(input_);
         expectation_(parsed);
@@ -543,6 +565,15 @@ TEST(RepsepParserTest, doesntCopyOrMoveParsersMoreThanAbsolutelyNecessary_runtim
     );
 }
 
+TEST(RepsepParserTest, doesntCopyOrMoveParsersMoreThanAbsolutelyNecessary_hybrid) {
+    testDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary(
+            [] (auto&&... args) {return repsep(hybrid_optimization, std::forward<decltype(args)>(args)...); },
+            {ctpc::Input{""}, ctpc::Input{"Found,Found"}, ctpc::Input{"Found,FoundBla"}, ctpc::Input{"Found,Found,"}, ctpc::Input{"Found,Found,Bla"}},
+            [] () {return string("Found");},
+            [] () {return string(",");}
+    );
+}
+
 TEST(RepsepParserTest, doesntCopyOrMoveParsersMoreThanAbsolutelyNecessary_customcontainer) {
     testDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary(
             [] (auto&&... args) {return repsep<cvector<std::string_view, 1024>>(std::forward<decltype(args)>(args)...); },
@@ -581,6 +612,42 @@ TEST(RepsepParserTest, worksWithMovableOnlyResult_stopafterfullmatch_runtime) {
     EXPECT_TRUE(parsed.is_success());
 }
 
+TEST(RepsepParserTest, worksWithMovableOnlyResult_stopafterfullmatch_hybrid) {
+    auto parser_with_movable_only_result = map(elem('a'), [] (auto) {return movable_only<int>(3);});
+    auto parsed = repsep<1>(hybrid_optimization, parser_with_movable_only_result, parser_with_movable_only_result)(Input{"aaaaa"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(3, parsed.result().size());
+}
+
+namespace test_repsep_nondefaultconstructible_compiletime {
+    class NonDefaultConstructible final {
+    public:
+        constexpr explicit NonDefaultConstructible(char value): value_(value) {}
+        constexpr char value() const { return value_; }
+    private:
+        char value_;
+    };
+    constexpr auto parsed = repsep(compiletime_optimization, map(alpha_small(), [] (char value) {return NonDefaultConstructible(value);}), elem(','))(Input{"a,b,c"});
+    static_assert(parsed.is_success());
+    static_assert(3 == parsed.result().size());
+    static_assert('a' == parsed.result()[0].value());
+    static_assert('c' == parsed.result()[2].value());
+}
+
+TEST(RepsepParserTest, worksWithNonDefaultConstructibleResult_hybrid) {
+    struct NonDefaultConstructible final {
+        explicit NonDefaultConstructible(char value_): value(value_) {}
+        char value;
+    };
+    auto parser = map(alpha_small(), [] (char value) {return NonDefaultConstructible(value);});
+    auto parsed = repsep<2>(hybrid_optimization, parser, elem(','))(Input{"a,b,c"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(3, parsed.result().size());
+    EXPECT_EQ('a', parsed.result()[0].value);
+    EXPECT_EQ('b', parsed.result()[1].value);
+    EXPECT_EQ('c', parsed.result()[2].value);
+}
+
 TEST(RepsepParserTest, worksWithMovableOnlyResult_stopafterfullmatch_customcontainer) {
     auto parser_with_movable_only_result = map(elem('a'), [] (auto) {return movable_only<int>(3);});
     auto parsed = repsep<std::vector<movable_only<int>>>(parser_with_movable_only_result, parser_with_movable_only_result)(Input{"aa"});
@@ -690,6 +757,27 @@ TEST(RepsepParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_runtime
     EXPECT_EQ(0, move_count_separator);
 }
 
+TEST(RepsepParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_hybrid) {
+    constexpr auto parser_with_copycounting_result = [] (size_t* copy_count, size_t* move_count) {
+        return [=] (Input input) {
+            if (input.input.size() > 0) {
+                return ParseResult<copy_counting<int>>::success(Input{input.input.substr(1)}, 3, copy_count, move_count);
+            } else {
+                return ParseResult<copy_counting<int>>::failure(input);
+            }
+        };
+    };
+
+    size_t copy_count_pattern = 0, move_count_pattern = 0, copy_count_separator = 0, move_count_separator = 0;
+
+    auto parsed = repsep(hybrid_optimization, parser_with_copycounting_result(&copy_count_pattern, &move_count_pattern), parser_with_copycounting_result(&copy_count_separator, &move_count_separator))(Input{"aaaa"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(0, copy_count_pattern);
+    EXPECT_EQ(4, move_count_pattern);  // two elements, two separators. Each element moved once when parsed, and in the end we move the whole small_vector. Both elements are stored inline, so that moves them again.
+    EXPECT_EQ(0, copy_count_separator);
+    EXPECT_EQ(0, move_count_separator);
+}
+
 TEST(RepsepParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_customcontainer) {
     constexpr auto parser_with_copycounting_result = [] (size_t* copy_count, size_t* move_count) {
         return [=] (Input input) {
@@ -774,13 +862,15 @@ TEST(RepsepParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_accumul
 namespace test_repsep1_type {
     // compiletime / runtime overloads
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(compiletime_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, cvector<std::string_view, 1024>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(compiletime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, cvector<long long, 1024>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(compiletime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, cvector<int64_t, 1024>>::value);
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(runtime_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(runtime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(runtime_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1(hybrid_optimization, string("Elem"), string("sep"))(std::declval<Input>()).result())>>, small_vector<std::string_view, 8>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1<2>(hybrid_optimization, integer(), string("sep"))(std::declval<Input>()).result())>>, small_vector<int64_t, 2>>::value);
 
     // custom container variant
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1<std::vector<std::string_view>>(string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1<std::vector<long long>>(integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1<std::vector<int64_t>>(integer(), string("sep"))(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
 
     // custom container variant with parser and container having non-matching but convertible result types   
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(repsep1<std::vector<std::string>>(string("Elem"), string("sep"))(std::declval<Input>()).result())>>, std::vector<std::string>>::value);
@@ -818,6 +908,9 @@ public:
         test_runtime_cvector_();
         test_runtime_stdvector_();
         test_runtime_stdvector_reservecapacity_();
+        test_runtime_smallvector_();
+        test_runtime_smallvector_spilling_();
+        test_runtime_smallvector_reservecapacity_();
         test_runtime_customcontainer_cvector_();
         test_runtime_customcontainer_cvector_reservecapacity_();
         test_runtime_customcontainer_stdvector_();
@@ -848,6 +941,22 @@ private:
         expectation_(parsed);
     }
 
+    void test_runtime_smallvector_() {
+        auto parsed = repsep1(hybrid_optimization, elementParserCreator_(), separatorParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_spilling_() {
+        // only one element inline, everything else has to go to the heap
+        auto parsed = repsep1<1>(hybrid_optimization, elementParserCreator_(), separatorParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_reservecapacity_() {
+        auto parsed = repsep1(hybrid_optimization, elementParserCreator_(), separatorParserCreator_(), 100)(input_);
+        expectation_(parsed);
+    }
+
     constexpr void test_compiletime_customcontainer_() {
         auto parsed = repsep1<cvector<parser_result_t<ElementParser>, 1024>>(elementParserCreator_(), separatorParserCreator_())(input_);
         expectation_(parsed);
@@ -1524,13 +1633,15 @@ TEST(Repsep1ParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_accumu
 namespace test_rep_type {
     // compiletime / runtime overloads
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(compiletime_optimization, string("Elem"))(std::declval<Input>()).result())>>, cvector<std::string_view, 1024>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(compiletime_optimization, integer())(std::declval<Input>()).result())>>, cvector<long long, 1024>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(compiletime_optimization, integer())(std::declval<Input>()).result())>>, cvector<int64_t, 1024>>::value);
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(runtime_optimization, string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(runtime_optimization, integer())(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(runtime_optimization, integer())(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep(hybrid_optimization, string("Elem"))(std::declval<Input>()).result())>>, small_vector<std::string_view, 8>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep<2>(hybrid_optimization, integer())(std::declval<Input>()).result())>>, small_vector<int64_t, 2>>::value);
 
     // custom container variant
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep<std::vector<std::string_view>>(string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep<std::vector<long long>>(integer())(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep<std::vector<int64_t>>(integer())(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
 
     // custom container variant with parser and container having non-matching but convertible result types   
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep<std::vector<std::string>>(string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string>>::value);
@@ -1566,6 +1677,9 @@ public:
         test_runtime_cvector_();
         test_runtime_stdvector_();
         test_runtime_stdvector_reservecapacity_();
+        test_runtime_smallvector_();
+        test_runtime_smallvector_spilling_();
+        test_runtime_smallvector_reservecapacity_();
         test_runtime_customcontainer_cvector_();
         test_runtime_customcontainer_cvector_reservecapacity_();
         test_runtime_customcontainer_stdvector_();
@@ -1596,6 +1710,22 @@ private:
         expectation_(parsed);
     }
 
+    void test_runtime_smallvector_() {
+        auto parsed = rep(hybrid_optimization, elementParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_spilling_() {
+        // only one element inline, everything else has to go to the heap
+        auto parsed = rep<1>(hybrid_optimization, elementParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_reservecapacity_() {
+        auto parsed = rep(hybrid_optimization, elementParserCreator_(), 100)(input_);
+        expectation_(parsed);
+    }
+
     constexpr void test_compiletime_customcontainer_() {
         auto parsed = rep<cvector<parser_result_t<ElementParser>, 1024>>(elementParserCreator_())(input_);
         expectation_(parsed);
@@ -2125,13 +2255,15 @@ TEST(RepParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_accumulato
 namespace test_rep1_type {
     // compiletime / runtime overloads
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(compiletime_optimization, string("Elem"))(std::declval<Input>()).result())>>, cvector<std::string_view, 1024>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(compiletime_optimization, integer())(std::declval<Input>()).result())>>, cvector<long long, 1024>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(compiletime_optimization, integer())(std::declval<Input>()).result())>>, cvector<int64_t, 1024>>::value);
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(runtime_optimization, string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(runtime_optimization, integer())(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(runtime_optimization, integer())(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1(hybrid_optimization, string("Elem"))(std::declval<Input>()).result())>>, small_vector<std::string_view, 8>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1<2>(hybrid_optimization, integer())(std::declval<Input>()).result())>>, small_vector<int64_t, 2>>::value);
 
     // custom container variant
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1<std::vector<std::string_view>>(string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string_view>>::value);
-    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1<std::vector<long long>>(integer())(std::declval<Input>()).result())>>, std::vector<long long>>::value);
+    static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1<std::vector<int64_t>>(integer())(std::declval<Input>()).result())>>, std::vector<int64_t>>::value);
 
     // custom container variant with parser and container having non-matching but convertible result types   
     static_assert(std::is_same<std::remove_cv_t<std::remove_reference_t<decltype(rep1<std::vector<std::string>>(string("Elem"))(std::declval<Input>()).result())>>, std::vector<std::string>>::value);
@@ -2166,6 +2298,9 @@ public:
         test_runtime_cvector_();
         test_runtime_stdvector_();
         test_runtime_stdvector_reservecapacity_();
+        test_runtime_smallvector_();
+        test_runtime_smallvector_spilling_();
+        test_runtime_smallvector_reservecapacity_();
         test_runtime_customcontainer_cvector_();
         test_runtime_customcontainer_cvector_reservecapacity_();
         test_runtime_customcontainer_stdvector_();
@@ -2196,6 +2331,22 @@ private:
         expectation_(parsed);
     }
 
+    void test_runtime_smallvector_() {
+        auto parsed = rep1(hybrid_optimization, elementParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_spilling_() {
+        // only one element inline, everything else has to go to the heap
+        auto parsed = rep1<1>(hybrid_optimization, elementParserCreator_())(input_);
+        expectation_(parsed);
+    }
+
+    void test_runtime_smallvector_reservecapacity_() {
+        auto parsed = rep1(hybrid_optimization, elementParserCreator_(), 100)(input_);
+        expectation_(parsed);
+    }
+
     constexpr void test_compiletime_customcontainer_() {
         auto parsed = rep1<cvector<parser_result_t<ElementParser>, 1024>>(elementParserCreator_())(input_);
         expectation_(parsed);
@@ -2716,4 +2867,94 @@ TEST(Rep1ParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_accumulat
     EXPECT_EQ(0, move_count_separator);
 }
 
+namespace test_rep_counts_unit_results {
+    static_assert(std::is_same_v<ParseResult<unit_counter>, decltype(rep(compiletime_optimization, ignore(string("a")))(Input{""}))>);
+    constexpr auto parsed = repsep(compiletime_optimization, ignore(string("a")), string(","))(Input{"a,a,ab"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result().size() == 3);
+    static_assert(parsed.next().input == "b");
+}
+
+TEST(RepsepParserTest, countsUnitResults) {
+    const auto parsed = rep1(runtime_optimization, ignore(string("a")))(Input{"aaab"});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ(3, parsed.result().size());
+    EXPECT_EQ(0, rep(hybrid_optimization, ignore(string("a")))(Input{"b"}).result().size());
+}
+
+struct Element final {
+    char name;
+    int64_t value;
+
+    constexpr bool operator==(const Element&) const = default;
+};
+static_assert(details::parses_into<decltype(construct<Element>(alpha(), ignore(string("=")), integer())), Element>);
+
+namespace test_repsep_emplaces_elements {
+    constexpr auto parser = repsep(compiletime_optimization, construct<Element>(alpha(), ignore(string("=")), integer()), string(","));
+    constexpr auto parsed = parser(Input{"a=1,b=2,c=x"});
+    static_assert(parsed.is_success());
+    // The element that failed to parse at the end was removed again
+    static_assert(parsed.result().size() == 2);
+    static_assert(parsed.result()[0] == Element{'a', 1});
+    static_assert(parsed.result()[1] == Element{'b', 2});
+    static_assert(parsed.next().input == ",c=x");
+
+    constexpr auto partial_parser = repsep(compiletime_optimization, construct<Element>(alpha<PartialInput>(), ignore(string<PartialInput>("=")), integer<PartialInput>()), string<PartialInput>(","));
+    static_assert(partial_parser(PartialInput{"a=1,b=", 0, true}).is_need_more());
+}
+
+TEST(RepsepParserTest, emplacesElements) {
+    const auto parser = repsep(runtime_optimization, construct<Element>(alpha(), ignore(string("=")), integer()), string(","));
+    const auto parsed = parser(Input{"a=1,b=2,c=x"});
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ((std::vector<Element>{{'a', 1}, {'b', 2}}), parsed.result());
+
+    const auto parsed_hybrid = repsep<2>(hybrid_optimization, construct<Element>(alpha(), ignore(string("=")), integer()), string(","))(Input{"a=1,b=2,c=3,d"});
+    ASSERT_TRUE(parsed_hybrid.is_success());
+    EXPECT_EQ(3, parsed_hybrid.result().size());
+    EXPECT_EQ((Element{'c', 3}), parsed_hybrid.result()[2]);
+}
+
+namespace test_repsep_compiletime_capacity_overflow {
+    constexpr auto parser = repsep<2>(compiletime_optimization, alpha(), elem(','));
+    // Filling the cvector exactly is fine
+    static_assert(parser(Input{"a,b,1"}).is_success());
+    static_assert(parser(Input{"a,b,1"}).result().size() == 2);
+    // Running out of capacity is an error at the element that didn't fit
+    constexpr auto parsed = parser(Input{"a,b,c"});
+    static_assert(parsed.is_error());
+    static_assert(parsed.next().input == "c");
+
+    constexpr auto emplacing_parser = rep1<2>(compiletime_optimization, construct<Element>(alpha(), ignore(string("=")), integer()));
+    static_assert(emplacing_parser(Input{"a=1b=2"}).is_success());
+    static_assert(emplacing_parser(Input{"a=1b=2c"}).is_success());
+    static_assert(emplacing_parser(Input{"a=1b=2c=3"}).is_error());
+}
+
+TEST(RepsepParserTest, emplacingDoesntCopyOrMoveResultMoreThanAbsolutelyNecessary) {
+    constexpr auto parser_with_copycounting_result = [] (size_t* copy_count, size_t* move_count) {
+        return [=] (Input input) {
+          if (input.input.size() > 0 && input.input[0] == 'a') {
+              return ParseResult<copy_counting<int>>::success(Input{input.input.substr(1)}, 3, copy_count, move_count);
+          } else {
+              return ParseResult<copy_counting<int>>::failure(input);
+          }
+        };
+    };
+    struct CountingElement final {
+        // copy_counting isn't default constructible, but the emplaced element needs to be
+        std::optional<copy_counting<int>> value;
+    };
+
+    size_t copy_count = 0, move_count = 0;
+    const auto parsed = repsep(runtime_optimization, construct<CountingElement>(parser_with_copycounting_result(&copy_count, &move_count)), string(","), 3)(Input{"a,a,a"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(3, parsed.result().size());
+    EXPECT_EQ(0, copy_count);
+    // The first element is moved into the seq buffer, the element and the container.
+    // The others are moved into their element in the container directly.
+    EXPECT_EQ(3 + 1 + 1, move_count);
+}
+
 }
@@ -0,0 +1,124 @@
+#include "parsers/segmented_input.h"
+#include "parsers/alpha.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/match.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include "parsers/string.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace ctpc;
+
+namespace {
+
+// "key=123;" records
+constexpr auto record_parser() {
+    return seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>('='), integer<PartialInput>(), elem<PartialInput>(';'));
+}
+
+std::string make_records(size_t num_records) {
+    std::string result;
+    for (size_t i = 0; i < num_records; ++i) {
+        result += std::string(1 + i % 7, static_cast<char>('a' + i % 26)) + "=" + std::to_string(i * 7919) + ";";
+    }
+    return result;
+}
+
+// Splits the input into segments of random sizes, including empty ones
+std::vector<std::string_view> split(std::string_view input, size_t max_segment_size, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<std::string_view> result;
+    while (!input.empty()) {
+        const size_t size = std::min(input.size(), std::uniform_int_distribution<size_t>(0, max_segment_size)(random));
+        result.push_back(input.substr(0, size));
+        input.remove_prefix(size);
+    }
+    return result;
+}
+
+bool points_into(std::string_view inner, std::string_view outer) {
+    return std::less_equal<>()(outer.data(), inner.data()) && std::less_equal<>()(inner.data() + inner.size(), outer.data() + outer.size());
+}
+
+TEST(SegmentedInputTest, randomSegments) {
+    const std::string input = make_records(200);
+    for (size_t max_segment_size : {1, 3, 10, 100, 1000}) {
+        for (uint32_t seed = 0; seed < 5; ++seed) {
+            SCOPED_TRACE(std::to_string(max_segment_size) + "/" + std::to_string(seed));
+            const std::vector<std::string_view> segments = split(input, max_segment_size, seed);
+            segmented_input segmented(segments);
+            for (size_t i = 0; i < 200; ++i) {
+                auto parsed = segmented.next(record_parser());
+                ASSERT_TRUE(parsed.is_success());
+                EXPECT_EQ(std::string(1 + i % 7, static_cast<char>('a' + i % 26)), std::get<0>(parsed.result()));
+                EXPECT_EQ(static_cast<int64_t>(i * 7919), std::get<2>(parsed.result()));
+            }
+            EXPECT_TRUE(segmented.at_end());
+        }
+    }
+}
+
+TEST(SegmentedInputTest, recordsInsideSegmentsAreZeroCopy) {
+    const std::string first = "ab=1;cd=2;e";
+    const std::string second = "f=3;gh=4;";
+    const std::vector<std::string_view> segments = {first, second};
+    segmented_input segmented(segments);
+
+    auto record = segmented.next(record_parser());
+    EXPECT_EQ("ab", std::get<0>(record.result()));
+    EXPECT_TRUE(points_into(std::get<0>(record.result()), first));
+    EXPECT_EQ(0, segmented.scratch_size());
+
+    segmented.next(record_parser());
+
+    // "ef=3;" straddles the segments and is assembled in a scratch buffer
+    record = segmented.next(record_parser());
+    EXPECT_EQ("ef", std::get<0>(record.result()));
+    EXPECT_EQ(3, std::get<2>(record.result()));
+    EXPECT_FALSE(points_into(std::get<0>(record.result()), first));
+    EXPECT_FALSE(points_into(std::get<0>(record.result()), second));
+    EXPECT_LT(0, segmented.scratch_size());
+    EXPECT_GE(64 + 1, segmented.scratch_size());
+
+    record = segmented.next(record_parser());
+    EXPECT_EQ("gh", std::get<0>(record.result()));
+    EXPECT_TRUE(points_into(std::get<0>(record.result()), second));
+    EXPECT_TRUE(segmented.at_end());
+}
+
+TEST(SegmentedInputTest, straddlingStringLiteral) {
+    const std::vector<std::string_view> segments = {"Hel", "", "lo W", "orld"};
+    segmented_input segmented(segments);
+    auto parsed = segmented.next(string<PartialInput>("Hello World"));
+    ASSERT_TRUE(parsed.is_success());
+    EXPECT_EQ("Hello World", parsed.result());
+    EXPECT_TRUE(segmented.at_end());
+}
+
+TEST(SegmentedInputTest, failure) {
+    const std::vector<std::string_view> segments = {"ab=1;c", "d=x;"};
+    segmented_input segmented(segments);
+    EXPECT_TRUE(segmented.next(record_parser()).is_success());
+    EXPECT_TRUE(segmented.next(record_parser()).is_failure());
+    EXPECT_FALSE(segmented.at_end());
+}
+
+TEST(SegmentedInputTest, iovecs) {
+    std::string first = "12,3";
+    std::string second = "4,";
+    const std::vector<iovec> segments = {{first.data(), first.size()}, {second.data(), second.size()}};
+    segmented_input segmented(segments);
+    EXPECT_EQ(12, std::get<0>(segmented.next(seq(integer<PartialInput>(), elem<PartialInput>(','))).result()));
+    EXPECT_EQ(34, std::get<0>(segmented.next(seq(integer<PartialInput>(), elem<PartialInput>(','))).result()));
+    EXPECT_TRUE(segmented.at_end());
+}
+
+TEST(SegmentedInputTest, empty) {
+    segmented_input segmented(std::span<const std::string_view>{});
+    EXPECT_TRUE(segmented.at_end());
+    EXPECT_TRUE(segmented.next(elem<PartialInput>('a')).is_failure());
+}
+
+}
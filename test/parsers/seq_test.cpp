@@ -1,4 +1,5 @@
 #include "parsers/seq.h"
+#include "parsers/basic_parsers.h"
 #include "parsers/string.h"
 #include "parsers/integer.h"
 #include "testutils/move_helpers.h"
@@ -111,6 +112,110 @@ namespace test_seq_movableonly_error {
     static_assert(parsed.next().input == "ABCDA23FGH");
 }
 
+namespace test_seq_ignore {
+    constexpr auto parsed = seq(string("ABC"), ignore(string("DE")), integer())(Input{"ABCDE23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<std::tuple<std::string_view, int64_t>>, decltype(parsed)>);
+    static_assert(parsed.result() == std::tuple<std::string_view, int64_t>{"ABC", 23});
+    static_assert(parsed.next().input == "FGH");
+}
+namespace test_seq_ignore_all {
+    constexpr auto parsed = seq(ignore(string("ABC")), ignore(integer()))(Input{"ABC23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == std::tuple<>());
+    static_assert(parsed.next().input == "FGH");
+}
+namespace test_seq_ignore_failure {
+    constexpr auto parsed = seq(string("ABC"), ignore(string("DE")), integer())(Input{"ABCDA23FGH"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "A23FGH");
+}
+namespace test_seq_ignore_error {
+    constexpr auto parsed = seq(string("ABC"), ignore(error_parser(string("DA"), string("DE"))), integer())(Input{"ABCDA23FGH"});
+    static_assert(parsed.is_error());
+    static_assert(parsed.next().input == "23FGH");
+}
+namespace test_seq_ignore_need_more {
+    constexpr auto parsed = seq(string<PartialInput>("ABC"), ignore(integer<PartialInput>()))(PartialInput{"ABC23", 0, true});
+    static_assert(parsed.is_need_more());
+    static_assert(parsed.next().input == "");
+}
+namespace test_seq_drops_unit_results {
+    constexpr auto parsed = seq(success(), string("ABC"), success())(Input{"ABCDE"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == std::tuple<std::string_view>{"ABC"});
+    static_assert(seq(string("ABC"), error())(Input{"ABCDE"}).is_error());
+}
+namespace test_ignore_alone {
+    constexpr auto parsed = ignore(integer())(Input{"23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<unit>, decltype(parsed)>);
+    static_assert(parsed.next().input == "FGH");
+}
+namespace test_keep_left {
+    constexpr auto parsed = keep_left(integer(), string(";"))(Input{"23;FGH"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 23);
+    static_assert(parsed.next().input == "FGH");
+    static_assert(keep_left(integer(), string(";"))(Input{"23,FGH"}).is_failure());
+}
+namespace test_keep_right {
+    constexpr auto parsed = keep_right(string("x="), integer())(Input{"x=23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.result() == 23);
+    static_assert(parsed.next().input == "FGH");
+    static_assert(keep_right(string("x="), integer())(Input{"y=23"}).is_failure());
+}
+namespace test_keep_left_unit {
+    constexpr auto parsed = keep_left(success<Input>(), elem('a'))(Input{"ab"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<unit>, decltype(parsed)>);
+    static_assert(parsed.next().input == "b");
+    static_assert(keep_left(success<Input>(), elem('a'))(Input{"b"}).is_failure());
+}
+namespace test_keep_right_unit {
+    constexpr auto parsed = keep_right(elem('a'), success<Input>())(Input{"ab"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<unit>, decltype(parsed)>);
+    static_assert(parsed.next().input == "b");
+    static_assert(keep_right(elem('a'), success<Input>())(Input{"b"}).is_failure());
+}
+namespace test_keep_recognize {
+    static_assert(recognize(keep_left(integer(), string(";")))(Input{"23;FGH"}).next().input == "FGH");
+    static_assert(recognize(keep_left(integer(), string(";")))(Input{"23,FGH"}).is_failure());
+    static_assert(recognize(keep_right(string("x="), integer()))(Input{"x=23FGH"}).next().input == "FGH");
+    static_assert(recognize(keep_right(string("x="), integer()))(Input{"y=23"}).is_failure());
+}
+
+struct Constructed final {
+    std::string_view name;
+    int64_t value;
+
+    constexpr bool operator==(const Constructed&) const = default;
+};
+namespace test_construct {
+    constexpr auto parsed = construct<Constructed>(string("ABC"), ignore(string("=")), integer())(Input{"ABC=23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(std::is_same_v<const ParseResult<Constructed>, decltype(parsed)>);
+    static_assert(parsed.result() == Constructed{"ABC", 23});
+    static_assert(parsed.next().input == "FGH");
+}
+namespace test_construct_failure {
+    constexpr auto parsed = construct<Constructed>(string("ABC"), ignore(string("=")), integer())(Input{"ABC=FGH"});
+    static_assert(parsed.is_failure());
+    static_assert(parsed.next().input == "FGH");
+}
+namespace test_construct_error {
+    constexpr auto parsed = construct<Constructed>(error_parser(string("AC"), string("AB")), integer())(Input{"ACDE"});
+    static_assert(parsed.is_error());
+    static_assert(parsed.next().input == "DE");
+}
+namespace test_construct_recognize {
+    constexpr auto parsed = recognize(construct<Constructed>(string("ABC"), ignore(string("=")), integer()))(Input{"ABC=23FGH"});
+    static_assert(parsed.is_success());
+    static_assert(parsed.next().input == "FGH");
+}
+
 TEST(SeqParserTest, doesntCopyOrMoveParsersMoreThanAbsolutelyNecessary) {
     testDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary(
         [] (auto&&... args) {return seq(std::forward<decltype(args)>(args)...); },
@@ -121,6 +226,14 @@ TEST(SeqParserTest, doesntCopyOrMoveParsersMoreThanAbsolutelyNecessary) {
     );
 }
 
+TEST(SeqParserTest, ignoreDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary) {
+    testDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary(
+        [] (auto&& parser) {return ignore(std::forward<decltype(parser)>(parser)); },
+        {ctpc::Input{""}, ctpc::Input{"AB"}, ctpc::Input{"AC"}},
+        [] () {return string("AB");}
+    );
+}
+
 namespace test_seq_works_with_movable_only_result {
     constexpr auto parser_with_movable_only_result = map(elem('a'), [] (auto) {return movable_only<int>(3);});
     constexpr auto parsed = seq(parser_with_movable_only_result)(Input{"aa"});
@@ -173,4 +286,84 @@ TEST(SeqParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_failure) {
     EXPECT_EQ(0, move_count_3);
 }
 
+TEST(SeqParserTest, keepDoesntCopyOrMoveResultMoreThanAbsolutelyNecessary) {
+    constexpr auto parser_with_copycounting_result = [](size_t *copy_count, size_t *move_count) {
+        return [=](Input input) {
+            if (input.input.size() > 0) {
+                return ParseResult<copy_counting<int>>::success(Input{input.input.substr(1)}, 3, copy_count, move_count);
+            } else {
+                return ParseResult<copy_counting<int>>::failure(input);
+            }
+        };
+    };
+
+    size_t copy_count_left = 0, move_count_left = 0, copy_count_right = 0, move_count_right = 0;
+
+    auto parsed_left = keep_left(parser_with_copycounting_result(&copy_count_left, &move_count_left), elem('a'))(Input{"aa"});
+    EXPECT_TRUE(parsed_left.is_success());
+    EXPECT_EQ(0, copy_count_left);
+    EXPECT_EQ(1, move_count_left); // Move once when returning the left result after parsing the right one
+
+    auto parsed_right = keep_right(elem('a'), parser_with_copycounting_result(&copy_count_right, &move_count_right))(Input{"aa"});
+    EXPECT_TRUE(parsed_right.is_success());
+    EXPECT_EQ(0, copy_count_right);
+    EXPECT_EQ(0, move_count_right); // The right result is returned as parsed
+}
+
+TEST(SeqParserTest, constructDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary) {
+    testDoesntCopyOrMoveParsersMoreThanAbsolutelyNecessary(
+        [] (auto&&... args) {return construct<std::tuple<std::string_view, std::string_view, std::string_view>>(std::forward<decltype(args)>(args)...); },
+        {ctpc::Input{""}, ctpc::Input{"ABCDE"}, ctpc::Input{"ABC_"}, ctpc::Input{"ABCDEF"}},
+        [] () {return string("AB");},
+        [] () {return string("CD");},
+        [] () {return string("EF");}
+    );
+}
+
+TEST(SeqParserTest, constructDoesntCopyOrMoveResultMoreThanAbsolutelyNecessary) {
+    constexpr auto parser_with_copycounting_result = [](size_t *copy_count, size_t *move_count) {
+        return [=](Input input) {
+            if (input.input.size() > 0) {
+                return ParseResult<copy_counting<int>>::success(Input{input.input.substr(1)}, 3, copy_count, move_count);
+            } else {
+                return ParseResult<copy_counting<int>>::failure(input);
+            }
+        };
+    };
+    struct Aggregate final {
+        copy_counting<int> first;
+        copy_counting<int> second;
+    };
+
+    size_t copy_count_1 = 0, move_count_1 = 0, copy_count_2 = 0, move_count_2 = 0;
+
+    auto parsed = construct<Aggregate>(parser_with_copycounting_result(&copy_count_1, &move_count_1), parser_with_copycounting_result(&copy_count_2, &move_count_2))(Input{"aaaa"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(0, copy_count_1);
+    EXPECT_EQ(2, move_count_1); // Move once when parsed and once into the aggregate
+    EXPECT_EQ(0, copy_count_2);
+    EXPECT_EQ(2, move_count_2); // Move once when parsed and once into the aggregate
+}
+
+TEST(SeqParserTest, doesntCopyOrMoveResultMoreThanAbsolutelyNecessary_ignored) {
+    constexpr auto parser_with_copycounting_result = [](size_t *copy_count, size_t *move_count) {
+        return [=](Input input) {
+            if (input.input.size() > 0) {
+                return ParseResult<copy_counting<int>>::success(Input{input.input.substr(1)}, 3, copy_count, move_count);
+            } else {
+                return ParseResult<copy_counting<int>>::failure(input);
+            }
+        };
+    };
+
+    size_t copy_count_1 = 0, move_count_1 = 0, copy_count_2 = 0, move_count_2 = 0;
+
+    auto parsed = seq(ignore(parser_with_copycounting_result(&copy_count_1, &move_count_1)), parser_with_copycounting_result(&copy_count_2, &move_count_2))(Input{"aaaa"});
+    EXPECT_TRUE(parsed.is_success());
+    EXPECT_EQ(0, copy_count_1);
+    EXPECT_EQ(0, move_count_1); // Ignored results are dropped where they're parsed
+    EXPECT_EQ(0, copy_count_2);
+    EXPECT_EQ(2, move_count_2); // Move once when parsed and once when returning the tuple
+}
+
 }
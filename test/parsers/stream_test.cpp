@@ -0,0 +1,153 @@
+#include "parsers/stream.h"
+#include "parsers/alpha.h"
+#include "parsers/alternative.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/match.h"
+#include "parsers/opt.h"
+#include "parsers/phrase.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include "parsers/string.h"
+#include <gtest/gtest.h>
+
+using namespace ctpc;
+
+namespace {
+
+constexpr PartialInput partial(std::string_view input) {
+    return PartialInput{input, 0, true};
+}
+
+namespace test_elem_partial {
+    static_assert(elem<PartialInput>('a')(partial("")).is_need_more());
+    static_assert(elem<PartialInput>('a')(partial("a")).is_success());
+    static_assert(elem<PartialInput>('a')(partial("b")).is_failure());
+    static_assert(elem('a')(Input{""}).is_failure());
+}
+
+namespace test_string_partial {
+    static_assert(string<PartialInput>("abc")(partial("ab")).is_need_more());
+    static_assert(string<PartialInput>("abc")(partial("ab")).next().input == "");
+    static_assert(string<PartialInput>("abc")(partial("abc")).is_success());
+    static_assert(string<PartialInput>("abc")(partial("abd")).is_failure());
+    static_assert(string("abc")(Input{"ab"}).is_failure());
+}
+
+namespace test_integer_partial {
+    // The number could continue in the next chunk
+    static_assert(integer<PartialInput>()(partial("123")).is_need_more());
+    static_assert(integer<PartialInput>()(partial("")).is_need_more());
+    static_assert(integer<PartialInput>()(partial("123,")).result() == 123);
+    static_assert(integer<PartialInput>()(partial("a")).is_failure());
+    static_assert(integer()(Input{"123"}).result() == 123);
+}
+
+namespace test_whitespaces_partial {
+    static_assert(whitespaces<PartialInput>()(partial("  ")).is_need_more());
+    static_assert(whitespaces<PartialInput>()(partial("  a")).is_success());
+}
+
+namespace test_combinators_partial {
+    static_assert(seq(integer<PartialInput>(), elem<PartialInput>(','))(partial("12,")).is_success());
+    static_assert(seq(integer<PartialInput>(), elem<PartialInput>(','))(partial("12")).is_need_more());
+    static_assert(seq(integer<PartialInput>(), elem<PartialInput>(','))(partial("a")).is_failure());
+    // An alternative can't be decided before the first parser decided
+    static_assert(alternative(string<PartialInput>("abc"), string<PartialInput>("ab"))(partial("ab")).is_need_more());
+    static_assert(alternative(string<PartialInput>("abc"), string<PartialInput>("ab"))(partial("abd")).result() == "ab");
+    static_assert(opt(string<PartialInput>("abc"))(partial("a")).is_need_more());
+    static_assert(match(seq(integer<PartialInput>(), elem<PartialInput>(',')))(partial("12")).is_need_more());
+    static_assert(map(integer<PartialInput>(), [] (int64_t v) {return v + 1;})(partial("1")).is_need_more());
+    static_assert(rep(compiletime_optimization, seq(integer<PartialInput>(), elem<PartialInput>(',')))(partial("1,2,3")).is_need_more());
+    static_assert(rep(compiletime_optimization, seq(integer<PartialInput>(), elem<PartialInput>(',')))(partial("1,2,a")).result().size() == 2);
+    static_assert(repsep(compiletime_optimization, integer<PartialInput>(), elem<PartialInput>(','))(partial("1,2,")).is_need_more());
+    // More input would make the phrase fail
+    static_assert(phrase(elem<PartialInput>('a'))(partial("a")).is_need_more());
+    static_assert(phrase(elem('a'))(Input{"a"}).is_success());
+}
+
+// "123\n" records
+constexpr auto line_parser() {
+    return map(seq(integer<PartialInput>(), elem<PartialInput>('\n')), [] (auto&& parsed) {return std::get<0>(parsed);});
+}
+
+std::string make_lines(size_t num_lines) {
+    std::string result;
+    for (size_t i = 0; i < num_lines; ++i) {
+        result += std::to_string(i * 7919) + "\n";
+    }
+    return result;
+}
+
+TEST(StreamTest, allChunkSizes) {
+    const std::string input = make_lines(200);
+    for (size_t chunk_size = 1; chunk_size <= 20; ++chunk_size) {
+        SCOPED_TRACE(chunk_size);
+        stream_parser stream(line_parser());
+        std::vector<int64_t> parsed;
+        for (size_t pos = 0; pos < input.size(); pos += chunk_size) {
+            stream.feed(std::string_view(input).substr(pos, chunk_size));
+            while (true) {
+                auto record = stream.next();
+                if (!record.is_success()) {
+                    EXPECT_TRUE(record.is_need_more());
+                    break;
+                }
+                parsed.push_back(record.result());
+            }
+            // Consumed records are released
+            EXPECT_LE(stream.buffered_size(), 8 + chunk_size);
+        }
+        stream.finish();
+        EXPECT_TRUE(stream.at_end());
+        ASSERT_EQ(200, parsed.size());
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            EXPECT_EQ(static_cast<int64_t>(i * 7919), parsed[i]);
+        }
+    }
+}
+
+TEST(StreamTest, numberSplitAcrossChunks) {
+    stream_parser stream(line_parser());
+    stream.feed("12");
+    EXPECT_TRUE(stream.next().is_need_more());
+    EXPECT_TRUE(stream.next().is_need_more());
+    stream.feed("34\n5");
+    auto record = stream.next();
+    EXPECT_TRUE(record.is_success());
+    EXPECT_EQ(1234, record.result());
+    EXPECT_TRUE(stream.next().is_need_more());
+    EXPECT_EQ(1, stream.buffered_size());
+}
+
+TEST(StreamTest, lastRecordAfterFinish) {
+    // The last record doesn't need a line break
+    stream_parser stream(seq(integer<PartialInput>(), opt(elem<PartialInput>('\n'))));
+    stream.feed("12\n34");
+    EXPECT_EQ(12, std::get<0>(stream.next().result()));
+    EXPECT_TRUE(stream.next().is_need_more());
+    stream.finish();
+    EXPECT_FALSE(stream.at_end());
+    EXPECT_EQ(34, std::get<0>(stream.next().result()));
+    EXPECT_TRUE(stream.at_end());
+}
+
+TEST(StreamTest, failureDoesntConsume) {
+    stream_parser stream(line_parser());
+    stream.feed("12\nab\n");
+    EXPECT_TRUE(stream.next().is_success());
+    EXPECT_TRUE(stream.next().is_failure());
+    EXPECT_EQ(3, stream.buffered_size());
+}
+
+TEST(StreamTest, stringViewsPointIntoWindow) {
+    stream_parser stream(seq(match(rep(runtime_optimization, alpha<PartialInput>())), elem<PartialInput>(';')));
+    stream.feed("ab");
+    EXPECT_TRUE(stream.next().is_need_more());
+    stream.feed("c;de");
+    auto record = stream.next();
+    EXPECT_TRUE(record.is_success());
+    EXPECT_EQ("abc", std::get<0>(record.result()));
+}
+
+}
@@ -0,0 +1,188 @@
+#include "parsers/structural_index.h"
+#include "parsers/elem.h"
+#include "parsers/integer.h"
+#include "parsers/match.h"
+#include "parsers/phrase.h"
+#include "parsers/recognize.h"
+#include "parsers/rep.h"
+#include "parsers/seq.h"
+#include "parsers/padded_input.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace ctpc;
+
+namespace {
+
+namespace test_next {
+    constexpr bool check() {
+        constexpr std::string_view text = "ab,c(d),\ne";
+        const structural_index index(Input{text}, ",()\n");
+        return index.next(0) == 2 && index.next(2) == 2 && index.next(3) == 4 && index.next(5) == 6 && index.next(9) == std::string_view::npos
+            && index.next(0, "\n") == 8 && index.next(3, ",") == 7 && index.next(100) == std::string_view::npos
+            && index.is_structural(4) && !index.is_structural(5);
+    }
+    static_assert(check());
+}
+namespace test_quotes {
+    constexpr bool check() {
+        constexpr std::string_view text = R"(a,"b,c",d,"e""f,g",h)";
+        const structural_index index(Input{text}, ",", '"');
+        // The quotes are structural, the commas between them aren't
+        return index.next(0) == 1 && index.next(2) == 2 && index.next(3) == 6 && index.next(7) == 7 && index.next(8) == 9
+            && index.next(11) == 12 && index.next(13) == 13 && index.next(14) == 17 && index.next(18) == 18
+            && index.next(0, ",") == 1 && index.next(2, ",") == 7 && index.next(10, ",") == 18;
+    }
+    static_assert(check());
+}
+namespace test_skip_to {
+    constexpr bool check() {
+        constexpr std::string_view text = "ab,cd\nef";
+        const structural_index index(Input{text}, ",\n");
+        const auto parsed = seq(skip_to(index, ",\n"), elem(','), skip_to(index, ",\n"), elem('\n'), skip_to(index, ",\n"))(Input{text});
+        return parsed.is_success() && std::get<0>(parsed.result()) == "ab" && std::get<2>(parsed.result()) == "cd" && std::get<4>(parsed.result()) == "ef"
+            && parsed.next().input == "";
+    }
+    static_assert(check());
+
+    // skip_to never goes beyond the end of its input, even if the indexed text continues
+    constexpr bool check_input_end() {
+        constexpr std::string_view text = "abcdef,g";
+        const structural_index index(Input{text}, ",");
+        const auto parsed = skip_to(index, ",")(Input{text.substr(1, 3)});
+        return parsed.is_success() && parsed.result() == "bcd";
+    }
+    static_assert(check_input_end());
+
+    // The field could continue in the next chunk of a partial input
+    constexpr bool check_partial() {
+        constexpr std::string_view text = "ab,cd";
+        const structural_index index(Input{text}, ",");
+        const auto first = skip_to<PartialInput>(index, ",")(PartialInput{text, 0, true});
+        const auto last = skip_to<PartialInput>(index, ",")(PartialInput{text.substr(3), 0, true});
+        return first.is_success() && first.result() == "ab" && last.is_need_more() && last.next().input == "";
+    }
+    static_assert(check_partial());
+}
+namespace test_delimited {
+    constexpr bool check() {
+        constexpr std::string_view text = "12,34,5x,6";
+        const structural_index index(Input{text}, ",");
+        const auto numbers = repsep(compiletime_optimization, delimited(index, ",", integer()), elem(','));
+        const auto parsed = numbers(Input{text});
+        // "5x" isn't consumed completely, so the repetition stops before it
+        return parsed.is_success() && parsed.result().size() == 2 && parsed.result()[1] == 34 && parsed.next().input == ",5x,6";
+    }
+    static_assert(check());
+
+    constexpr bool check_nested() {
+        constexpr std::string_view text = "1,2;3;4,5";
+        const structural_index index(Input{text}, ",;");
+        const auto field = delimited(index, ",", repsep(compiletime_optimization, delimited(index, ",;", integer()), elem(';')));
+        const auto parsed = phrase(repsep(compiletime_optimization, field, elem(',')))(Input{text});
+        return parsed.is_success() && parsed.result().size() == 3 && parsed.result()[1].size() == 3 && parsed.result()[1][2] == 4;
+    }
+    static_assert(check_nested());
+
+    // On the whole input, the parser would run past the delimiter
+    constexpr bool check_doesnt_run_past_delimiter() {
+        constexpr std::string_view text = "12,34;5";
+        const structural_index index(Input{text}, ",");
+        const auto parsed = delimited(index, ",", match(rep(compiletime_optimization, elem([] (char c) {return c != ';';}))))(Input{text});
+        return parsed.is_success() && parsed.result() == "12" && parsed.next().input == ",34;5";
+    }
+    static_assert(check_doesnt_run_past_delimiter());
+
+    constexpr bool check_partial() {
+        constexpr std::string_view text = "12,34";
+        const structural_index index(Input{text}, ",");
+        const auto field = delimited(index, ",", integer<PartialInput>());
+        return field(PartialInput{text, 0, true}).result() == 12 && field(PartialInput{text.substr(3), 0, true}).is_need_more();
+    }
+    static_assert(check_partial());
+}
+namespace test_recognize_delimited {
+    constexpr bool check() {
+        constexpr std::string_view text = "12,34,5x,6";
+        const structural_index index(Input{text}, ",");
+        return recognize(delimited(index, ",", integer()))(Input{text}).next().input == ",34,5x,6"
+            && recognize(delimited(index, ",", integer()))(Input{text.substr(6)}).is_failure();
+    }
+    static_assert(check());
+}
+namespace test_temporary_index_doesnt_compile {
+    // The parsers keep a reference to the index
+    template<class Index> concept can_skip_to = requires (Index&& index) { skip_to(std::forward<Index>(index), ","); };
+    template<class Index> concept can_delimit = requires (Index&& index) { delimited(std::forward<Index>(index), ",", integer()); };
+    static_assert(can_skip_to<const structural_index&> && !can_skip_to<structural_index>);
+    static_assert(can_delimit<const structural_index&> && !can_delimit<structural_index>);
+}
+
+// CSV with quoted fields, split with the index
+template<class InputT>
+std::vector<std::vector<std::string_view>> split_csv(const structural_index& index, InputT input) {
+    const auto record = repsep(runtime_optimization, skip_to<InputT>(index, ",\n"), elem<InputT>(','));
+    auto parsed = phrase(repsep(runtime_optimization, record, elem<InputT>('\n')))(input);
+    EXPECT_TRUE(parsed.is_success());
+    return parsed.result();
+}
+
+TEST(StructuralIndexTest, tooManyStructuralCharacters) {
+    const std::string_view text = "a,b;c";
+    EXPECT_NO_THROW(structural_index(Input{text}, ",;:|()[]"));
+    EXPECT_THROW(structural_index(Input{text}, ",;:|()[]{"), std::invalid_argument);
+}
+
+TEST(StructuralIndexTest, csv) {
+    std::string text;
+    for (size_t i = 0; i < 1000; ++i) {
+        text += std::to_string(i) + ",\"quoted, with comma\"," + std::string(i % 100, 'x') + "\n";
+    }
+    text += "last";
+    const padded_input padded = padded_input::copy_from(text);
+    const structural_index index(padded.input(), ",\n", '"');
+    const auto records = split_csv(index, padded.input());
+    ASSERT_EQ(1001, records.size());
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(3, records[i].size());
+        EXPECT_EQ(std::to_string(i), records[i][0]);
+        EXPECT_EQ("\"quoted, with comma\"", records[i][1]);
+        EXPECT_EQ(std::string(i % 100, 'x'), records[i][2]);
+    }
+    EXPECT_EQ(1, records[1000].size());
+    EXPECT_EQ("last", records[1000][0]);
+}
+
+TEST(StructuralIndexTest, inputOutsideOfIndexedText) {
+    const std::string text = "12,34";
+    const std::string other = text;
+    const structural_index index(Input{text}, ",");
+    EXPECT_THROW(skip_to(index, ",")(Input{other}), std::invalid_argument);
+    EXPECT_THROW(delimited(index, ",", integer())(Input{other}), std::invalid_argument);
+    EXPECT_EQ(3, index.offset_of(Input{std::string_view(text).substr(3)}));
+}
+
+TEST(StructuralIndexTest, sameAsScalarScan) {
+    for (cpu_level level : {cpu_level::SCALAR, cpu_level::SSE2, cpu_level::AVX2, cpu_level::AVX512BW}) {
+        if (level > detect_cpu_level()) {
+            continue;
+        }
+        kernels::force_cpu_level(level);
+        std::string text;
+        for (size_t i = 0; i < 500; ++i) {
+            text += (i % 7 == 0) ? ',' : (i % 13 == 0) ? '"' : 'a';
+        }
+        const structural_index index(Input{text}, ",", '"');
+        bool in_quotes = false;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '"') {
+                in_quotes = !in_quotes;
+            }
+            const bool expected = text[i] == '"' || (text[i] == ',' && !in_quotes);
+            EXPECT_EQ(expected, index.is_structural(i)) << i;
+        }
+    }
+    kernels::reset_cpu_level();
+}
+
+}
@@ -7,9 +7,6 @@
 template<class Parser>
 class movable_only final {
 public:
-    // TODO Remove default constructor once not needed by cvector anymore
-    constexpr explicit movable_only(): _parser() {}
-
     constexpr explicit movable_only(Parser parser)
     : _parser(std::move(parser)) {}
 
@@ -30,9 +27,6 @@ private:
 template<class Parser>
 class copy_counting final {
 public:
-    // TODO Remove default constructor once not needed by cvector anymore
-    constexpr explicit copy_counting(): _copy_counter(nullptr), _move_counter(nullptr), _parser() {}
-
     constexpr explicit copy_counting(Parser parser, size_t* copy_counter, size_t* move_counter)
     : _copy_counter(copy_counter), _move_counter(move_counter), _parser(std::move(parser)) {}
 
@@ -1,5 +1,7 @@
 #include "parsers/utils/cvector.h"
+#include "../testutils/move_helpers.h"
 #include <gtest/gtest.h>
+#include <string>
 
 using namespace ctpc;
 
@@ -28,6 +30,22 @@ constexpr cvector<int, 1024> make_cvector_maxelem_increasing_values() {
   return result;
 }
 
+class NonDefaultConstructible final {
+public:
+  constexpr explicit NonDefaultConstructible(int value): value_(value) {}
+  constexpr int value() const { return value_; }
+private:
+  int value_;
+};
+
+constexpr cvector<NonDefaultConstructible, 1024> make_nondefaultconstructible_cvector(size_t size) {
+  cvector<NonDefaultConstructible, 1024> result;
+  for (size_t i = 0; i < size; ++i) {
+    result.push_back(NonDefaultConstructible(i));
+  }
+  return result;
+}
+
 template<class Condition, size_t... indices>
 constexpr bool true_for_each_index(Condition&& condition, std::index_sequence<indices...>) {
     return (condition(indices) && ...);
@@ -214,6 +232,42 @@ namespace push_back_test {
   }
 }
 
+namespace emplace_back_test {
+  constexpr cvector<int, 1024> make_emplaced() {
+    cvector<int, 1024> result = make_cvector(1, 2, 3);
+    // emplace_back() without arguments value-initializes the element, also where pop_back() left the old one in place
+    result.pop_back();
+    result.emplace_back();
+    result.emplace_back(5) += 1;
+    return result;
+  }
+  constexpr cvector<int, 1024> emplaced = make_emplaced();
+  static_assert(4 == emplaced.size());
+  static_assert(2 == emplaced[1]);
+  static_assert(0 == emplaced[2]);
+  static_assert(6 == emplaced[3]);
+
+  constexpr cvector<NonDefaultConstructible, 1024> make_emplaced_nondefaultconstructible() {
+    cvector<NonDefaultConstructible, 1024> result;
+    result.emplace_back(3);
+    return result;
+  }
+  static_assert(3 == make_emplaced_nondefaultconstructible()[0].value());
+
+  TEST(CVectorTest_EmplaceBack, overCapacity) {
+    cvector<int, 2> obj;
+    obj.emplace_back(1);
+    obj.emplace_back(2);
+    EXPECT_ANY_THROW(obj.emplace_back(3));
+  }
+}
+
+namespace full_test {
+  static_assert(!cvector<int, 2>().full());
+  static_assert(!cvector<int, 2>{1}.full());
+  static_assert(cvector<int, 2>{1, 2}.full());
+}
+
 namespace to_vector_test {
   constexpr cvector<int, 1024> empty;
   TEST(CVectorTest_ToVector, empty) {
@@ -293,4 +347,148 @@ namespace aggregate_initialization_test {
     static_assert(3 == two_elem_2[1]);
 }
 
+namespace pop_back_test {
+  constexpr cvector<int, 1024> make_popped(size_t size, size_t num_popped) {
+    cvector<int, 1024> result = make_cvector_maxelem_increasing_values();
+    while (result.size() > size) {
+      result.pop_back();
+    }
+    for (size_t i = 0; i < num_popped; ++i) {
+      result.pop_back();
+    }
+    return result;
+  }
+  constexpr cvector<int, 1024> popped = make_popped(3, 1);
+  static_assert(2 == popped.size());
+  static_assert(0 == popped[0]);
+  static_assert(1 == popped[1]);
+
+  TEST(CVectorTest_PopBack, pushAfterPop) {
+    cvector<int, 1024> obj = make_cvector(1, 2, 3);
+    obj.pop_back();
+    obj.push_back(5);
+    EXPECT_EQ(3, obj.size());
+    EXPECT_EQ(2, obj[1]);
+    EXPECT_EQ(5, obj[2]);
+  }
+
+#if CTPC_ASSERT_LEVEL >= CTPC_ASSERT_LEVEL_DEBUG
+  TEST(CVectorTest_PopBack, popEmpty) {
+    cvector<int, 1024> obj;
+    EXPECT_ANY_THROW(obj.pop_back());
+    cvector<std::string, 1024> strings;
+    EXPECT_ANY_THROW(strings.pop_back());
+  }
+#endif
+}
+
+namespace storage_test {
+  // Only element types that need it are stored in slots, everything else in a std::array
+  static_assert(std::is_same_v<int*, cvector<int, 1024>::iterator>);
+  static_assert(std::is_same_v<const std::string_view*, cvector<std::string_view, 1024>::const_iterator>);
+  static_assert(!std::is_same_v<NonDefaultConstructible*, cvector<NonDefaultConstructible, 1024>::iterator>);
+  static_assert(!std::is_same_v<std::string*, cvector<std::string, 1024>::iterator>);
+  static_assert(std::is_trivially_copyable_v<cvector<int, 1024>>);
+}
+
+namespace non_default_constructible_test {
+  constexpr cvector<NonDefaultConstructible, 1024> empty;
+  static_assert(0 == empty.size());
+  static_assert(empty.begin() == empty.end());
+
+  constexpr cvector<NonDefaultConstructible, 1024> three_elem = make_nondefaultconstructible_cvector(3);
+  static_assert(3 == three_elem.size());
+  static_assert(0 == three_elem[0].value());
+  static_assert(2 == three_elem[2].value());
+  static_assert(3 == three_elem.end() - three_elem.begin());
+  static_assert(1 == (three_elem.begin()+1)->value());
+  static_assert(2 == three_elem.get_unsafe(2).value());
+
+  constexpr cvector<NonDefaultConstructible, 1024> max_elem = make_nondefaultconstructible_cvector(1024);
+  static_assert(1024 == max_elem.size());
+  static_assert(1023 == max_elem[1023].value());
+
+  constexpr int copy_and_pop() {
+    cvector<NonDefaultConstructible, 1024> original = make_nondefaultconstructible_cvector(3);
+    cvector<NonDefaultConstructible, 1024> copy = original;
+    copy.pop_back();
+    copy.push_back(NonDefaultConstructible(10));
+    return original[2].value() + copy[2].value() + copy.size();
+  }
+  static_assert(2 + 10 + 3 == copy_and_pop());
+
+  class MovableOnly final {
+  public:
+    constexpr explicit MovableOnly(int value): value_(value) {}
+    MovableOnly(const MovableOnly&) = delete;
+    MovableOnly(MovableOnly&&) = default;
+    MovableOnly& operator=(MovableOnly&&) = default;
+    constexpr int value() const { return value_; }
+  private:
+    int value_;
+  };
+  static_assert(!std::is_copy_constructible_v<cvector<MovableOnly, 1024>>);
+  constexpr int move_movable_only() {
+    cvector<MovableOnly, 1024> original;
+    original.push_back(MovableOnly(3));
+    original.push_back(MovableOnly(4));
+    cvector<MovableOnly, 1024> moved = std::move(original);
+    return 10 * moved[0].value() + moved[1].value();
+  }
+  static_assert(34 == move_movable_only());
+
+  constexpr cvector<NonDefaultConstructible, 1024> from_initializer_list{NonDefaultConstructible(4), NonDefaultConstructible(3)};
+  static_assert(2 == from_initializer_list.size());
+  static_assert(4 == from_initializer_list[0].value());
+  static_assert(3 == from_initializer_list[1].value());
+
+  TEST(CVectorTest_NonDefaultConstructible, mutable) {
+    cvector<NonDefaultConstructible, 1024> obj = make_nondefaultconstructible_cvector(3);
+    EXPECT_ANY_THROW(obj[3]);
+    obj[1] = NonDefaultConstructible(7);
+    int sum = 0;
+    for (const NonDefaultConstructible& elem : obj) {
+      sum += elem.value();
+    }
+    EXPECT_EQ(0 + 7 + 2, sum);
+  }
+
+  TEST(CVectorTest_NonDefaultConstructible, overCapacity) {
+    cvector<NonDefaultConstructible, 2> obj;
+    obj.push_back(NonDefaultConstructible(1));
+    obj.push_back(NonDefaultConstructible(2));
+    EXPECT_ANY_THROW(obj.push_back(NonDefaultConstructible(3)));
+  }
+
+  TEST(CVectorTest_NonDefaultConstructible, movableOnly) {
+    cvector<movable_only<int>, 1024> obj;
+    obj.push_back(movable_only<int>(1));
+    obj.push_back(movable_only<int>(2));
+    cvector<movable_only<int>, 1024> moved = std::move(obj);
+    EXPECT_EQ(2, moved.size());
+    moved.pop_back();
+    EXPECT_EQ(1, moved.size());
+  }
+}
+
+namespace non_trivially_copyable_test {
+  TEST(CVectorTest_NonTriviallyCopyable, copyAndPop) {
+    cvector<std::string, 4> original;
+    original.push_back(std::string(100, 'a'));
+    original.push_back(std::string(100, 'b'));
+    cvector<std::string, 4> copy = original;
+    copy.pop_back();
+    copy.push_back(std::string(100, 'c'));
+    EXPECT_EQ(std::string(100, 'b'), original[1]);
+    EXPECT_EQ(std::string(100, 'a'), copy[0]);
+    EXPECT_EQ(std::string(100, 'c'), copy[1]);
+    copy = original;
+    EXPECT_EQ(2, copy.size());
+    EXPECT_EQ(std::string(100, 'b'), copy[1]);
+    cvector<std::string, 4> moved = std::move(copy);
+    EXPECT_EQ(2, moved.size());
+    EXPECT_EQ(std::string(100, 'a'), moved[0]);
+  }
+}
+
 }
@@ -0,0 +1,224 @@
+#include "parsers/utils/kernels.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace ctpc;
+using namespace ctpc::kernels;
+
+namespace {
+
+constexpr auto identifier_chars = make_char_class(char_range{'a', 'z'}, char_range{'A', 'Z'}, char_range{'0', '9'}, char_range{'_', '_'});
+
+// Runs the test for all cpu levels supported by this CPU and restores the automatically chosen level afterwards
+template<class Test>
+void for_all_cpu_levels(Test test) {
+  for (cpu_level level : {cpu_level::SCALAR, cpu_level::SSE2, cpu_level::AVX2, cpu_level::AVX512BW}) {
+    if (level <= detect_cpu_level()) {
+      SCOPED_TRACE(to_string(level));
+      force_cpu_level(level);
+      EXPECT_EQ(level, active_cpu_level());
+      test();
+    }
+  }
+  reset_cpu_level();
+}
+
+// Input strings of all lengths up to a few SIMD blocks, with the interesting character at every position
+std::vector<std::string> make_inputs(char filler, char special) {
+  std::vector<std::string> result;
+  for (size_t size = 0; size <= 150; ++size) {
+    result.push_back(std::string(size, filler));
+    for (size_t pos = 0; pos < size; ++pos) {
+      std::string input(size, filler);
+      input[pos] = special;
+      result.push_back(input);
+    }
+  }
+  return result;
+}
+
+namespace char_class_test {
+  static_assert(char_range{'a', 'z'}.contains('a'));
+  static_assert(char_range{'a', 'z'}.contains('m'));
+  static_assert(char_range{'a', 'z'}.contains('z'));
+  static_assert(!char_range{'a', 'z'}.contains('a' - 1));
+  static_assert(!char_range{'a', 'z'}.contains('z' + 1));
+  static_assert(!char_range{'a', 'z'}.contains(static_cast<char>(0xE1)));
+  static_assert(identifier_chars.contains('_'));
+  static_assert(identifier_chars.contains('5'));
+  static_assert(!identifier_chars.contains('-'));
+}
+
+namespace scan_while_class_test {
+  static_assert(0 == scan_while_class("", identifier_chars));
+  static_assert(0 == scan_while_class("-abc", identifier_chars));
+  static_assert(5 == scan_while_class("ab_c9-d", identifier_chars));
+  static_assert(7 == scan_while_class("ab_c9Zd", identifier_chars));
+
+  TEST(KernelsTest, scanWhileClass) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('a', '-')) {
+        EXPECT_EQ(kernels::details::scalar::scan_while_class(input, identifier_chars.ranges), scan_while_class(input, identifier_chars)) << input;
+      }
+      for (const std::string& input : make_inputs('Z', static_cast<char>(0xE1))) {
+        EXPECT_EQ(kernels::details::scalar::scan_while_class(input, identifier_chars.ranges), scan_while_class(input, identifier_chars)) << input;
+      }
+    });
+  }
+}
+
+namespace common_prefix_length_test {
+  static_assert(0 == common_prefix_length("", ""));
+  static_assert(0 == common_prefix_length("abc", ""));
+  static_assert(2 == common_prefix_length("abc", "abd"));
+  static_assert(3 == common_prefix_length("abc", "abcd"));
+
+  TEST(KernelsTest, commonPrefixLength) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('a', 'b')) {
+        const std::string expected(input.size(), 'a');
+        EXPECT_EQ(kernels::details::scalar::common_prefix_length(expected, input), common_prefix_length(expected, input)) << input;
+        EXPECT_EQ(kernels::details::scalar::common_prefix_length(expected + "a", input), common_prefix_length(expected + "a", input)) << input;
+        EXPECT_EQ(kernels::details::scalar::common_prefix_length(expected.substr(0, expected.size() / 2), input), common_prefix_length(expected.substr(0, expected.size() / 2), input)) << input;
+      }
+    });
+  }
+}
+
+namespace find_byte_test {
+  static_assert(std::string_view::npos == find_byte("", 'a'));
+  static_assert(std::string_view::npos == find_byte("bcd", 'a'));
+  static_assert(1 == find_byte("bab", 'a'));
+
+  TEST(KernelsTest, findByte) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('a', ',')) {
+        EXPECT_EQ(kernels::details::scalar::find_byte(input, ','), find_byte(input, ',')) << input;
+      }
+    });
+  }
+}
+
+namespace accumulate_digits_test {
+  constexpr std::pair<size_t, int64_t> accumulate(std::string_view input, int64_t value) {
+    const size_t num_digits = accumulate_digits(input, &value);
+    return {num_digits, value};
+  }
+  static_assert(std::pair<size_t, int64_t>{0, 0} == accumulate("", 0));
+  static_assert(std::pair<size_t, int64_t>{0, 0} == accumulate("a12", 0));
+  static_assert(std::pair<size_t, int64_t>{3, 123} == accumulate("123abc", 0));
+  static_assert(std::pair<size_t, int64_t>{2, 512} == accumulate("12", 5));
+
+  TEST(KernelsTest, accumulateDigits) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('7', 'x')) {
+        // stop at 18 digits so that the values don't overflow
+        const std::string_view truncated = std::string_view(input).substr(0, 18);
+        int64_t expected = 0;
+        int64_t actual = 0;
+        EXPECT_EQ(kernels::details::scalar::accumulate_digits(truncated, &expected), accumulate_digits(truncated, &actual)) << input;
+        EXPECT_EQ(expected, actual) << input;
+      }
+    });
+  }
+
+  TEST(KernelsTest, accumulateDigits_allDigits) {
+    int64_t value = 0;
+    EXPECT_EQ(18, accumulate_digits("123456789012345678", &value));
+    EXPECT_EQ(123456789012345678, value);
+  }
+}
+
+namespace match_bytes_test {
+  constexpr std::array<char, 2> needles = {',', '\n'};
+
+  std::vector<uint64_t> scalar_match_bytes(std::string_view input) {
+    std::vector<uint64_t> masks(num_match_bytes_blocks(input.size()));
+    kernels::details::scalar::match_bytes(input, needles, masks.data());
+    return masks;
+  }
+
+  std::vector<uint64_t> runtime_match_bytes(std::string_view input, size_t padding = 0) {
+    // Filled with garbage, so the kernels have to overwrite every mask
+    std::vector<uint64_t> masks(num_match_bytes_blocks(input.size()), 0xDEADBEEF);
+    match_bytes(input, needles, masks.data(), padding);
+    return masks;
+  }
+
+  constexpr uint64_t first_mask(std::string_view input) {
+    std::array<uint64_t, 2> masks{};
+    match_bytes(input, needles, masks.data());
+    return masks[0];
+  }
+  static_assert(0 == first_mask(""));
+  static_assert(0b10010 == first_mask("a,bc\n"));
+
+  TEST(KernelsTest, matchBytes) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('a', ',')) {
+        EXPECT_EQ(scalar_match_bytes(input), runtime_match_bytes(input)) << input;
+      }
+      for (const std::string& input : make_inputs(',', 'a')) {
+        EXPECT_EQ(scalar_match_bytes(input), runtime_match_bytes(input)) << input;
+      }
+    });
+  }
+}
+
+namespace padded_input_test {
+  constexpr size_t PADDING = 64;
+  // Contains '\0', so the padding would match if the kernels didn't limit their results to the input
+  constexpr auto chars_and_zero = make_char_class(char_range{'a', 'z'}, char_range{'\0', '\0'});
+
+  TEST(KernelsTest, paddedInput) {
+    for_all_cpu_levels([] {
+      for (const std::string& input : make_inputs('a', ',')) {
+        const std::string buffer = input + std::string(PADDING, '\0');
+        const std::string_view padded(buffer.data(), input.size());
+        EXPECT_EQ(kernels::details::scalar::scan_while_class(input, identifier_chars.ranges), scan_while_class(padded, identifier_chars, PADDING)) << input;
+        EXPECT_EQ(kernels::details::scalar::scan_while_class(input, chars_and_zero.ranges), scan_while_class(padded, chars_and_zero, PADDING)) << input;
+        EXPECT_EQ(kernels::details::scalar::find_byte(input, ','), find_byte(padded, ',', PADDING)) << input;
+        EXPECT_EQ(std::string_view::npos, find_byte(padded, '\0', PADDING)) << input;
+        // The padding must not show up in the masks, even with a needle that matches it
+        std::vector<uint64_t> expected(num_match_bytes_blocks(input.size()));
+        std::vector<uint64_t> actual(num_match_bytes_blocks(input.size()));
+        constexpr std::array<char, 2> needles = {',', '\0'};
+        kernels::details::scalar::match_bytes(input, needles, expected.data());
+        match_bytes(padded, needles, actual.data(), PADDING);
+        EXPECT_EQ(expected, actual) << input;
+      }
+      for (const std::string& input : make_inputs('7', 'x')) {
+        const std::string buffer = input.substr(0, 18) + std::string(PADDING, '\0');
+        const std::string_view padded(buffer.data(), std::min<size_t>(input.size(), 18));
+        int64_t expected = 0;
+        int64_t actual = 0;
+        EXPECT_EQ(kernels::details::scalar::accumulate_digits(padded, &expected), accumulate_digits(padded, &actual, PADDING)) << input;
+        EXPECT_EQ(expected, actual) << input;
+      }
+    });
+  }
+}
+
+namespace cpu_level_test {
+  static_assert(cpu_level::AVX2 == parse_cpu_level("avx2"));
+  static_assert(cpu_level::SCALAR == parse_cpu_level(to_string(cpu_level::SCALAR)));
+  static_assert(std::nullopt == parse_cpu_level("avx1024"));
+
+  TEST(KernelsTest, forceUnsupportedCpuLevel) {
+    if (detect_cpu_level() == cpu_level::AVX512BW) {
+      // This CPU supports all levels, nothing to test
+      return;
+    }
+    EXPECT_ANY_THROW(force_cpu_level(cpu_level::AVX512BW));
+  }
+
+  TEST(KernelsTest, resetCpuLevel) {
+    force_cpu_level(cpu_level::SCALAR);
+    reset_cpu_level();
+    EXPECT_EQ(kernels::details::default_cpu_level(), active_cpu_level());
+  }
+}
+
+}
@@ -0,0 +1,332 @@
+#include "parsers/utils/small_vector.h"
+#include "../testutils/move_helpers.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+
+using namespace ctpc;
+
+namespace {
+
+template<size_t INLINE_CAPACITY> small_vector<int, INLINE_CAPACITY> make_small_vector_increasing_values(size_t size) {
+  small_vector<int, INLINE_CAPACITY> result;
+  for (size_t i = 0; i < size; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+template<class SmallVector> void expect_increasing_values(const SmallVector& vec, size_t expected_size) {
+  EXPECT_EQ(expected_size, vec.size());
+  for (size_t i = 0; i < expected_size; ++i) {
+    EXPECT_EQ(i, vec[i]);
+  }
+}
+
+class NonDefaultConstructible final {
+public:
+  explicit NonDefaultConstructible(int value): value_(value) {}
+  int value() const { return value_; }
+private:
+  int value_;
+};
+
+// Counts the live instances to check that each constructed element gets destructed exactly once
+class InstanceCounting final {
+public:
+  explicit InstanceCounting(int* counter): counter_(counter) { ++*counter_; }
+  InstanceCounting(const InstanceCounting& rhs): counter_(rhs.counter_) { ++*counter_; }
+  InstanceCounting(InstanceCounting&& rhs) noexcept: counter_(rhs.counter_) { ++*counter_; }
+  InstanceCounting& operator=(const InstanceCounting&) = default;
+  InstanceCounting& operator=(InstanceCounting&&) = default;
+  ~InstanceCounting() { --*counter_; }
+private:
+  int* counter_;
+};
+
+// Copies throw once *copies_left reaches zero. Moves aren't noexcept, so growing copies the elements.
+class ThrowingCopy final {
+public:
+  ThrowingCopy(int value, int* copies_left, int* counter): value_(value), copies_left_(copies_left), counter_(counter) { ++*counter_; }
+  ThrowingCopy(const ThrowingCopy& rhs): value_(rhs.value_), copies_left_(rhs.copies_left_), counter_(rhs.counter_) {
+    if (*copies_left_ == 0) {
+      throw std::runtime_error("copy failed");
+    }
+    --*copies_left_;
+    ++*counter_;
+  }
+  ThrowingCopy(ThrowingCopy&& rhs): ThrowingCopy(static_cast<const ThrowingCopy&>(rhs)) {}
+  ThrowingCopy& operator=(const ThrowingCopy&) = default;
+  ~ThrowingCopy() { --*counter_; }
+  int value() const { return value_; }
+private:
+  int value_;
+  int* copies_left_;
+  int* counter_;
+};
+
+namespace value_type_test {
+  static_assert(std::is_same_v<int, small_vector<int, 4>::value_type>);
+  static_assert(std::is_same_v<double, small_vector<double, 4>::value_type>);
+}
+
+namespace size_test {
+  TEST(SmallVectorTest_SizeTest, empty) {
+    small_vector<int, 4> empty;
+    EXPECT_EQ(0, empty.size());
+    EXPECT_EQ(4, empty.capacity());
+    EXPECT_TRUE(empty.is_inline());
+  }
+
+  TEST(SmallVectorTest_SizeTest, inline) {
+    expect_increasing_values(make_small_vector_increasing_values<4>(1), 1);
+    expect_increasing_values(make_small_vector_increasing_values<4>(4), 4);
+    EXPECT_TRUE(make_small_vector_increasing_values<4>(4).is_inline());
+  }
+
+  TEST(SmallVectorTest_SizeTest, heap) {
+    expect_increasing_values(make_small_vector_increasing_values<4>(5), 5);
+    expect_increasing_values(make_small_vector_increasing_values<4>(1024), 1024);
+    EXPECT_FALSE(make_small_vector_increasing_values<4>(5).is_inline());
+  }
+}
+
+namespace get_test {
+  TEST(SmallVectorTest_GetTest, empty) {
+    small_vector<int, 4> empty;
+    EXPECT_ANY_THROW(empty[0]);
+  }
+
+  TEST(SmallVectorTest_GetTest, inline) {
+    small_vector<int, 4> vec = make_small_vector_increasing_values<4>(2);
+    EXPECT_ANY_THROW(vec[2]);
+    vec[1] = 5;
+    EXPECT_EQ(0, vec[0]);
+    EXPECT_EQ(5, vec[1]);
+    EXPECT_EQ(5, vec.get_unsafe(1));
+    EXPECT_EQ(5, vec.back());
+  }
+
+  TEST(SmallVectorTest_GetTest, heap) {
+    small_vector<int, 4> vec = make_small_vector_increasing_values<4>(10);
+    EXPECT_ANY_THROW(vec[10]);
+    vec[9] = 5;
+    EXPECT_EQ(8, vec[8]);
+    EXPECT_EQ(5, vec[9]);
+    EXPECT_EQ(5, vec.get_unsafe(9));
+    EXPECT_EQ(5, vec.back());
+  }
+}
+
+namespace iterator_test {
+  TEST(SmallVectorTest_IteratorTest, empty) {
+    small_vector<int, 4> empty;
+    EXPECT_EQ(empty.begin(), empty.end());
+  }
+
+  TEST(SmallVectorTest_IteratorTest, heap) {
+    small_vector<int, 4> vec = make_small_vector_increasing_values<4>(10);
+    EXPECT_EQ(10, vec.end() - vec.begin());
+    for (int& elem : vec) {
+      elem = 7;
+    }
+    for (int elem : vec) {
+      EXPECT_EQ(7, elem);
+    }
+  }
+}
+
+namespace push_back_test {
+  TEST(SmallVectorTest_PushBack, growsPastInlineCapacity) {
+    small_vector<std::string, 2> obj;
+    for (size_t i = 0; i < 100; ++i) {
+      obj.push_back(std::to_string(i));
+      EXPECT_EQ(i+1, obj.size());
+      EXPECT_EQ(i < 2, obj.is_inline());
+      // test it didn't change previously existing elements
+      for (size_t j = 0; j <= i; ++j) {
+        EXPECT_EQ(std::to_string(j), obj[j]);
+      }
+    }
+  }
+
+  TEST(SmallVectorTest_PushBack, elementFromSameVectorWhileGrowing) {
+    small_vector<std::string, 1> obj;
+    obj.push_back(std::string("first"));
+    obj.push_back(obj[0]);
+    EXPECT_EQ("first", obj[0]);
+    EXPECT_EQ("first", obj[1]);
+  }
+
+  TEST(SmallVectorTest_PushBack, nonDefaultConstructible) {
+    small_vector<NonDefaultConstructible, 2> obj;
+    for (int i = 0; i < 5; ++i) {
+      obj.push_back(NonDefaultConstructible(i));
+    }
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(i, obj[i].value());
+    }
+  }
+
+  TEST(SmallVectorTest_PushBack, movableOnly) {
+    small_vector<movable_only<int>, 2> obj;
+    for (int i = 0; i < 5; ++i) {
+      obj.push_back(movable_only<int>(i));
+    }
+    small_vector<movable_only<int>, 2> moved = std::move(obj);
+    EXPECT_EQ(5, moved.size());
+    EXPECT_EQ(0, obj.size());
+  }
+}
+
+namespace reserve_test {
+  TEST(SmallVectorTest_Reserve, withinInlineCapacity) {
+    small_vector<int, 4> vec;
+    vec.reserve(3);
+    EXPECT_TRUE(vec.is_inline());
+    EXPECT_EQ(4, vec.capacity());
+  }
+
+  TEST(SmallVectorTest_Reserve, pastInlineCapacity) {
+    small_vector<int, 4> vec = make_small_vector_increasing_values<4>(3);
+    vec.reserve(100);
+    EXPECT_FALSE(vec.is_inline());
+    EXPECT_EQ(100, vec.capacity());
+    expect_increasing_values(vec, 3);
+  }
+
+  TEST(SmallVectorTest_Reserve, throwingCopyLeavesVectorUnchanged) {
+    int copies_left = 100;
+    int counter = 0;
+    {
+      small_vector<ThrowingCopy, 4> vec;
+      for (int i = 0; i < 3; ++i) {
+        vec.emplace_back(i, &copies_left, &counter);
+      }
+      copies_left = 1;
+      EXPECT_THROW(vec.reserve(100), std::runtime_error);
+      EXPECT_TRUE(vec.is_inline());
+      EXPECT_EQ(3, counter);
+      ASSERT_EQ(3, vec.size());
+      for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(i, vec[i].value());
+      }
+    }
+    EXPECT_EQ(0, counter);
+  }
+
+  TEST(SmallVectorTest_Reserve, throwingCopyWhileGrowingLeavesVectorUnchanged) {
+    int copies_left = 100;
+    int counter = 0;
+    {
+      small_vector<ThrowingCopy, 2> vec;
+      for (int i = 0; i < 4; ++i) {
+        vec.emplace_back(i, &copies_left, &counter);
+      }
+      copies_left = 2;
+      EXPECT_THROW(vec.emplace_back(4, &copies_left, &counter), std::runtime_error);
+      EXPECT_EQ(4, counter);
+      ASSERT_EQ(4, vec.size());
+      for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(i, vec[i].value());
+      }
+    }
+    EXPECT_EQ(0, counter);
+  }
+}
+
+namespace pop_back_test {
+  TEST(SmallVectorTest_PopBack, popBack) {
+    small_vector<int, 4> vec = make_small_vector_increasing_values<4>(6);
+    vec.pop_back();
+    expect_increasing_values(vec, 5);
+    vec.pop_back();
+    vec.pop_back();
+    expect_increasing_values(vec, 3);
+  }
+}
+
+namespace copy_move_test {
+  TEST(SmallVectorTest_CopyMove, copyInline) {
+    small_vector<int, 4> source = make_small_vector_increasing_values<4>(3);
+    small_vector<int, 4> copy = source;
+    expect_increasing_values(copy, 3);
+    expect_increasing_values(source, 3);
+  }
+
+  TEST(SmallVectorTest_CopyMove, copyHeap) {
+    small_vector<int, 4> source = make_small_vector_increasing_values<4>(10);
+    small_vector<int, 4> copy = source;
+    expect_increasing_values(copy, 10);
+    expect_increasing_values(source, 10);
+    EXPECT_NE(source.begin(), copy.begin());
+  }
+
+  TEST(SmallVectorTest_CopyMove, moveInline) {
+    small_vector<int, 4> source = make_small_vector_increasing_values<4>(3);
+    small_vector<int, 4> moved = std::move(source);
+    expect_increasing_values(moved, 3);
+    EXPECT_TRUE(moved.is_inline());
+    EXPECT_EQ(0, source.size());
+  }
+
+  TEST(SmallVectorTest_CopyMove, moveHeapStealsAllocation) {
+    small_vector<int, 4> source = make_small_vector_increasing_values<4>(10);
+    const int* allocation = source.begin();
+    small_vector<int, 4> moved = std::move(source);
+    expect_increasing_values(moved, 10);
+    EXPECT_EQ(allocation, moved.begin());
+    EXPECT_EQ(0, source.size());
+    EXPECT_TRUE(source.is_inline());
+  }
+
+  TEST(SmallVectorTest_CopyMove, assignment) {
+    small_vector<int, 4> target = make_small_vector_increasing_values<4>(10);
+    target = make_small_vector_increasing_values<4>(2);
+    expect_increasing_values(target, 2);
+    EXPECT_TRUE(target.is_inline());
+
+    const small_vector<int, 4> source = make_small_vector_increasing_values<4>(7);
+    target = source;
+    expect_increasing_values(target, 7);
+    expect_increasing_values(source, 7);
+  }
+}
+
+namespace lifetime_test {
+  TEST(SmallVectorTest_Lifetime, destructsEachElementExactlyOnce) {
+    int counter = 0;
+    {
+      small_vector<InstanceCounting, 2> vec;
+      for (int i = 0; i < 10; ++i) {
+        vec.push_back(InstanceCounting(&counter));
+      }
+      EXPECT_EQ(10, counter);
+      small_vector<InstanceCounting, 2> copy = vec;
+      EXPECT_EQ(20, counter);
+      small_vector<InstanceCounting, 2> moved = std::move(copy);
+      EXPECT_EQ(20, counter);
+      vec.pop_back();
+      EXPECT_EQ(19, counter);
+      moved = vec;
+      EXPECT_EQ(18, counter);
+    }
+    EXPECT_EQ(0, counter);
+  }
+}
+
+namespace initializer_list_test {
+  TEST(SmallVectorTest_InitializerList, inline) {
+    small_vector<int, 4> vec{0, 1, 2};
+    expect_increasing_values(vec, 3);
+    EXPECT_TRUE(vec.is_inline());
+  }
+
+  TEST(SmallVectorTest_InitializerList, heap) {
+    small_vector<int, 2> vec{0, 1, 2, 3, 4};
+    expect_increasing_values(vec, 5);
+    EXPECT_FALSE(vec.is_inline());
+  }
+}
+
+}